@@ -396,6 +396,17 @@ class I2CInterface {
                 return;
             }
 
+            if (cmd==CMD_RING_LED_VALUES) {
+                uint8_t count = cmd_buffer.get();
+                uint8_t values[count];
+                for (uint8_t i = 0; i < count; i++) {
+                    values[i] = cmd_buffer.get();
+                }
+                _ring->set_leds(values,count);
+                Log.debug(F("\tInterface: Set %d leds"),count);
+                return;
+            }
+
             if (cmd==CMD_RING_OFF) {
                 _ring->off();
                 last_sequence = 10; // turn leds off  after sleep
@@ -451,6 +462,34 @@ class I2CInterface {
 
             }
 
+            if (cmd == CMD_OLED_LINE) {
+                uint8_t id = (int) cmd_buffer.get();
+                uint8_t alignCmd = (int) cmd_buffer.get();
+                uint8_t x = (int) cmd_buffer.get();
+                uint8_t y = (int) cmd_buffer.get();
+                uint8_t size = (int) cmd_buffer.get();
+                uint16_t color = ((int) cmd_buffer.get() << 8);
+                color |= (int) cmd_buffer.get();
+                uint8_t txtLength = (int) cmd_buffer.get();
+
+                char txt[txtLength+1];
+                int i;
+                for (i=0;i<txtLength;i++) {
+                    txt[i] = (char) cmd_buffer.get();
+                }
+                txt[i] = '\0';
+
+                TextAlign align = TextCenter;
+
+                if (alignCmd==CMD_OLED_TEXT) align = TextLeft;
+                if (alignCmd==CMD_OLED_RIGHTTEXT) align = TextRight;
+
+                _oled->SetLine(id,txt,x-1,y-1,size,align,color);
+                Log.debug(F("\tInterface: Oled set line %d: %s"),id,txt);
+                Log.debug(F("\t\tx:%d y:%d size:%d, color: %u"),x,y,size,color);
+                return;
+            }
+
             if (cmd == CMD_OLED_CLEAR) {
                 _oled->Clear();
                 Log.debug(F("\tInterface: Oled clear"));
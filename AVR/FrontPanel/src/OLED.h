@@ -33,6 +33,19 @@
 #include "autodesk-font2.cpp" //!< custom font size 2
 
 const uint8_t max_lines = 10; // max lines (+1) that can be fast cleared
+const uint8_t max_text_lines = 4; // max lines that can be updated in place
+const uint8_t max_line_length = 20; // max characters in those lines
+
+// a line of text that is updated in place, so that only changed characters
+// need to be redrawn
+typedef struct {
+    uint8_t x; // position of the first character
+    uint8_t y;
+    uint8_t length; // width in pixels
+    uint8_t size; // 0 when the line isn't shown
+    uint16_t color;
+    char text[max_line_length + 1];
+} TextLine;
 
 class OLED : public SSD1351OLED {
 
@@ -49,9 +62,13 @@ class OLED : public SSD1351OLED {
         uint8_t xs[max_lines];
         uint8_t ys[max_lines];
         FontConfig fonts[max_lines];
+        // lines that are updated in place, by line id
+        TextLine text_lines[max_text_lines];
 
         OLED(uint8_t cs, uint8_t dc, uint8_t rst) :
-            SSD1351OLED(cs,dc,rst) {};
+            SSD1351OLED(cs,dc,rst) {
+                memset(text_lines,0,sizeof(text_lines));
+            };
 
         void On() {
             SetDisplayOn();
@@ -84,8 +101,14 @@ class OLED : public SSD1351OLED {
                 for (int i = 0; i< drawn; i++){
                     FillBlock(BLACK, xs[i]+1, ys[i]+1, lengths[i], fonts[i].height);
                 }
+                for (uint8_t i = 0; i < max_text_lines; i++){
+                    EraseLine(&text_lines[i]);
+                }
             }
             drawn = 0;
+            for (uint8_t i = 0; i < max_text_lines; i++){
+                text_lines[i].size = 0;
+            }
         }
 
         void DrawLogo() {
@@ -106,6 +129,9 @@ class OLED : public SSD1351OLED {
                 last_max_y = y + LOGO_HEIGHT + 5;
             }
             drawn = 0xFF;
+            for (uint8_t i = 0; i < max_text_lines; i++){
+                text_lines[i].size = 0;
+            }
         }
 
 
@@ -122,26 +148,8 @@ class OLED : public SSD1351OLED {
 
         void SetText(char *s, uint8_t x, uint8_t y, uint8_t size, TextAlign align = TextCenter, uint16_t color = WHITE) {
 
-            FontConfig font;
-
-
-            switch(size) {
-                case 2:
-                    font.font_table = adfont2;
-                    font.width = FONT2_WIDTH;
-                    font.height = FONT2_HEIGHT;
-                    font.start_char = FONT2_START_CHAR;
-                    font.end_char = FONT2_END_CHAR;
-                    break;
-                default:
-                    font.font_table = adfont1;
-                    font.width = FONT1_WIDTH;
-                    font.height = FONT1_HEIGHT;
-                    font.start_char = FONT1_START_CHAR;
-                    font.end_char = FONT1_END_CHAR;
-                    break;
+            FontConfig font = GetFont(size);
 
-            }
             uint8_t length = ProportionalFontStringLength(s,font);
             if (align == TextCenter) {
                 x = x - (length / 2);
@@ -195,6 +203,164 @@ class OLED : public SSD1351OLED {
                 drawn++;
             }
         }
+
+        /**
+         * Set the text of the line with the given id at x and y
+         * Size determines the font
+         * Only the characters that differ from those already shown for the
+         * line are redrawn, if its position, size, and color are unchanged
+         */
+
+        void SetLine(uint8_t id, char *s, uint8_t x, uint8_t y, uint8_t size, TextAlign align = TextCenter, uint16_t color = WHITE) {
+
+            if (id >= max_text_lines) {
+                SetText(s,x,y,size,align,color);
+                return;
+            }
+
+            if (size != 2) size = 1; // any other size uses font 1
+            TextLine *line = &text_lines[id];
+            FontConfig font = GetFont(size);
+            uint8_t length = ProportionalFontStringLength(s,font);
+            uint8_t text_x = x;
+            if (align == TextCenter) {
+                text_x = x - (length / 2);
+            }
+            if (align == TextRight) {
+                text_x = x - length;
+            }
+
+            if (strlen(s) > max_line_length || length > SSD1351_WIDTH ||
+                    text_x > SSD1351_WIDTH - length ||
+                    y > SSD1351_HEIGHT - font.height) {
+                // let SetText handle text that doesn't fit
+                EraseLine(line);
+                line->size = 0;
+                SetText(s,x,y,size,align,color);
+                return;
+            }
+
+            char no_text = '\0';
+            char *old_s = line->text;
+            uint8_t old_x = line->x;
+            uint8_t new_x = text_x;
+            char *new_s = s;
+
+            if (line->size != size || line->y != y || line->color != color) {
+                EraseLine(line);
+                old_s = &no_text;
+            } else if (old_x == new_x) {
+                // skip unchanged characters, and redraw those replaced by
+                // characters of the same width, until the positions of the
+                // old and new characters differ
+                while (*new_s && *old_s) {
+                    uint8_t width = CharWidth(*new_s,font);
+                    if (width != CharWidth(*old_s,font)) break;
+                    if (*new_s != *old_s) {
+                        EraseText(new_x,y,width,font);
+                        DrawFontChar(*new_s,new_x,y,font,color);
+                    }
+                    new_x += width + 1;
+                    new_s++;
+                    old_s++;
+                }
+                old_x = new_x;
+            }
+
+            // erase the rest of the old text and draw the rest of the new
+            if (*old_s) {
+                EraseText(old_x,y,line->x + line->length - old_x,font);
+            }
+            DrawString(new_s,new_x,y,font,color);
+
+            line->x = text_x;
+            line->y = y;
+            line->length = length;
+            line->size = size;
+            line->color = color;
+            strcpy(line->text,s);
+
+            // include the line in the area cleared by Clear()
+            if (text_x < last_min_x){
+                last_min_x = text_x;
+            }if (y < last_min_y){
+                last_min_y = y;
+            }if (text_x + length > last_max_x){
+                last_max_x = text_x + length;
+            }if (y + font.height > last_max_y){
+                last_max_y = y + font.height;
+            }
+        }
+
+    private:
+
+        /**
+         * Get the font for the given text size
+         */
+        FontConfig GetFont(uint8_t size) {
+
+            FontConfig font;
+
+            switch(size) {
+                case 2:
+                    font.font_table = adfont2;
+                    font.width = FONT2_WIDTH;
+                    font.height = FONT2_HEIGHT;
+                    font.start_char = FONT2_START_CHAR;
+                    font.end_char = FONT2_END_CHAR;
+                    break;
+                default:
+                    font.font_table = adfont1;
+                    font.width = FONT1_WIDTH;
+                    font.height = FONT1_HEIGHT;
+                    font.start_char = FONT1_START_CHAR;
+                    font.end_char = FONT1_END_CHAR;
+                    break;
+
+            }
+            return font;
+        }
+
+        /**
+         * Get the width in pixels of a character, without the space after it
+         */
+        uint8_t CharWidth(char c, FontConfig font) {
+            if (c < font.start_char ) c = font.start_char;
+            if (c > font.end_char ) c = font.end_char;
+            uint8_t bytes_per_char = font.width * (font.height / 8 + 1) + 1;
+            return pgm_read_byte(font.font_table + (c - font.start_char) * bytes_per_char);
+        }
+
+        /**
+         * Draw a character the same way DrawString does
+         */
+        void DrawFontChar(char c, uint8_t x, uint8_t y, FontConfig font, uint16_t color) {
+            if (font.height==14){//if font 1
+                DrawCharRAM(c,x,y,font,color);
+            }else{
+                DrawChar(c,x,y,font,color);
+            }
+        }
+
+        /**
+         * Clear the area of text drawn starting at x, that's the given number
+         * of pixels wide (DrawChar and DrawCharRAM draw characters one pixel
+         * right of the given position, and DrawChar one pixel below it)
+         */
+        void EraseText(uint8_t x, uint8_t y, uint8_t width, FontConfig font) {
+            uint8_t height = (font.height / 8 + 1) * 8;
+            if (font.height != 14) height++; // not font 1
+            FillBlock(BLACK, x + 1, y, width, height);
+        }
+
+        /**
+         * Clear the text shown for a line, if any
+         */
+        void EraseLine(TextLine *line) {
+            if (line->size) {
+                EraseText(line->x,line->y,line->length,GetFont(line->size));
+            }
+        }
 };
 
 #endif
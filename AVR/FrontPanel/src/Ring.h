@@ -160,6 +160,19 @@ class Ring {
             write();
         }
 
+        /**
+         * Set the first count leds to the given 8 bit brightness values,
+         * scaled to the pwm range
+         * \param values brightness values (0..255)
+         * \param count number of values
+         */
+        void set_leds(uint8_t *values, uint8_t count) {
+            for(uint8_t led = 0; led < count && led < _num_leds; led++) {
+                set_led_buffer(led,((uint16_t) values[led] << 4) | (values[led] >> 4));
+            }
+            write();
+        }
+
         /**
          * All leds on
          */
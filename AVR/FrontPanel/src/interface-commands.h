@@ -25,7 +25,8 @@
  * Commands are transmitted within a frame in the form:
  *    [CMD_START][FRAME LENGTH BYTE][PAYLOAD]
  *
- * For I2C transmissions, commands should be sent in 32 byte or less chunks
+ * For I2C transmissions, commands should be sent in 32 byte or less chunks.
+ * A chunk may hold several frames, and a frame may span several chunks.
  * ## General Commands 
  * * [CMD_SYNC] - get interrupt from control panel
  * * [CMD_RESET] - software reset
@@ -37,6 +38,9 @@
  *
  * * [CMD_RING][CMD_RING_SEQUENCE][SEQUENCE NUMBER BYTE] - start the specified animation sequence (0 to 8)
  *
+ * * [CMD_RING][CMD_RING_LED_VALUES][COUNT BYTE][VALUE BYTES] - set the first
+ * COUNT leds to the given 8 bit values (0-255, scaled to 0-4095)
+ *
  * ## Oled Commands
  * * [CMD_OLED][CMD_OLED_ON] - turn on OLED display
  *
@@ -54,6 +58,12 @@
  * specified length in the specified color (16 bits) and size (1-2) and the
  * specified x and y position (0-127), centered around x 
  *
+ * * [CMD_OLED][CMD_OLED_LINE][LINE ID BYTE][ALIGNMENT BYTE][X BYTE][Y BYTE]
+ * [SIZE BYTE][HI COLOR BYTE][LO COLOR BYTE][TEXT LENGTH BYTE][TXT BYTES] -
+ * display text as the line with the specified id (0-3), aligned as for
+ * CMD_OLED_TEXT, CMD_OLED_CENTERTEXT, or CMD_OLED_RIGHTTEXT, redrawing only
+ * the characters that differ from the text already shown for that line
+ *
  */
 
 #ifndef __INTERFACE_COMMANDS_H__
@@ -70,6 +80,7 @@
 #define CMD_RING_SEQUENCE 0x02 //!< Start a ring sequence (0 to stop)
 #define CMD_RING_LED 0x03 //!< Set a ring LED to given value
 #define CMD_RING_LEDS 0x04 //!< Set all ring LEDS to given value
+#define CMD_RING_LED_VALUES 0x05 //!< Set ring LEDs to given values
 #define CMD_OLED_CENTERTEXT 0x06 //!< Set OLED text centered on x
 #define CMD_OLED_RIGHTTEXT 0x07 //!< Set OLED text centered on x
 #define CMD_OLED_TEXT 0x01 //!< Set OLED text 
@@ -78,6 +89,7 @@
 #define CMD_OLED_OFF 0x04 //!< Turn OLED off
 #define CMD_OLED_PIXEL 0x05 //!< Set OLED pixel
 #define CMD_OLED_LOGO 0x08 //!< Display logo
+#define CMD_OLED_LINE 0x09 //!< Update OLED text line in place
 
 // Legacy
 #define CMD_OLED_SETCENTEREDTEXT CMD_OLED_CENTERTEXT
@@ -91,6 +91,23 @@ Status AxisSettings::SetMicrosteppingMode(uint8_t value)
     return MC_STATUS_SUCCESS;
 }
 
+// Set the distance for this axis to move together with the next move of the
+// other axis
+// value The distance in units, with its sign giving the direction
+void AxisSettings::SetLinkedDistance(int32_t value)
+{
+    linkedDistance = value;
+}
+
+// Return the distance set to move together with the next move of the other
+// axis, clearing it so that it only applies to that move
+int32_t AxisSettings::TakeLinkedDistance()
+{
+    int32_t value = linkedDistance;
+    linkedDistance = 0;
+    return value;
+}
+
 // Return the number of pulses required to move this axis by one unit
 float AxisSettings::PulsesPerUnit() const
 {
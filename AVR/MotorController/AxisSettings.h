@@ -47,6 +47,8 @@ public:
     Status SetMaxJerk(int32_t value);
     Status SetSpeed(int32_t value);
     Status SetMicrosteppingMode(uint8_t value);
+    void SetLinkedDistance(int32_t value);
+    int32_t TakeLinkedDistance();
 
     // Retrieve settings
     float PulsesPerUnit() const;
@@ -65,6 +67,7 @@ private:
     float maxJerk = AXIS_SETTINGS_DEFAULT_MAX_JERK;
     float speed = AXIS_SETTINGS_DEFAULT_SPEED;
     uint8_t microsteppingFactor = AXIS_SETTINGS_DEFAULT_MICROSTEPPING_FACTOR;
+    int32_t linkedDistance = 0;
 };
 
 #endif  // AXISSETTINGS_H
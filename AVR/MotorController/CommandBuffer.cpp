@@ -54,6 +54,19 @@ void CommandBuffer::GetCommand(Command& command)
     receivedCommandCount--;
 }
 
+// Return the status of the last batch rejected by the buffer (or success if
+// none was rejected) and reset it
+Status CommandBuffer::TakeBatchStatus()
+{
+    // Single byte access is atomic, so no need to disable interrupts
+    // A batch rejected between reading and resetting the status would not be
+    // reported, but the controller is already handling an error in that case
+    Status status = batchStatus;
+    if (status != MC_STATUS_SUCCESS)
+        batchStatus = MC_STATUS_SUCCESS;
+    return status;
+}
+
 // Remove and return a byte from the end of the buffer
 unsigned char CommandBuffer::RemoveByte()
 {
@@ -29,7 +29,7 @@
 
 // Size in bytes of ring buffer
 // Needs to be a power of 2 so compiler can use AND to implement modulo
-#define COMMAND_BUFFER_SIZE 128
+#define COMMAND_BUFFER_SIZE 256
 
 #include <stdint.h>
 #include "Command.h"
@@ -57,6 +57,29 @@ public:
         return receivedCommandCount == commandCapacity;
     }
 
+    // Return the number of commands the buffer can currently accept
+    inline uint8_t FreeCapacity()
+    {
+        return commandCapacity - receivedCommandCount;
+    }
+
+    // Return the read register most recently addressed by the master
+    inline uint8_t SelectedReadRegister()
+    {
+        return readRegister;
+    }
+
+    // Return whether or not the buffer is part way through receiving a command
+    // or a batch of commands
+    inline bool IsReceivingCommand()
+    {
+        return bytesRemaining != COMMAND_SIZE || batchState != BatchIdle;
+    }
+
+    // Return the status of the last batch rejected by the buffer (or success
+    // if none was rejected) and reset it
+    Status TakeBatchStatus();
+
     // Handle adding a byte or bytes to the buffer
     //
     // If the specified data is a general command and the buffer is not in the
@@ -64,7 +87,12 @@ public:
     // parameter values for consistency to represent the general command
     //
     // If the specified data represents a read register and the buffer is not
-    // in the process of receiving a multi-byte command, don't add the data
+    // in the process of receiving a multi-byte command, don't add the data but
+    // remember the register so the response to the read can be selected
+    //
+    // If the specified data is the batch register and the buffer is not in
+    // the process of receiving a multi-byte command, start receiving a batch
+    // of commands
     //
     // Otherwise, assume the data is part of a command transmitted in COMMAND_SIZE
     // bytes
@@ -72,10 +100,26 @@ public:
     // data The byte to conditionally add to the buffer
     inline void AddCommandByte(unsigned char data)
     {
-        if (data == MC_STATUS_REG && bytesRemaining == COMMAND_SIZE)
+        if (batchState != BatchIdle)
+        {
+            AddBatchByte(data);
+            return;
+        }
+
+        if (data == MC_BATCH_REG && bytesRemaining == COMMAND_SIZE)
+        {
+            batchState = BatchCount;
+            return;
+        }
+
+        if ((data == MC_STATUS_REG || data == MC_QUEUE_REG) && bytesRemaining == COMMAND_SIZE)
+        {
             // The controller received a read register address
-            // Ignore as the data does not represent a command
+            // Record it to select the data to transmit for the read but
+            // don't add it as the data does not represent a command
+            readRegister = data;
             return;
+        }
 
         if (data > MC_GENERAL_LOW_FENCEPOST && data < MC_GENERAL_HIGH_FENCEPOST && bytesRemaining == COMMAND_SIZE)
         {
@@ -92,10 +136,85 @@ public:
             AddByte(data);
     }
 
+    // Handle the end of a transmission from the master
+    // Discard any batch that was not completely received, since the master
+    // will retry sending it
+    inline void EndTransmission()
+    {
+        batchState = BatchIdle;
+    }
+
 private:
     CommandBuffer(const CommandBuffer&);
     unsigned char RemoveByte();
 
+    // Handle a byte of a batch of commands
+    //
+    // The commands in a batch are stored ahead of the head of the buffer and
+    // only become available for removal once the checksum following them has
+    // been verified
+    //
+    // data The byte of the batch to handle
+    inline void AddBatchByte(unsigned char data)
+    {
+        switch (batchState)
+        {
+            case BatchCount:
+                if (data == 0 || data > MC_MAX_BATCH_COMMANDS)
+                {
+                    RejectBatch(MC_STATUS_BATCH_INVALID);
+                    return;
+                }
+
+                // Only accept the batch if the buffer can hold all of it
+                if (data > commandCapacity - receivedCommandCount)
+                {
+                    RejectBatch(MC_STATUS_COMMAND_BUFFER_FULL);
+                    return;
+                }
+
+                batchCount = data;
+                batchBytesRemaining = data * COMMAND_SIZE;
+                batchHead = head;
+                batchChecksum = MC_UpdateBatchChecksum(0, data);
+                batchState = BatchCommands;
+                break;
+
+            case BatchCommands:
+                buffer[batchHead] = data;
+                batchHead = (batchHead + 1) % COMMAND_BUFFER_SIZE;
+                batchChecksum = MC_UpdateBatchChecksum(batchChecksum, data);
+
+                if (--batchBytesRemaining == 0)
+                    batchState = BatchChecksum;
+                break;
+
+            case BatchChecksum:
+                if (data == batchChecksum)
+                {
+                    // Make the whole batch available at once
+                    head = batchHead;
+                    receivedCommandCount += batchCount;
+                    batchState = BatchIdle;
+                }
+                else
+                    RejectBatch(MC_STATUS_BATCH_INVALID);
+                break;
+
+            default:
+                // Ignore the remainder of a rejected batch
+                break;
+        }
+    }
+
+    // Discard the batch being received and ignore any remaining bytes in it
+    // status The reason for rejecting the batch
+    inline void RejectBatch(Status status)
+    {
+        batchStatus = status;
+        batchState = BatchRejected;
+    }
+
     // Add a single byte to the front of the buffer if the buffer has capacity
     // for an entire 6-byte command
     // data The byte to add to the buffer
@@ -127,7 +246,27 @@ private:
     volatile uint8_t tail = 0;
     volatile uint8_t bytesRemaining = COMMAND_SIZE;
     volatile uint8_t receivedCommandCount = 0;
+    volatile uint8_t readRegister = MC_STATUS_REG;
     static uint8_t commandCapacity;
+
+    // States for receiving a batch of commands
+    enum BatchState
+    {
+        BatchIdle,
+        BatchCount,
+        BatchCommands,
+        BatchChecksum,
+        BatchRejected
+    };
+
+    // These variables are only modified in the I2C ISR, except for
+    // batchStatus which is reset in the main loop
+    volatile uint8_t batchState = BatchIdle;
+    volatile uint8_t batchCount = 0;
+    volatile uint8_t batchBytesRemaining = 0;
+    volatile uint8_t batchHead = 0;
+    volatile uint8_t batchChecksum = 0;
+    volatile Status batchStatus = MC_STATUS_SUCCESS;
 };
 
 // Global instance externalized here for sharing between I2C module and main loop
@@ -92,6 +92,7 @@ ISR(TWI_vect)
             // Switch to SR mode with SLA ACK
             TWCR |= (1<<TWIE) | (1<<TWINT) | (1<<TWEA) | (1<<TWEN);
             // Receive is complete
+            commandBuffer.EndTransmission();
             break;
 
             // Slave Transmitter
@@ -102,8 +103,11 @@ ISR(TWI_vect)
             // Fall-through to transmit first data byte
         case TW_ST_DATA_ACK:                // 0xB8: data byte has been transmitted, ACK has been received
             // ST->DATA_ACK
-            // Transmit data byte
-            TWDR = mcState->status;
+            // Transmit data byte from the register the master addressed
+            if (commandBuffer.SelectedReadRegister() == MC_QUEUE_REG)
+                TWDR = commandBuffer.FreeCapacity();
+            else
+                TWDR = mcState->status;
             // End of data to write reached, expect NACK to data byte
             TWCR |= (1<<TWIE) | (1<<TWINT) | (0<<TWEA) | (1<<TWEN);
         case TW_ST_DATA_NACK:               // 0xC0: data byte has been transmitted, NACK has been received
@@ -123,6 +127,9 @@ ISR(TWI_vect)
             // BUS_ERROR
             // Reset internal hardware and release bus
             TWCR |= (1<<TWIE) | (1<<TWINT) | (1<<TWEA) | (1<<TWEN) | (1<<TWSTO);
+            // The transmission was cut off, so discard any partial batch as
+            // for a STOP, ready for the master's retry
+            commandBuffer.EndTransmission();
             break;
     }
 }
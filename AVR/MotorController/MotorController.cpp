@@ -23,6 +23,7 @@
 
 #include <util/delay.h>
 #include <string.h>
+#include <math.h>
 
 #include "MotorController.h"
 #include "Planner.h"
@@ -30,6 +31,7 @@
 #include "Hardware.h"
 #include "MachineDefinitions.h"
 #include "PlannerBufferPool.h"
+#include "Utils.h"
 #include "../../C++/include/MotorController.h" // Shared header defining commands
 
 #ifdef DEBUG
@@ -104,6 +106,10 @@ Status MotorController::UpdateSettings(uint8_t axis, EventData eventData, AxisSe
             RETURN_ON_ERROR(axisSettings.SetSpeed(eventData.parameter));
             break;
 
+        case MC_LINKED_MOVE:
+            axisSettings.SetLinkedDistance(eventData.parameter);
+            break;
+
         default:
             return MC_STATUS_SETTING_COMMAND_UNKNOWN;
             break;
@@ -162,13 +168,37 @@ Status MotorController::HomeRAxis(int32_t homingDistance, MotorController_t* mcS
     }
 }
 
-// Enqueue a movement block into the planning buffer
-// axisIndex The index corresponding to the axis to move
-// distance The distance to move
-// settings The settings for the axis to move
-Status MotorController::Move(uint8_t axisIndex, int32_t distance, const AxisSettings& settings)
+// Enqueue a movement block moving each axis by the corresponding distance
+// into the planning buffer
+// When both axes move, they move at once along a single line, at the highest
+// speed and jerk that neither axis's settings are exceeded
+// distances The distance to move each axis
+// settings The settings for each axis, only used for the axes that move
+static Status planMove(const int32_t distances[], const AxisSettings* settings[])
 {
-    RETURN_ON_ERROR(settings.Validate());
+    float lineDistances[AXES_COUNT];
+    float speeds[AXES_COUNT];
+    float jerks[AXES_COUNT];
+    uint8_t directions[AXES_COUNT];
+
+    for (uint8_t axis = 0; axis < AXES_COUNT; axis++)
+    {
+        speeds[axis] = 0.0;
+        jerks[axis] = 0.0;
+
+        if (distances[axis] != 0)
+        {
+            RETURN_ON_ERROR(settings[axis]->Validate());
+            speeds[axis] = settings[axis]->Speed();
+            jerks[axis] = settings[axis]->MaxJerk();
+        }
+
+        // Handle movement direction with a separate flag
+        directions[axis] = distances[axis] < 0 ? 1 : 0;
+
+        // The motion planning system does not properly deal with negative distances
+        lineDistances[axis] = fabs(static_cast<float>(distances[axis]));
+    }
 
 #ifdef DEBUG
     stepCount[Z_AXIS] = 0;
@@ -179,24 +209,59 @@ Status MotorController::Move(uint8_t axisIndex, int32_t distance, const AxisSett
     Planner::SetAxisPosition(Z_AXIS, 0.0);
     Planner::SetAxisPosition(R_AXIS, 0.0);
 
+    float speed = LineLimit(lineDistances, speeds);
+    float maxJerk = LineLimit(lineDistances, jerks);
+
 #ifdef DEBUG
-    printf_P(PSTR("DEBUG: in MotorController::Move, axis index: %d, distance: %ld, pulses per unit: %f, max jerk: %e\n"),
-            axisIndex, distance, static_cast<double>(settings.PulsesPerUnit()), settings.MaxJerk());
+    printf_P(PSTR("DEBUG: in planMove, z distance: %ld, r distance: %ld, speed: %f, max jerk: %e\n"),
+            distances[Z_AXIS], distances[R_AXIS], static_cast<double>(speed), static_cast<double>(maxJerk));
 #endif
-    
-    float distances[AXES_COUNT] = { 0 };
-    uint8_t directions[AXES_COUNT];
 
-    distances[axisIndex] = static_cast<float>(distance);
-    
-    // Handle movement direction with a separate flag
-    directions[Z_AXIS] = distances[Z_AXIS] < 0 ? 1 : 0;
-    directions[R_AXIS] = distances[R_AXIS] < 0 ? 1 : 0;
+    return Planner::PlanAccelerationLine(lineDistances, directions, speed, maxJerk);
+}
 
-    // The motion planning system does not properly deal with negative distances
-    distances[axisIndex] = fabs(distances[axisIndex]);
-    
-    return Planner::PlanAccelerationLine(distances, directions, settings.Speed(), settings.MaxJerk());
+// Enqueue a movement block for a single axis into the planning buffer
+// axisIndex The index corresponding to the axis to move
+// distance The distance to move
+// settings The settings for the axis to move
+Status MotorController::Move(uint8_t axisIndex, int32_t distance, const AxisSettings& settings)
+{
+    int32_t distances[AXES_COUNT] = { 0 };
+    const AxisSettings* axisSettings[AXES_COUNT] = { 0 };
+
+    distances[axisIndex] = distance;
+    axisSettings[axisIndex] = &settings;
+
+    return planMove(distances, axisSettings);
+}
+
+// Enqueue a movement block for a move action into the planning buffer, moving
+// the other axis at the same time by any distance linked to this move
+// axisIndex The index corresponding to the axis to move
+// distance The distance to move
+// mcState The global state struct instance, holding the settings for both axes
+Status MotorController::Move(uint8_t axisIndex, int32_t distance, MotorController_t* mcState)
+{
+    int32_t distances[AXES_COUNT];
+    const AxisSettings* axisSettings[AXES_COUNT] =
+            { &mcState->zAxisSettings, &mcState->rAxisSettings };
+
+    if (axisIndex == Z_AXIS)
+        distances[R_AXIS] = mcState->rAxisSettings.TakeLinkedDistance();
+    else
+        distances[Z_AXIS] = mcState->zAxisSettings.TakeLinkedDistance();
+
+    distances[axisIndex] = distance;
+
+    return planMove(distances, axisSettings);
+}
+
+// Discard any distances linked to the next move of either axis, so that they 
+// don't outlive the sequence of commands that set them
+void MotorController::ClearLinkedMoves(MotorController_t* mcState)
+{
+    mcState->zAxisSettings.TakeLinkedDistance();
+    mcState->rAxisSettings.TakeLinkedDistance();
 }
 
 // Reset the motion planning buffers and clear the canonical machine internal state
@@ -38,6 +38,8 @@ Status UpdateSettings(uint8_t axis, EventData eventData, AxisSettings& axisSetti
 Status HomeZAxis(int32_t homingDistance, MotorController_t* mcState);
 Status HomeRAxis(int32_t homingDistance, MotorController_t* mcState);
 Status Move(uint8_t motorIndex, int32_t distance, const AxisSettings& settings);
+Status Move(uint8_t motorIndex, int32_t distance, MotorController_t* mcState);
+void ClearLinkedMoves(MotorController_t* mcState);
 void EndMotion();
 }
 
@@ -164,6 +164,10 @@ void Planner::SetPulsesPerUnit(uint8_t axis, float value)
 // Note: All math is done in absolute coordinates using "float precision" 
 // floating point (even though avr-gcc does this as single precision)
 //
+// Note: The speed and jerk apply along the line, so when more than one axis
+// moves they must already be limited to what each axis allows (see 
+// LineLimit())
+//
 // Note: Returning a status other than success means the endpoint is NOT
 // advanced. So lines that are too short to move will accumulate and get 
 // executed once the accumulated error exceeds the minimums 
@@ -182,20 +186,17 @@ Status Planner::PlanAccelerationLine(const float distances[], const uint8_t dire
     bf->cruiseVMax = speed;
     CopyAxisVector(bf->direction, directions);
 
-    if (fp_NOT_ZERO(distances[Z_AXIS]))
-    {
-        bf->length = distances[Z_AXIS];
-        bf->unit[Z_AXIS] = 1.0;
-        bf->target[Z_AXIS] = distances[Z_AXIS];
-    }
-    else if (fp_NOT_ZERO(distances[R_AXIS]))
+    // both axes may move at once, in which case the line is planned along 
+    // their combined length and each axis moves by its share of every segment
+    bf->length = LineLength(distances);
+    if (fp_ZERO(bf->length))
+        return MC_STATUS_MOVE_LENGTH_TOO_SMALL;
+
+    for (uint8_t axis = 0; axis < AXES_COUNT; axis++)
     {
-        bf->length = distances[R_AXIS];
-        bf->unit[R_AXIS] = 1.0;
-        bf->target[R_AXIS] = distances[R_AXIS];
+        bf->unit[axis] = distances[axis] / bf->length;
+        bf->target[axis] = distances[axis];
     }
-    else
-        return MC_STATUS_MOVE_LENGTH_TOO_SMALL;
 
     if (fabs(bf->jerk - state.previousJerk) < JERK_MATCH_PRECISION)
     {
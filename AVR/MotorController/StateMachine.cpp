@@ -362,7 +362,7 @@ MotorController_State_Machine_Event(
 
                               /**> Group: ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -727,7 +727,7 @@ MotorController_State_Machine_Event(
 
                               /**> Group: ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -868,7 +868,7 @@ MotorController_State_Machine_Event(
 
                               /**> Group: ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -942,7 +942,7 @@ MotorController_State_Machine_Event(
 
                               /**> ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -1035,7 +1035,7 @@ MotorController_State_Machine_Event(
                               /**> MoveRAxis */
 
                CHECK_STATUS(MotorController::Move(R_AXIS, _sm_evt.parameter,
-               _sm_obj->rAxisSettings), _sm_obj);
+               _sm_obj), _sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -1069,7 +1069,7 @@ MotorController_State_Machine_Event(
                               /**> MoveZAxis */
 
                CHECK_STATUS(MotorController::Move(Z_AXIS, _sm_evt.parameter,
-               _sm_obj->zAxisSettings), _sm_obj);
+               _sm_obj), _sm_obj);
                }
                break;
            case SetRAxisSettingRequested:
@@ -1252,7 +1252,7 @@ MotorController_State_Machine_Event(
 
                               /**> ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -1278,7 +1278,6 @@ MotorController_State_Machine_Event(
            case AxisAtLimit:
            case MotionComplete:
            case AxisLimitReached:
-           case ClearRequested:
            case PauseRequested:
            case ResumeRequested:
                {
@@ -1322,6 +1321,16 @@ MotorController_State_Machine_Event(
                DequeueEvent(_sm_obj);
                }
                break;
+           case ClearRequested:
+               {
+
+                              _sm_obj->sm_state = Ready;
+
+                              /**> ClearEventQueue */
+
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
+               }
+               break;
            case ErrorEncountered:
                {
 
@@ -1602,7 +1611,7 @@ MotorController_State_Machine_Event(
 
                               /**> ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -1676,7 +1685,7 @@ MotorController_State_Machine_Event(
 
                               /**> ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -1817,7 +1826,7 @@ MotorController_State_Machine_Event(
 
                               /**> ClearEventQueue */
 
-               eventQueue.Clear();
+               eventQueue.Clear(); MotorController::ClearLinkedMoves(_sm_obj);
                }
                break;
            case ErrorEncountered:
@@ -25,6 +25,7 @@
 //  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string.h> // memcpy
+#include <math.h>
 
 #include "Utils.h"
 #include "MachineDefinitions.h"
@@ -50,3 +51,36 @@ void CopyAxisVector(uint8_t dst[], const uint8_t src[])
 {
     memcpy(dst, src, sizeof(uint8_t) * AXES_COUNT);
 }
+
+// Return the length of a line moving each axis by the corresponding one of 
+// AXES_COUNT distances
+float LineLength(const float distances[])
+{
+    float sumOfSquares = 0.0;
+    for (uint8_t axis = 0; axis < AXES_COUNT; axis++)
+        sumOfSquares += distances[axis] * distances[axis];
+    return sqrt(sumOfSquares);
+}
+
+// Return the largest value of a per-axis limited quantity (e.g. speed or jerk)
+// along a line moving each axis by the corresponding one of AXES_COUNT 
+// distances, such that no moving axis exceeds its own limit
+// An axis moving by the full length of the line is limited to exactly its own
+// value, while an axis moving by a fraction of it allows proportionally more
+float LineLimit(const float distances[], const float axisLimits[])
+{
+    float length = LineLength(distances);
+    float limit = 0.0;
+    bool limited = false;
+
+    for (uint8_t axis = 0; axis < AXES_COUNT; axis++)
+    {
+        if (fp_ZERO(distances[axis])) continue;
+
+        float axisLimit = axisLimits[axis] * length / fabs(distances[axis]);
+        if (!limited || axisLimit < limit) limit = axisLimit;
+        limited = true;
+    }
+
+    return limit;
+}
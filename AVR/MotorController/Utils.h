@@ -32,6 +32,8 @@
 float Min4(float x1, float x2, float x3, float x4);
 void CopyAxisVector(float dst[], const float src[]);
 void CopyAxisVector(uint8_t dst[], const uint8_t src[]);
+float LineLength(const float distances[]);
+float LineLimit(const float distances[], const float axisLimits[]);
 
 #ifndef EPSILON
 #define EPSILON   0.00001 // rounding error for floats
@@ -35,6 +35,10 @@
 #include <avr/pgmspace.h>
 #endif  // DEBUG
 
+#ifdef SIMULATOR
+#include "sim/Simulator.h"
+#endif  // SIMULATOR
+
 MotorController_t mcState; // Instance of the global state struct, all members initialized to 0
 CommandBuffer commandBuffer;
 volatile bool limitSwitchHit;
@@ -149,6 +153,22 @@ static void QueryCommandBufferFull()
     }
 }
 
+// Check if the command buffer rejected a batch of commands and raise error
+// event if so
+static void QueryCommandBatch()
+{
+    Status status = commandBuffer.TakeBatchStatus();
+    if (status != MC_STATUS_SUCCESS)
+    {
+#ifdef DEBUG
+        printf_P(PSTR("ERROR: Rejected batch of commands, status: %d\n"), status);
+#endif
+        mcState.status = status;
+        EventData eventData;
+        MotorController_State_Machine_Event(&mcState, eventData, ErrorEncountered);
+    }
+}
+
 // Check if deceleration has started and raise event if so
 static void QueryDecelerationStarted()
 {
@@ -171,7 +191,11 @@ static void QueryAxisAtLimit()
     }
 }
 
+#ifdef SIMULATOR
+int main(int argc, char** argv)
+#else
 int main()
+#endif  // SIMULATOR
 {
 #ifdef DEBUG
     // Turn on LED
@@ -186,6 +210,10 @@ int main()
     Debug::Initialize();
 #endif
 
+#ifdef SIMULATOR
+    Simulator::Initialize(argc, argv);
+#endif  // SIMULATOR
+
     // Initialize I2C interface
     I2CInterface::Initialize(&mcState);
 
@@ -204,9 +232,15 @@ int main()
 
     for(;;)
     {
+#ifdef SIMULATOR
+        // Deliver I2C data and interrupts from the simulated hardware
+        Simulator::Poll();
+#endif  // SIMULATOR
+
         QueryReset();
         QueryError();
         QueryCommandBufferFull();
+        QueryCommandBatch();
         QueryLimitSwitchInterrupt();
         Planner::PlanHoldCallback();
         QueryMotionComplete();
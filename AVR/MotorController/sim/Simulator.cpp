@@ -0,0 +1,418 @@
+//  File: Simulator.cpp
+//  Simulated motor controller hardware for running the firmware on a host
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+#include "Simulator.h"
+#include "Hardware.h"
+#include "MachineDefinitions.h"
+#include "MotorControllerState.h"
+#include "CommandBuffer.h"
+#include "../../../C++/include/MotorController.h" // Shared header defining commands
+#include "../../../C++/include/mock_hardware/Shared.h" // Shared pipe names
+
+#define CYCLES_PER_MILLISECOND (F_CPU / 1000UL)
+#define IDLE_WAIT_MS 100 // longest time to wait for I2C data when the firmware has nothing to do
+
+// Simulated I/O registers
+SimRegister<uint8_t> DDRB, PORTB, PINB;
+SimRegister<uint8_t> DDRC, PORTC, PINC;
+SimRegister<uint8_t> DDRD, PORTD, PIND;
+SimRegister<uint8_t> PCICR, PCMSK0, PCMSK1, PCMSK2;
+SimRegister<uint8_t> TCCR0A, TCCR0B, TIMSK0, OCR0A, TCNT0, TIFR0;
+SimRegister<uint8_t> TCCR1A, TCCR1B, TIMSK1, TIFR1;
+SimRegister<uint16_t> OCR1A, TCNT1;
+SimRegister<uint8_t> TCCR2A, TCCR2B, TIMSK2, OCR2A, TCNT2, TIFR2;
+SimRegister<uint8_t> TWCR, TWAR, TWDR, TWSR;
+
+// Defined in main.cpp
+extern MotorController_t mcState;
+extern volatile bool limitSwitchHit;
+
+// A timer generating output compare interrupts in clear timer on compare match
+// mode, with the clock source selected by its control register
+struct Timer
+{
+    const void* control;        // control register holding the clock select bit
+    uint8_t clockSelectBM;      // clock select bit mask
+    uint32_t (*period)();       // number of cycles between interrupts
+    void (*isr)();              // output compare interrupt service routine
+    bool running;               // is the clock source selected?
+    uint64_t due;               // simulated time of the next interrupt in cycles
+};
+
+static uint32_t LoadTimerPeriod() { return LOAD_TIMER_PERIOD + 1; }
+static uint32_t DDATimerPeriod()  { return DDA_TIMER_PERIOD + 1; }
+static uint32_t ExecTimerPeriod() { return EXEC_TIMER_PERIOD + 1; }
+
+// Timers in order of interrupt priority
+static Timer timers[] =
+{
+    { &LOAD_TIMER_CTRLB, LOAD_TIMER_CS_BM, LoadTimerPeriod, LOAD_TIMER_ISR_vect, false, 0 },
+    { &DDA_TIMER_CTRLB,  DDA_TIMER_CS_BM,  DDATimerPeriod,  DDA_TIMER_ISR_vect,  false, 0 },
+    { &EXEC_TIMER_CTRLB, EXEC_TIMER_CS_BM, ExecTimerPeriod, EXEC_TIMER_ISR_vect, false, 0 }
+};
+#define TIMER_COUNT (sizeof(timers) / sizeof(timers[0]))
+#define DDA_TIMER (timers[1])
+
+static uint64_t now;                 // simulated time in cycles
+static int32_t position[AXES_COUNT]; // axis positions in steps, relative to the limit switches
+static bool pinChangePending;        // has a limit switch input changed with its pin change interrupt enabled?
+
+static int i2cWriteFd = -1;          // pipe the main firmware writes I2C data to
+static int i2cReadFd = -1;           // pipe the main firmware reads I2C data from
+static int interruptFd = -1;         // pipe the main firmware monitors for the interrupt signal
+static FILE* trace;                  // step timing trace, if requested
+
+static bool realtime;                // keep simulated time in step with the host's clock?
+static uint64_t anchorCycles;        // simulated time corresponding to anchorTime
+static struct timespec anchorTime;   // host time corresponding to anchorCycles
+
+// Return the simulated time in microseconds
+static double Microseconds()
+{
+    return static_cast<double>(now) * 1000.0 / CYCLES_PER_MILLISECOND;
+}
+
+// Return the host time elapsed since the anchor in cycles
+static uint64_t CyclesSinceAnchor()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    double ms = (time.tv_sec - anchorTime.tv_sec) * 1000.0 +
+                (time.tv_nsec - anchorTime.tv_nsec) / 1000000.0;
+    return static_cast<uint64_t>(ms * CYCLES_PER_MILLISECOND);
+}
+
+// Advance the simulated time to the specified time in cycles
+// When running in real time, wait for the host's clock to catch up first
+static void AdvanceTo(uint64_t cycles)
+{
+    if (cycles <= now) return;
+
+    if (realtime)
+    {
+        uint64_t elapsed = CyclesSinceAnchor();
+        uint64_t target = cycles - anchorCycles;
+        if (target > elapsed)
+            usleep(static_cast<useconds_t>((target - elapsed) * 1000 / CYCLES_PER_MILLISECOND));
+    }
+
+    now = cycles;
+}
+
+// Open the named pipe at the specified path, creating it if necessary
+static int OpenPipe(const char* path, int flags)
+{
+    struct stat info;
+    if (stat(path, &info) != 0 && mkfifo(path, 0666) != 0)
+    {
+        fprintf(stderr, "Unable to create pipe %s: %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    int fd = open(path, flags);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Unable to open pipe %s: %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+// Drive the limit switch inputs from the axis positions
+// A switch is hit (pulling its input low) when the axis is at or beyond its
+// limit, in the positive direction
+static void UpdateLimitSwitches()
+{
+    uint8_t inputs = PIND;
+
+    if (position[Z_AXIS] >= 0)
+        inputs &= ~Z_AXIS_LIMIT_SW_BM;
+    else
+        inputs |= Z_AXIS_LIMIT_SW_BM;
+
+    if (position[R_AXIS] >= 0)
+        inputs &= ~R_AXIS_LIMIT_SW_BM;
+    else
+        inputs |= R_AXIS_LIMIT_SW_BM;
+
+    uint8_t changed = inputs ^ PIND;
+    PIND.Drive(inputs);
+
+    if (PCICR & LIMIT_SW_PCIE_BM)
+    {
+        if (((changed & Z_AXIS_LIMIT_SW_BM) && (LIMIT_SW_PCMSK & Z_AXIS_LIMIT_SW_PCINT_BM)) ||
+            ((changed & R_AXIS_LIMIT_SW_BM) && (LIMIT_SW_PCMSK & R_AXIS_LIMIT_SW_PCINT_BM)))
+            pinChangePending = true;
+    }
+}
+
+// Move an axis by a single step in the direction selected by its direction pin
+static void Step(uint8_t axis, bool directionPinSet, uint8_t polarity)
+{
+    // The direction pin is cleared for positive distances (see Motors.cpp)
+    position[axis] += (directionPinSet ^ polarity) ? -1 : 1;
+
+    if (trace)
+        fprintf(trace, "%.1f %c %ld\n", Microseconds(), axis == Z_AXIS ? 'Z' : 'R',
+                static_cast<long>(position[axis]));
+
+    UpdateLimitSwitches();
+}
+
+// Signal the main firmware that the interrupt signal was asserted
+static void SignalInterrupt()
+{
+    if (write(interruptFd, "1", 1) != 1)
+        fprintf(stderr, "Unable to write to interrupt pipe: %s\n", strerror(errno));
+
+    if (trace)
+    {
+        fprintf(trace, "%.1f INTERRUPT\n", Microseconds());
+        fflush(trace);
+    }
+}
+
+// Call the I2C interrupt service routine with the specified bus status
+static void I2CEvent(uint8_t status)
+{
+    TWSR.Drive(status);
+    TWI_vect();
+}
+
+// Pass any data the main firmware wrote to the I2C interface, answering reads
+// Reads consist of the register address followed immediately by a request for
+// the response byte, as written by NamedPipeI2C_Device
+// Returns true if any data was received
+static bool ServiceI2C()
+{
+    unsigned char data[PIPE_BUF];
+    ssize_t count = read(i2cWriteFd, data, sizeof(data));
+    if (count <= 0) return false;
+
+    I2CEvent(TW_SR_SLA_ACK);
+
+    for (ssize_t i = 0; i < count; i++)
+    {
+        bool readRequested = (data[i] == MC_STATUS_REG || data[i] == MC_QUEUE_REG) &&
+                             !commandBuffer.IsReceivingCommand();
+
+        TWDR.Drive(data[i]);
+        I2CEvent(TW_SR_DATA_ACK);
+
+        if (readRequested)
+        {
+            I2CEvent(TW_SR_STOP);
+            I2CEvent(TW_ST_SLA_ACK);
+
+            unsigned char response = TWDR;
+            if (write(i2cReadFd, &response, 1) != 1)
+                fprintf(stderr, "Unable to write to I2C read pipe: %s\n", strerror(errno));
+
+            I2CEvent(TW_ST_LAST_DATA);
+            I2CEvent(TW_SR_SLA_ACK);
+        }
+    }
+
+    I2CEvent(TW_SR_STOP);
+    return true;
+}
+
+// Return whether or not the main loop has nothing to do until it receives a
+// command or an interrupt fires
+static bool FirmwareIdle()
+{
+    return commandBuffer.IsEmpty() && !mcState.queuedEvent && !mcState.motionComplete &&
+           !mcState.error && !mcState.reset && !mcState.axisAtLimit && !mcState.decelerationStarted &&
+           !limitSwitchHit;
+}
+
+// Return the running timer with the earliest (and highest priority) interrupt,
+// or NULL if no timers are running
+static Timer* NextTimer()
+{
+    Timer* next = NULL;
+    for (uint8_t i = 0; i < TIMER_COUNT; i++)
+    {
+        if (timers[i].running && (next == NULL || timers[i].due < next->due))
+            next = &timers[i];
+    }
+    return next;
+}
+
+// Fire the interrupt for the specified timer at its due time
+static void FireTimer(Timer* timer)
+{
+    AdvanceTo(timer->due);
+
+    // The interrupt service routine may stop or restart the timer
+    timer->due = now + timer->period();
+    timer->isr();
+}
+
+// Parse the command line options
+static void ParseOptions(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+            realtime = true;
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            trace = fopen(argv[++i], "w");
+            if (trace == NULL)
+            {
+                fprintf(stderr, "Unable to open trace file %s: %s\n", argv[i], strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--z-home-distance") == 0 && i + 1 < argc)
+            position[Z_AXIS] = -atol(argv[++i]);
+        else if (strcmp(argv[i], "--r-home-distance") == 0 && i + 1 < argc)
+            position[R_AXIS] = -atol(argv[++i]);
+        else
+        {
+            fprintf(stderr,
+                    "Usage: %s [--trace <file>] [--realtime] [--z-home-distance <steps>] [--r-home-distance <steps>]\n"
+                    "  --trace             write the time (in microseconds) and position of every step to a file\n"
+                    "  --realtime          keep simulated time in step with the host's clock\n"
+                    "  --z-home-distance   starting distance of the z axis below its limit switch (default 0)\n"
+                    "  --r-home-distance   starting distance of the r axis from its limit switch (default 0)\n",
+                    argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Set up the simulated hardware, opening the pipes shared with the main
+// firmware in the current directory
+void Simulator::Initialize(int argc, char** argv)
+{
+    ParseOptions(argc, argv);
+
+    // Open the pipes for reading and writing, so that neither side blocks on
+    // opening them or sees them closed if the other side restarts
+    i2cWriteFd = OpenPipe(MOTOR_CONTROLLER_I2C_WRITE_PIPE, O_RDWR | O_NONBLOCK);
+    i2cReadFd = OpenPipe(MOTOR_CONTROLLER_I2C_READ_PIPE, O_RDWR);
+    interruptFd = OpenPipe(MOTOR_CONTROLLER_INTERRUPT_READ_PIPE, O_RDWR);
+
+    // Limit switch inputs are pulled up
+    PIND.Drive(Z_AXIS_LIMIT_SW_BM | R_AXIS_LIMIT_SW_BM);
+    UpdateLimitSwitches();
+
+    clock_gettime(CLOCK_MONOTONIC, &anchorTime);
+    anchorCycles = now;
+}
+
+// Handle the simulated hardware for one pass through the firmware's main loop,
+// delivering received I2C data or firing the next interrupt, or waiting for
+// the main firmware if there is nothing else to do
+void Simulator::Poll()
+{
+    if (ServiceI2C()) return;
+
+    if (pinChangePending)
+    {
+        pinChangePending = false;
+        LIMIT_SW_ISR_vect();
+        return;
+    }
+
+    Timer* timer = NextTimer();
+    if (timer != NULL)
+    {
+        FireTimer(timer);
+        return;
+    }
+
+    if (FirmwareIdle())
+    {
+        struct pollfd descriptor = { i2cWriteFd, POLLIN, 0 };
+        poll(&descriptor, 1, IDLE_WAIT_MS);
+
+        if (realtime)
+            // Time passes while idle as well
+            now = anchorCycles + CyclesSinceAnchor();
+    }
+}
+
+// Busy-wait for the specified time, firing any interrupts that come due
+void Simulator::Delay(double milliseconds)
+{
+    uint64_t end = now + static_cast<uint64_t>(milliseconds * CYCLES_PER_MILLISECOND);
+
+    Timer* timer;
+    while ((timer = NextTimer()) != NULL && timer->due <= end)
+        FireTimer(timer);
+
+    AdvanceTo(end);
+}
+
+// Follow changes the firmware makes to registers that affect the simulated
+// hardware
+void Simulator::RegisterWritten(const void* reg, uint16_t previous, uint16_t value)
+{
+    uint16_t set = value & ~previous;
+    uint16_t cleared = previous & ~value;
+
+    for (uint8_t i = 0; i < TIMER_COUNT; i++)
+    {
+        if (reg != timers[i].control) continue;
+
+        if (set & timers[i].clockSelectBM)
+        {
+            timers[i].running = true;
+            timers[i].due = now + timers[i].period();
+        }
+        else if (cleared & timers[i].clockSelectBM)
+            timers[i].running = false;
+    }
+
+    // Clearing the DDA timer count restarts its period
+    if (reg == &DDA_TIMER_CNT && DDA_TIMER.running)
+        DDA_TIMER.due = now + DDA_TIMER.period();
+
+    // Step pulses start on the rising edge of the step pins
+    if (reg == &MOTOR_Z_STEP_PORT && (set & MOTOR_Z_STEP_BM))
+        Step(Z_AXIS, MOTOR_Z_DIRECTION_PORT & MOTOR_Z_DIRECTION_BM, Z_AXIS_MOTOR_POLARITY);
+
+    if (reg == &MOTOR_R_STEP_PORT && (set & MOTOR_R_STEP_BM))
+        Step(R_AXIS, MOTOR_R_DIRECTION_PORT & MOTOR_R_DIRECTION_BM, R_AXIS_MOTOR_POLARITY);
+
+    // The interrupt signal is active low
+    if (reg == &INTERRUPT_PORT && (cleared & INTERRUPT_BM))
+        SignalInterrupt();
+}
@@ -0,0 +1,44 @@
+//  File: Simulator.h
+//  Simulated motor controller hardware for running the firmware on a host
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+
+// The simulator stands in for the AVR peripherals the firmware uses:
+//   - I2C traffic is exchanged with the main firmware over the same named pipes
+//     used by its mock hardware build (see C++/include/mock_hardware/Shared.h)
+//   - the interrupt signal is reported on the motor controller interrupt pipe
+//   - timers fire their interrupt service routines in simulated time
+//   - step pulses move simulated axes, which drive the limit switch inputs,
+//     and can be written to a step timing trace
+namespace Simulator
+{
+void Initialize(int argc, char** argv);
+void Poll();
+void Delay(double milliseconds);
+void RegisterWritten(const void* reg, uint16_t previous, uint16_t value);
+}
+
+#endif  // SIMULATOR_H
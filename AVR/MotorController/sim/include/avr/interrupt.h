@@ -0,0 +1,47 @@
+//  File: interrupt.h
+//  Simulated interrupt handling for the host simulator build
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+// Interrupt service routines are plain functions that the simulator calls
+// when the corresponding (simulated) interrupt fires
+// Since the simulator only calls them between iterations of the main loop,
+// enabling and disabling interrupts has no effect
+#define ISR(vector) extern "C" void vector(void)
+
+inline void sei() {}
+inline void cli() {}
+
+extern "C"
+{
+void PCINT2_vect(void);
+void TIMER2_COMPA_vect(void);
+void TIMER1_COMPA_vect(void);
+void TIMER0_COMPA_vect(void);
+void TWI_vect(void);
+}
+
+#endif  // SIM_AVR_INTERRUPT_H
@@ -0,0 +1,184 @@
+//  File: io.h
+//  Simulated ATmega328P I/O registers for the host simulator build
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+
+// An I/O register that reports every write to the simulator, so that it can
+// follow pin changes (e.g. step pulses) and timer control bits as the firmware
+// makes them
+template <typename T>
+class SimRegister
+{
+public:
+    SimRegister() : value(0) {}
+
+    operator T() const { return value; }
+    // Operands are ints, as they are after promotion on the AVR, so that
+    // masks like ~(1<<PD7) narrow to the register width without warnings
+    SimRegister& operator=(int data) { Write(data); return *this; }
+    SimRegister& operator|=(int data) { Write(value | data); return *this; }
+    SimRegister& operator&=(int data) { Write(value & data); return *this; }
+    SimRegister& operator^=(int data) { Write(value ^ data); return *this; }
+
+    // Set the value without reporting it, for use by the simulator itself
+    void Drive(T data) { value = data; }
+
+private:
+    SimRegister(const SimRegister&);
+    SimRegister& operator=(const SimRegister&);
+
+    void Write(T data);
+
+    volatile T value;
+};
+
+namespace Simulator
+{
+void RegisterWritten(const void* reg, uint16_t previous, uint16_t value);
+}
+
+template <typename T>
+void SimRegister<T>::Write(T data)
+{
+    T previous = value;
+    value = data;
+    Simulator::RegisterWritten(this, previous, data);
+}
+
+// Ports
+extern SimRegister<uint8_t> DDRB, PORTB, PINB;
+extern SimRegister<uint8_t> DDRC, PORTC, PINC;
+extern SimRegister<uint8_t> DDRD, PORTD, PIND;
+
+// Pin change interrupts
+extern SimRegister<uint8_t> PCICR, PCMSK0, PCMSK1, PCMSK2;
+
+// Timer 0 (8-bit)
+extern SimRegister<uint8_t> TCCR0A, TCCR0B, TIMSK0, OCR0A, TCNT0, TIFR0;
+
+// Timer 1 (16-bit)
+extern SimRegister<uint8_t> TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern SimRegister<uint16_t> OCR1A, TCNT1;
+
+// Timer 2 (8-bit)
+extern SimRegister<uint8_t> TCCR2A, TCCR2B, TIMSK2, OCR2A, TCNT2, TIFR2;
+
+// Two-wire (I2C) interface
+extern SimRegister<uint8_t> TWCR, TWAR, TWDR, TWSR;
+
+// Port bits
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// Data direction bits
+#define DDB0 0
+#define DDB1 1
+#define DDB2 2
+#define DDB3 3
+#define DDB4 4
+#define DDB5 5
+#define DDB6 6
+#define DDB7 7
+#define DDC0 0
+#define DDC1 1
+#define DDC2 2
+#define DDC3 3
+#define DDC4 4
+#define DDC5 5
+#define DDC6 6
+#define DDD0 0
+#define DDD1 1
+#define DDD2 2
+#define DDD3 3
+#define DDD4 4
+#define DDD5 5
+#define DDD6 6
+#define DDD7 7
+
+// Pin change interrupt bits
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT21 5
+#define PCINT22 6
+#define PCINT23 7
+
+// Timer bits
+#define CS00   0
+#define CS01   1
+#define CS02   2
+#define WGM01  1
+#define OCIE0A 1
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define WGM12  3
+#define OCIE1A 1
+#define OCF1A  1
+#define CS20   0
+#define CS21   1
+#define CS22   2
+#define WGM21  1
+#define OCIE2A 1
+
+// Two-wire interface bits
+#define TWIE  0
+#define TWEN  2
+#define TWWC  3
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA  6
+#define TWINT 7
+
+#define _BV(bit) (1 << (bit))
+
+#endif  // SIM_AVR_IO_H
@@ -0,0 +1,54 @@
+//  File: twi.h
+//  Two-wire interface status codes for the host simulator build
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SIM_UTIL_TWI_H
+#define SIM_UTIL_TWI_H
+
+#include <avr/io.h>
+
+#define TW_STATUS_MASK 0xF8
+#define TW_STATUS      (TWSR & TW_STATUS_MASK)
+
+// Slave receiver
+#define TW_SR_SLA_ACK            0x60
+#define TW_SR_ARB_LOST_SLA_ACK   0x68
+#define TW_SR_GCALL_ACK          0x70
+#define TW_SR_ARB_LOST_GCALL_ACK 0x78
+#define TW_SR_DATA_ACK           0x80
+#define TW_SR_DATA_NACK          0x88
+#define TW_SR_GCALL_DATA_ACK     0x90
+#define TW_SR_GCALL_DATA_NACK    0x98
+#define TW_SR_STOP               0xA0
+
+// Slave transmitter
+#define TW_ST_SLA_ACK            0xA8
+#define TW_ST_ARB_LOST_SLA_ACK   0xB0
+#define TW_ST_DATA_ACK           0xB8
+#define TW_ST_DATA_NACK          0xC0
+#define TW_ST_LAST_DATA          0xC8
+
+// Miscellaneous
+#define TW_NO_INFO               0xF8
+#define TW_BUS_ERROR             0x00
+
+#endif  // SIM_UTIL_TWI_H
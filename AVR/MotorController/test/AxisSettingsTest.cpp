@@ -34,6 +34,7 @@ class AxisSettingsTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testSetMicrosteppingMode);
     CPPUNIT_TEST(testSetUnitsPerRevolution);
     CPPUNIT_TEST(testSetStepAngle);
+    CPPUNIT_TEST(testTakeLinkedDistance);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -140,6 +141,19 @@ public:
         CPPUNIT_ASSERT_EQUAL(static_cast<uint8_t>(MC_STATUS_SUCCESS), settings.SetStepAngle(1));
     }
 
+    void testTakeLinkedDistance()
+    {
+        AxisSettings settings;
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(0), settings.TakeLinkedDistance());
+
+        settings.SetLinkedDistance(-60000);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(-60000), settings.TakeLinkedDistance());
+
+        // A linked distance only applies to a single move
+        CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(0), settings.TakeLinkedDistance());
+    }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(AxisSettingsTest);
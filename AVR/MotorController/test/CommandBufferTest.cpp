@@ -33,8 +33,16 @@ class CommandBufferTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testAddAndRemoveNonGeneralCommand);
     CPPUNIT_TEST(testAddAndRemoveGeneralCommand);
     CPPUNIT_TEST(testAddStatusRegister);
+    CPPUNIT_TEST(testSelectReadRegister);
+    CPPUNIT_TEST(testIsReceivingCommand);
+    CPPUNIT_TEST(testFreeCapacity);
     CPPUNIT_TEST(testAddWhenCapacityExceeded);
     CPPUNIT_TEST(testIsFull);
+    CPPUNIT_TEST(testAddAndRemoveBatch);
+    CPPUNIT_TEST(testBatchWithInvalidChecksum);
+    CPPUNIT_TEST(testBatchWithInvalidCount);
+    CPPUNIT_TEST(testBatchExceedingCapacity);
+    CPPUNIT_TEST(testIncompleteBatch);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -58,6 +66,27 @@ private:
             buffer->AddCommandByte(nonGeneralCommands[commandIndex][byteIndex]);
     }
 
+    // Add the specified number of test commands as a batch, without the
+    // checksum, and return the checksum expected to follow them
+    unsigned char addBatch(int commandCount)
+    {
+        buffer->AddCommandByte(MC_BATCH_REG);
+        buffer->AddCommandByte(commandCount);
+        unsigned char checksum = MC_UpdateBatchChecksum(0, commandCount);
+
+        for (int commandIndex = 0; commandIndex < commandCount; commandIndex++)
+        {
+            for (int byteIndex = 0; byteIndex < COMMAND_SIZE; byteIndex++)
+            {
+                unsigned char data = nonGeneralCommands[commandIndex % TEST_COMMANDS_SIZE][byteIndex];
+                buffer->AddCommandByte(data);
+                checksum = MC_UpdateBatchChecksum(checksum, data);
+            }
+        }
+
+        return checksum;
+    }
+
 public:
 
     void setUp()
@@ -154,6 +183,77 @@ public:
         CPPUNIT_ASSERT_EQUAL(0, command.Parameter());
     }
 
+    void testSelectReadRegister()
+    {
+        Command command;
+
+        CPPUNIT_ASSERT_EQUAL(MC_STATUS_REG, buffer->SelectedReadRegister());
+
+        buffer->AddCommandByte(MC_QUEUE_REG);
+        CPPUNIT_ASSERT_EQUAL(MC_QUEUE_REG, buffer->SelectedReadRegister());
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+
+        buffer->AddCommandByte(MC_STATUS_REG);
+        CPPUNIT_ASSERT_EQUAL(MC_STATUS_REG, buffer->SelectedReadRegister());
+
+        // The register address is only a read register when it begins a command
+        buffer->AddCommandByte(MC_ROT_SETTINGS_REG);
+        buffer->AddCommandByte(MC_JERK);
+        buffer->AddCommandByte(MC_QUEUE_REG);
+        buffer->AddCommandByte(0x00);
+        buffer->AddCommandByte(0x00);
+        buffer->AddCommandByte(0x00);
+        CPPUNIT_ASSERT_EQUAL(MC_STATUS_REG, buffer->SelectedReadRegister());
+
+        buffer->GetCommand(command);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(MC_QUEUE_REG), command.Parameter());
+    }
+
+    void testIsReceivingCommand()
+    {
+        CPPUNIT_ASSERT(!buffer->IsReceivingCommand());
+
+        // Read registers and general commands don't leave a command partly received
+        buffer->AddCommandByte(MC_STATUS_REG);
+        buffer->AddCommandByte(MC_INTERRUPT);
+        CPPUNIT_ASSERT(!buffer->IsReceivingCommand());
+
+        buffer->AddCommandByte(MC_Z_ACTION_REG);
+        buffer->AddCommandByte(MC_MOVE);
+        CPPUNIT_ASSERT(buffer->IsReceivingCommand());
+        buffer->AddCommandByte(0x00);
+        buffer->AddCommandByte(0x00);
+        buffer->AddCommandByte(0x00);
+        buffer->AddCommandByte(0x01);
+        CPPUNIT_ASSERT(!buffer->IsReceivingCommand());
+
+        buffer->AddCommandByte(MC_BATCH_REG);
+        CPPUNIT_ASSERT(buffer->IsReceivingCommand());
+        buffer->EndTransmission();
+        CPPUNIT_ASSERT(!buffer->IsReceivingCommand());
+    }
+
+    void testFreeCapacity()
+    {
+        Command command;
+        uint8_t capacity = COMMAND_BUFFER_SIZE / COMMAND_SIZE;
+
+        CPPUNIT_ASSERT_EQUAL(capacity, buffer->FreeCapacity());
+
+        addNonGeneralCommand(0);
+        buffer->AddCommandByte(MC_PAUSE);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint8_t>(capacity - 2), buffer->FreeCapacity());
+
+        // A batch takes up space only once it has been accepted
+        unsigned char checksum = addBatch(3);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint8_t>(capacity - 2), buffer->FreeCapacity());
+        buffer->AddCommandByte(checksum);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint8_t>(capacity - 5), buffer->FreeCapacity());
+
+        buffer->GetCommand(command);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint8_t>(capacity - 4), buffer->FreeCapacity());
+    }
+
     void testAddWhenCapacityExceeded()
     {
         Command command;
@@ -192,6 +292,108 @@ public:
 
         CPPUNIT_ASSERT(buffer->IsFull());
     }
+
+    void testAddAndRemoveBatch()
+    {
+        Command command;
+
+        // A single command received before the batch remains first
+        addNonGeneralCommand(3);
+
+        unsigned char checksum = addBatch(TEST_COMMANDS_SIZE);
+
+        // None of the batch is available until the checksum arrives
+        buffer->GetCommand(command);
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+
+        buffer->AddCommandByte(checksum);
+        buffer->EndTransmission();
+
+        for (int commandIndex = 0; commandIndex < TEST_COMMANDS_SIZE; commandIndex++)
+        {
+            CPPUNIT_ASSERT(!buffer->IsEmpty());
+            buffer->GetCommand(command);
+            CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(nonGeneralCommands[commandIndex][0]), command.Register());
+            CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(nonGeneralCommands[commandIndex][1]), command.Action());
+            CPPUNIT_ASSERT_EQUAL(testCommandParameters[commandIndex], command.Parameter());
+        }
+
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_SUCCESS), buffer->TakeBatchStatus());
+
+        // Commands received after the batch are handled as usual
+        buffer->AddCommandByte(MC_INTERRUPT);
+        buffer->GetCommand(command);
+        CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(MC_GENERAL_REG), command.Register());
+        CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(MC_INTERRUPT), command.Action());
+    }
+
+    void testBatchWithInvalidChecksum()
+    {
+        unsigned char checksum = addBatch(2);
+        buffer->AddCommandByte(checksum + 1);
+        buffer->EndTransmission();
+
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_BATCH_INVALID), buffer->TakeBatchStatus());
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_SUCCESS), buffer->TakeBatchStatus());
+
+        // The buffer accepts a valid batch afterwards
+        checksum = addBatch(2);
+        buffer->AddCommandByte(checksum);
+        CPPUNIT_ASSERT(!buffer->IsEmpty());
+    }
+
+    void testBatchWithInvalidCount()
+    {
+        addBatch(MC_MAX_BATCH_COMMANDS + 1);
+        buffer->EndTransmission();
+
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_BATCH_INVALID), buffer->TakeBatchStatus());
+    }
+
+    void testBatchExceedingCapacity()
+    {
+        // Leave room for fewer commands than the batch contains
+        int commandCount = (COMMAND_BUFFER_SIZE / COMMAND_SIZE) - MC_MAX_BATCH_COMMANDS + 1;
+        for (int i = 0; i < commandCount; i++)
+            addNonGeneralCommand(0);
+
+        unsigned char checksum = addBatch(MC_MAX_BATCH_COMMANDS);
+        buffer->AddCommandByte(checksum);
+        buffer->EndTransmission();
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_COMMAND_BUFFER_FULL), buffer->TakeBatchStatus());
+
+        // Only the commands received before the batch are available
+        Command command;
+        for (int i = 0; i < commandCount; i++)
+            buffer->GetCommand(command);
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+    }
+
+    void testIncompleteBatch()
+    {
+        Command command;
+
+        // The master stops transmitting partway through the batch
+        addBatch(2);
+        buffer->EndTransmission();
+
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<Status>(MC_STATUS_SUCCESS), buffer->TakeBatchStatus());
+
+        // The retried batch is accepted
+        unsigned char checksum = addBatch(2);
+        buffer->AddCommandByte(checksum);
+        buffer->EndTransmission();
+
+        buffer->GetCommand(command);
+        buffer->GetCommand(command);
+        CPPUNIT_ASSERT(buffer->IsEmpty());
+        CPPUNIT_ASSERT_EQUAL(testCommandParameters[1], command.Parameter());
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(CommandBufferTest);
@@ -0,0 +1,113 @@
+//  File: UtilsTest.cpp
+//
+//  This file is part of the Ember Motor Controller firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Utils.h"
+#include "MachineDefinitions.h"
+
+class UtilsTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(UtilsTest);
+    CPPUNIT_TEST(testLineLength);
+    CPPUNIT_TEST(testLineLimitSingleAxis);
+    CPPUNIT_TEST(testLineLimitBothAxes);
+    CPPUNIT_TEST(testLineLimitNoMotion);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+
+public:
+    void setUp()
+    {
+    }
+
+    void tearDown()
+    {
+    }
+
+    void testLineLength()
+    {
+        float distances[AXES_COUNT];
+        distances[Z_AXIS] = 3.0;
+        distances[R_AXIS] = 4.0;
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, LineLength(distances), 1e-6);
+    }
+
+    void testLineLimitSingleAxis()
+    {
+        // A single axis is limited to its own value, regardless of the other
+        // axis's limit
+        float distances[AXES_COUNT];
+        float limits[AXES_COUNT];
+        distances[Z_AXIS] = 2000.0;
+        distances[R_AXIS] = 0.0;
+        limits[Z_AXIS] = 300000.0;
+        limits[R_AXIS] = 1.0;
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(300000.0, LineLimit(distances, limits), 1e-3);
+
+        distances[Z_AXIS] = 0.0;
+        distances[R_AXIS] = 60000.0;
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, LineLimit(distances, limits), 1e-6);
+    }
+
+    void testLineLimitBothAxes()
+    {
+        // With a 3-4-5 line, the z axis moves 3/5 and the r axis moves 4/5 of
+        // the line, so the line may go 5/3 and 5/4 times faster than the
+        // respective axis limits
+        float distances[AXES_COUNT];
+        float limits[AXES_COUNT];
+        distances[Z_AXIS] = 3.0;
+        distances[R_AXIS] = 4.0;
+
+        limits[Z_AXIS] = 30.0;
+        limits[R_AXIS] = 100.0;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0, LineLimit(distances, limits), 1e-4);
+
+        limits[Z_AXIS] = 100.0;
+        limits[R_AXIS] = 40.0;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0, LineLimit(distances, limits), 1e-4);
+
+        // Neither axis exceeds its own limit along the line
+        float limit = LineLimit(distances, limits);
+        float length = LineLength(distances);
+        CPPUNIT_ASSERT(limit * distances[Z_AXIS] / length <= limits[Z_AXIS] + 1e-4);
+        CPPUNIT_ASSERT(limit * distances[R_AXIS] / length <= limits[R_AXIS] + 1e-4);
+    }
+
+    void testLineLimitNoMotion()
+    {
+        float distances[AXES_COUNT] = { 0 };
+        float limits[AXES_COUNT];
+        limits[Z_AXIS] = 30.0;
+        limits[R_AXIS] = 40.0;
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, LineLimit(distances, limits), 1e-6);
+    }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UtilsTest);
@@ -21,6 +21,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/epoll.h>
@@ -79,11 +80,10 @@ int CommandPipe::GetFileDescriptor() const
 }
 
 // Read one new-line or null delimited message from the named pipe
-EventDataVec CommandPipe::Read()
+void CommandPipe::Read(EventDataVec& eventData)
 {
     char buffer;
-    EventDataVec eventData;
-    std::string command;
+    _command.clear();
 
     lseek(_readFd, 0, SEEK_SET);
 
@@ -92,12 +92,10 @@ EventDataVec CommandPipe::Read()
         if (buffer == '\n' || buffer == '\0')
             break;
         else
-            command.push_back(buffer);
+            _command.push_back(buffer);
     }
     
-    eventData.push_back(EventData(command));
-
-    return eventData;
+    eventData.push_back(EventData(_command));
 }
 
 bool CommandPipe::QualifyEvents(uint32_t events) const
@@ -0,0 +1,203 @@
+//  File:   CrossSection.cpp
+//  Measures the area cured by a layer, from its slice image
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stddef.h>
+
+#include <CrossSection.h>
+
+// pixels at or above half brightness are cured, i.e. those with the high bit 
+// set
+constexpr int CURED_SHIFT = 7;
+
+// Constructs a cross-section with nothing cured.
+CrossSection::CrossSection() :
+_curedPixels(0),
+_totalPixels(0),
+_islands(0),
+_edgePixels(0)
+{
+}
+
+// Measures the cured area, the number of islands (8-connected groups of cured
+// pixels), and the number of cured pixels on an edge in the given 8-bit 
+// grayscale image.
+void CrossSection::Measure(const unsigned char* pixels, int width, int height)
+{
+    size_t numPixels = (size_t)width * height;
+    _totalPixels = numPixels;
+    
+    // a branch-free count, which the compiler can vectorize
+    unsigned long cured = 0;
+    for (size_t i = 0; i < numPixels; i++)
+        cured += pixels[i] >> CURED_SHIFT;
+    _curedPixels = cured;
+    
+    _islands = 0;
+    _edgePixels = 0;
+    if (_curedPixels == 0)
+        return;
+    
+    // cured pixels are on an edge unless all four of their neighbors are 
+    // cured too, so those on the border of the image always are
+    unsigned long interior = 0;
+    for (int y = 1; y < height - 1; y++)
+    {
+        const unsigned char* above = pixels + (size_t)(y - 1) * width;
+        const unsigned char* row = above + width;
+        const unsigned char* below = row + width;
+        for (int x = 1; x < width - 1; x++)
+            interior += (row[x] & row[x - 1] & row[x + 1] & above[x] & 
+                         below[x]) >> CURED_SHIFT;
+    }
+    _edgePixels = _curedPixels - interior;
+    
+    // find the runs of cured pixels in each row, and join each one to the 
+    // runs it touches in the row above, counting each run as a new island 
+    // until it's joined to another one
+    _parents.clear();
+    _previousRuns.clear();
+    _previousIDs.clear();
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = pixels + (size_t)y * width;
+        _currentRuns.clear();
+        _currentIDs.clear();
+        
+        int x = 0;
+        while (x < width)
+        {
+            if ((row[x] >> CURED_SHIFT) == 0)
+            {
+                x++;
+                continue;
+            }
+            
+            int start = x;
+            while (x < width && (row[x] >> CURED_SHIFT) != 0)
+                x++;
+            
+            int id = _parents.size();
+            _parents.push_back(id);
+            _currentRuns.push_back(start);
+            _currentRuns.push_back(x - 1);
+            _currentIDs.push_back(id);
+            _islands++;
+        }
+        
+        // runs touch if they overlap, including diagonally
+        size_t first = 0;
+        for (size_t i = 0; i < _currentIDs.size(); i++)
+        {
+            int start = _currentRuns[2 * i];
+            int end = _currentRuns[2 * i + 1];
+            
+            while (first < _previousIDs.size() && 
+                   _previousRuns[2 * first + 1] < start - 1)
+                first++;
+            
+            for (size_t j = first; j < _previousIDs.size() && 
+                                   _previousRuns[2 * j] <= end + 1; j++)
+            {
+                int root = FindRoot(_currentIDs[i]);
+                int previousRoot = FindRoot(_previousIDs[j]);
+                if (root != previousRoot)
+                {
+                    _parents[root] = previousRoot;
+                    _islands--;
+                }
+            }
+        }
+        
+        _previousRuns.swap(_currentRuns);
+        _previousIDs.swap(_currentIDs);
+    }
+}
+
+// Returns the run at the root of the group containing the given run, 
+// shortening the path to it along the way.
+int CrossSection::FindRoot(int run)
+{
+    while (_parents[run] != run)
+    {
+        _parents[run] = _parents[_parents[run]];
+        run = _parents[run];
+    }
+    return run;
+}
+
+// Returns how much faster than normal the layer can be separated and 
+// approached: the given maximum when the cured area is at most the given 
+// small percentage of the image, falling linearly to 1 (i.e. normal speed)
+// at the given large percentage.  Layers with more than the given number of 
+// islands always use normal speed, since they have many small features that 
+// may be too fragile to move faster.
+double CrossSection::GetSpeedFactor(double smallAreaPercent, 
+                                    double largeAreaPercent,
+                                    double maxSpeedFactor, int maxIslands) const
+{
+    if (maxSpeedFactor <= 1.0 || _islands > maxIslands || _totalPixels == 0)
+        return 1.0;
+    
+    double areaPercent = 100.0 * _curedPixels / _totalPixels;
+    if (areaPercent >= largeAreaPercent)
+        return 1.0;
+    
+    if (areaPercent <= smallAreaPercent)
+        return maxSpeedFactor;
+    
+    return maxSpeedFactor - (maxSpeedFactor - 1.0) * 
+                            (areaPercent - smallAreaPercent) / 
+                            (largeAreaPercent - smallAreaPercent);
+}
+
+// Returns the percentage of the cured pixels that are on an edge.
+double CrossSection::GetEdgePercent() const
+{
+    if (_curedPixels == 0)
+        return 0.0;
+    
+    return 100.0 * _edgePixels / _curedPixels;
+}
+
+// Returns how much longer than normal the layer should be exposed: the given 
+// maximum when at most the given solid percentage of its cured pixels are on 
+// an edge, as for large solid areas, falling linearly to the given minimum at 
+// the given thin percentage, as for layers made mostly of thin features.
+double CrossSection::GetExposureFactor(double solidEdgePercent, 
+                                       double thinEdgePercent,
+                                       double minFactor, double maxFactor) const
+{
+    if (_curedPixels == 0)
+        return 1.0;
+    
+    double edgePercent = GetEdgePercent();
+    if (edgePercent <= solidEdgePercent)
+        return maxFactor;
+    
+    if (edgePercent >= thinEdgePercent)
+        return minFactor;
+    
+    return maxFactor - (maxFactor - minFactor) * 
+                       (edgePercent - solidEdgePercent) / 
+                       (thinEdgePercent - solidEdgePercent);
+}
@@ -23,6 +23,7 @@
 
 #include "DRM_Device.h"
 
+#include <unistd.h>
 #include <fcntl.h>
 #include <stdexcept>
 #include <xf86drm.h>
@@ -25,16 +25,78 @@
 #include <sys/epoll.h>
 #include <stdexcept>
 #include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <signal.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/syscall.h>
+#include <cxxabi.h>
+#include <typeinfo>
+
+#include <rapidjson/writer.h>
+#include <rapidjson/filewritestream.h>
 
 #include "EventHandler.h"
+#include "VirtualClock.h"
 #include "ErrorMessage.h"
 #include "Logger.h"
+#include "Settings.h"
+#include "Shared.h"
+#include "utils.h"
+
+using namespace rapidjson;
+
+// shortest interval at which the watchdog checks for stalled callbacks
+constexpr useconds_t MIN_WATCHDOG_INTERVAL_US = 1000;
+// percentiles included in reported statistics
+constexpr double STATS_PERCENTILES[] = {50.0, 90.0, 99.0};
+
+// Read the first line of the given file into the given buffer, returning 
+// false if it can't be read.
+static bool ReadLine(const char* path, char* line, size_t len)
+{
+    FILE* pFile = fopen(path, "r");
+    if (pFile == NULL)
+        return false;
+    
+    bool ok = fgets(line, len, pFile) != NULL;
+    fclose(pFile);
+    if (ok)
+        line[strcspn(line, "\n")] = '\0';
+    return ok;
+}
+
+// Get the readable form of the given mangled C++ name.
+static std::string Demangle(const char* mangled)
+{
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, NULL, NULL, &status);
+    std::string name(status == 0 ? demangled : mangled);
+    free(demangled);
+    return name;
+}
+
+// Get a readable class name for the given subscriber.
+static std::string GetClassName(ICallback* pObject)
+{
+    return Demangle(typeid(*pObject).name());
+}
 
 // Constructor, initializes epoll instance according to number of events
 EventHandler::EventHandler() :
 _epollFd(epoll_create(MaxEventTypes)),
-_exit(false)
+_exit(false),
+_budget(0),
+_callbackSequence(0),
+_callbackStart(0),
+_callbackEventType(Undefined),
+_callbackSubscriber(0),
+_stopWatchdog(false),
+_watchdogRunning(false),
+_eventThreadID(0),
+_pVirtualClock(NULL)
 {
     if (_epollFd < 0) 
         throw std::runtime_error(ErrorMessage::Format(EpollCreate, errno));
@@ -54,6 +116,9 @@ void EventHandler::AddEvent(EventType eventType, IResource* pResource)
     epoll_event event;
     event.events = pResource->GetEventTypes();
     event.data.fd = pResource->GetFileDescriptor();
+    if (event.data.fd >= _resources.size())
+        _resources.resize(event.data.fd + 1, 
+                          std::make_pair(Undefined, (IResource*)NULL));
     _resources[event.data.fd] = std::make_pair(eventType, pResource);
     epoll_ctl(_epollFd, EPOLL_CTL_ADD, event.data.fd, &event);
 }
@@ -62,6 +127,8 @@ void EventHandler::AddEvent(EventType eventType, IResource* pResource)
 void EventHandler::Subscribe(EventType eventType, ICallback* pObject)
 {
     _subscriptions[eventType].push_back(pObject);
+    _subscriberNames[eventType].push_back(GetClassName(pObject));
+    _subscriberStats[eventType].push_back(LatencyHistogram());
 }
 
 #ifdef DEBUG
@@ -79,6 +146,9 @@ void EventHandler::Begin(int numIterations)
 void EventHandler::Begin()
 {
     _exit = false;
+    
+    _budget = PrinterSettings::Instance().GetInt(EVENT_CALLBACK_BUDGET) * 1000;
+    StartWatchdog();
 
 #ifdef DEBUG
     // do repeatedly if _numIterations is zero 
@@ -93,19 +163,28 @@ void EventHandler::Begin()
     
     // Start event loop, waiting for events, and calling subscribers when loop
     // receives events
-    while(keepGoing)
+    while(keepGoing && !_exit)
     {
-        if (_exit)
-            return;
-
         int timeout = -1;
 #ifdef DEBUG
         // use 10 ms timeout for unit testing 
         if (!doForever)
             timeout = 10;
 #endif              
+        numFDs = 0;
+        if (_pVirtualClock != NULL)
+        {
+            // in simulated time, nothing waits for a timer: when no event is
+            // ready, time jumps to the next alarm instead
+            numFDs = epoll_wait(_epollFd, events, MaxEventTypes, 0);
+            if (numFDs == 0 && _pVirtualClock->AdvanceToNextAlarm())
+                continue;
+        }
+        
         // Do a blocking epoll_wait, there's nothing to do until it returns
-        numFDs = epoll_wait(_epollFd, events, MaxEventTypes, timeout);
+        if (numFDs == 0)
+            numFDs = epoll_wait(_epollFd, events, MaxEventTypes, timeout);
+        uint64_t wakeTime = GetMicros();
         
         if (numFDs)
         {
@@ -120,11 +199,11 @@ void EventHandler::Begin()
             
             for(int n = 0; n < numFDs; n++)
             {
-                epoll_event event = events[n];
+                const epoll_event& event = events[n];
                 
                 // Read the data associated with the event
-                IResource* resource = _resources[event.data.fd].second;
                 EventType eventType = _resources[event.data.fd].first;
+                IResource* resource = _resources[event.data.fd].second;
 
                 // Qualify the event
                 // The event loop only cares about specific types of events - it
@@ -133,17 +212,32 @@ void EventHandler::Begin()
                 if (!resource->QualifyEvents(event.events))
                     continue;
                 
-                EventDataVec eventData = resource->Read();
-                for (EventDataVec::iterator eventDataIt = eventData.begin();
-                        eventDataIt != eventData.end(); eventDataIt++)
+                uint64_t dispatchStart = GetMicros();
+                _queueingStats[eventType].Record(dispatchStart - wakeTime);
+                
+                _eventData.clear();
+                resource->Read(_eventData);
+                
+                const SubscriptionVec& subscriptions = _subscriptions[eventType];
+                HistogramVec& subscriberStats = _subscriberStats[eventType];
+                for (size_t i = 0; i < _eventData.size(); i++)
                 {
-                    // call each subscriber with the event data
-                    SubscriptionVec subscriptions = _subscriptions[eventType];
-
-                    for (SubscriptionVec::iterator it = subscriptions.begin();
-                            it != subscriptions.end(); it++)
-                        (*it)->Callback(eventType, *eventDataIt);
+                    // call each subscriber with the event data, timing each
+                    // call and letting the watchdog know which one is running
+                    for (size_t j = 0; j < subscriptions.size(); j++)
+                    {
+                        uint64_t callbackStart = GetMicros();
+                        PublishCallback(callbackStart, eventType, j);
+                        
+                        subscriptions[j]->Callback(eventType, _eventData[i]);
+                        
+                        PublishCallback(0, eventType, j);
+                        uint64_t elapsed = GetMicros() - callbackStart;
+                        subscriberStats[j].Record(elapsed);
+                        CheckBudget(eventType, j, elapsed);
+                    }
                 }
+                _dispatchStats[eventType].Record(GetMicros() - dispatchStart);
             } 
         }      
 #ifdef DEBUG
@@ -151,6 +245,8 @@ void EventHandler::Begin()
             keepGoing = false;
 #endif        
     }
+    
+    StopWatchdog();
 }
 
 void EventHandler::Handle(Command command)
@@ -158,6 +254,8 @@ void EventHandler::Handle(Command command)
     // PrintEngine handles all other commands
     if (command == Exit)
         _exit = true;
+    else if (command == ShowEventStats)
+        WriteStats(EVENT_STATS_FILE);
 }
 
 void EventHandler::Callback(EventType eventType, const EventData& data)
@@ -172,3 +270,258 @@ void EventHandler::Callback(EventType eventType, const EventData& data)
             _exit = true;
     }
 }
+
+// Log a warning if a callback that has completed exceeded the time budget.
+void EventHandler::CheckBudget(int eventType, int subscriber, uint64_t elapsed)
+{
+    if (_budget == 0 || elapsed <= _budget)
+        return;
+    
+    char detail[256];
+    snprintf(detail, sizeof(detail), 
+             "event type %d, subscriber %s took %llu ms (budget %llu ms)",
+             eventType, _subscriberNames[eventType][subscriber].c_str(),
+             (unsigned long long)(elapsed / 1000), 
+             (unsigned long long)(_budget / 1000));
+    Logger::LogMessage(LOG_WARNING, 
+                   ErrorMessage::Format(SlowEventCallback, detail).c_str());
+}
+
+// Let the watchdog thread know which callback is in progress and when it 
+// started, or that none is (when the start time is zero).  The sequence is odd
+// while the values are being changed, so that the watchdog can tell whether 
+// it read them all from the same callback.
+void EventHandler::PublishCallback(uint64_t start, int eventType, 
+                                   int subscriber)
+{
+    _callbackSequence.fetch_add(1);
+    _callbackEventType.store(eventType);
+    _callbackSubscriber.store(subscriber);
+    _callbackStart.store(start);
+    _callbackSequence.fetch_add(1);
+}
+
+// Start the thread that watches for callbacks exceeding the time budget, 
+// unless the budget is zero.
+void EventHandler::StartWatchdog()
+{
+    if (_budget == 0 || _watchdogRunning)
+        return;
+    
+    _eventThreadID = syscall(SYS_gettid);
+    _stopWatchdog.store(false);
+    if (pthread_create(&_watchdogThread, NULL, &WatchdogHelper, this) == 0)
+        _watchdogRunning = true;
+}
+
+// Stop the watchdog thread, if it's running.
+void EventHandler::StopWatchdog()
+{
+    if (!_watchdogRunning)
+        return;
+    
+    _stopWatchdog.store(true);
+    pthread_join(_watchdogThread, NULL);
+    _watchdogRunning = false;
+}
+
+// Static helper for starting the watchdog thread.
+void* EventHandler::WatchdogHelper(void* context)
+{
+    static_cast<EventHandler*>(context)->Watchdog();
+    return NULL;
+}
+
+// Periodically check whether the callback in progress has exceeded the time 
+// budget, and if so report where it's stuck.  Each stalled callback is 
+// reported only once.
+void EventHandler::Watchdog()
+{
+    useconds_t interval = _budget / 2;
+    if (interval < MIN_WATCHDOG_INTERVAL_US)
+        interval = MIN_WATCHDOG_INTERVAL_US;
+    
+    uint64_t reported = 0;
+    while (!_stopWatchdog.load())
+    {
+        usleep(interval);
+        
+        // take a consistent snapshot of the callback in progress, skipping 
+        // this check if it changed while being read
+        uint32_t sequence = _callbackSequence.load();
+        if (sequence & 1)
+            continue;
+        
+        uint64_t start = _callbackStart.load();
+        int eventType = _callbackEventType.load();
+        int subscriber = _callbackSubscriber.load();
+        if (_callbackSequence.load() != sequence)
+            continue;
+        
+        if (start == 0 || start == reported)
+            continue;
+        
+        uint64_t elapsed = GetMicros() - start;
+        if (elapsed <= _budget)
+            continue;
+        
+        reported = start;
+        ReportStall(eventType, subscriber, elapsed);
+    }
+}
+
+// Log the stalled callback, annotated with where the event thread is 
+// currently stuck: the system call it's blocked in (if any), the kernel 
+// function it's waiting in, and the function containing its user space 
+// program counter.  These are sampled from /proc rather than by signaling the
+// event thread, so that the stalled callback isn't disturbed (a signal would 
+// cut short any delay it's sleeping through).
+// Called on the watchdog thread, so this formats its messages locally rather 
+// than using Logger::LogError and its shared buffer.  Subscriptions are not 
+// changed while events are being handled, so the subscriber names are safe to
+// read here.
+void EventHandler::ReportStall(int eventType, int subscriber, uint64_t elapsed)
+{
+    const char* name = "unknown";
+    if (eventType >= 0 && eventType < MaxEventTypes && subscriber >= 0 &&
+        subscriber < (int)_subscriberNames[eventType].size())
+        name = _subscriberNames[eventType][subscriber].c_str();
+    
+    char path[64];
+    char syscallInfo[256] = "unknown";
+    char waitChannel[64] = "unknown";
+    snprintf(path, sizeof(path), "/proc/self/task/%d/syscall", _eventThreadID);
+    ReadLine(path, syscallInfo, sizeof(syscallInfo));
+    snprintf(path, sizeof(path), "/proc/self/task/%d/wchan", _eventThreadID);
+    ReadLine(path, waitChannel, sizeof(waitChannel));
+    
+    // the syscall file contains the system call number and its arguments 
+    // (or -1 if not in a system call, or "running"), followed by the stack 
+    // pointer and program counter
+    std::string location = "unknown";
+    const char* pcText = strrchr(syscallInfo, ' ');
+    if (pcText != NULL)
+    {
+        void* pc = (void*)strtoul(pcText + 1, NULL, 16);
+        Dl_info info;
+        if (dladdr(pc, &info) != 0)
+        {
+            if (info.dli_sname != NULL)
+                location = Demangle(info.dli_sname);
+            else if (info.dli_fname != NULL)
+                location = info.dli_fname;
+        }
+    }
+    
+    char detail[768];
+    snprintf(detail, sizeof(detail), 
+             "event type %d, subscriber %s running for %llu ms "
+             "(budget %llu ms); syscall: %s; waiting in: %s; at: %s",
+             eventType, name,
+             (unsigned long long)(elapsed / 1000), 
+             (unsigned long long)(_budget / 1000), 
+             syscallInfo, waitChannel, location.c_str());
+    Logger::LogMessage(LOG_WARNING, 
+                ErrorMessage::Format(StalledEventCallback, detail).c_str());
+}
+
+// Write a JSON object with the given histogram's summary to the given writer.
+static void WriteHistogram(Writer<FileWriteStream>& writer, 
+                           const LatencyHistogram& histogram)
+{
+    writer.StartObject();
+    writer.String("count");
+    writer.Uint64(histogram.GetCount());
+    writer.String("mean_us");
+    writer.Uint64(histogram.GetMean());
+    writer.String("max_us");
+    writer.Uint64(histogram.GetMax());
+    for (double percentile : STATS_PERCENTILES)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "p%d_us", (int)percentile);
+        writer.String(key);
+        writer.Uint64(histogram.GetPercentile(percentile));
+    }
+    
+    // the counts in each nonempty bucket, keyed by the bucket's upper limit
+    writer.String("buckets");
+    writer.StartObject();
+    for (int i = 0; i < NUM_LATENCY_BUCKETS; i++)
+    {
+        if (histogram.GetBucketCount(i) == 0)
+            continue;
+        
+        char key[24];
+        snprintf(key, sizeof(key), "%llu", 
+                 (unsigned long long)LatencyHistogram::GetBucketLimit(i));
+        writer.String(key);
+        writer.Uint64(histogram.GetBucketCount(i));
+    }
+    writer.EndObject();
+    
+    writer.EndObject();
+}
+
+// Write the latency statistics for all event types with any activity, as 
+// JSON, to the file at the given path, and log a one-line summary for each.
+void EventHandler::WriteStats(const char* path)
+{
+    FILE* pFile = fopen(path, "w");
+    if (pFile == NULL)
+    {
+        Logger::LogError(LOG_WARNING, errno, CantWriteEventStats);
+        return;
+    }
+    
+    char buffer[4096];
+    FileWriteStream stream(pFile, buffer, sizeof(buffer));
+    Writer<FileWriteStream> writer(stream);
+    
+    writer.StartObject();
+    writer.String("budget_ms");
+    writer.Uint64(_budget / 1000);
+    writer.String("events");
+    writer.StartArray();
+    for (int et = Undefined + 1; et < MaxEventTypes; et++)
+    {
+        if (_dispatchStats[et].GetCount() == 0)
+            continue;
+        
+        writer.StartObject();
+        writer.String("event_type");
+        writer.Int(et);
+        writer.String("queueing");
+        WriteHistogram(writer, _queueingStats[et]);
+        writer.String("dispatch");
+        WriteHistogram(writer, _dispatchStats[et]);
+        writer.String("subscribers");
+        writer.StartArray();
+        for (size_t i = 0; i < _subscriptions[et].size(); i++)
+        {
+            writer.StartObject();
+            writer.String("name");
+            writer.String(_subscriberNames[et][i].c_str());
+            writer.String("callback");
+            WriteHistogram(writer, _subscriberStats[et][i]);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        
+        char summary[256];
+        snprintf(summary, sizeof(summary), 
+                 "event type %d: %llu dispatches, queueing p99 %llu us, "
+                 "dispatch p99 %llu us, max %llu us", et,
+                 (unsigned long long)_dispatchStats[et].GetCount(),
+                 (unsigned long long)_queueingStats[et].GetPercentile(99.0),
+                 (unsigned long long)_dispatchStats[et].GetPercentile(99.0),
+                 (unsigned long long)_dispatchStats[et].GetMax());
+        Logger::LogMessage(LOG_INFO, summary);
+    }
+    writer.EndArray();
+    writer.EndObject();
+    stream.Flush();
+    
+    fclose(pFile);
+}
@@ -25,48 +25,153 @@
 
 #include "FrameBuffer.h"
 
-#include <Magick++.h>
 #include <iostream>
 #include <stdexcept>
+#include <cerrno>
+#include <cstring>
 #include <sys/mman.h>
+#include <poll.h>
 
 #include "Logger.h"
 #include "Filenames.h"
 
-FrameBuffer::FrameBuffer(int width, int height) :
-_drmDevice(DRM_DEVICE_NODE),
+// how long to wait for a page flip to be completed (several frames, at 60 Hz)
+constexpr int PAGE_FLIP_TIMEOUT_MS = 100;
+
+// Sets up the given DRM device to display images of the given resolution, in 
+// the given scan-out format, if any, or else in the one SelectFormat chooses.
+FrameBuffer::FrameBuffer(int width, int height, const std::string& deviceNode,
+                         const ScanoutFormat* pFormat) :
+ScanoutBuffers(width, height),
+_drmDevice(deviceNode),
 _drmResources(_drmDevice),
 _drmConnector(_drmDevice, _drmResources.GetConnectorId(0)),
 _drmEncoder(_drmDevice, _drmConnector),
-_drmDumbBuffer(_drmDevice, _drmConnector, width, height, 32),
-_drmFrameBuffer(_drmDevice, _drmDumbBuffer, 24),
-_image(width * height)
+_format(SelectFormat(width, height, pFormat)),
+_flipPending(false)
 {
-    std::cout << "Selecting " << _drmDumbBuffer.GetWidth() << " x " <<
-            _drmDumbBuffer.GetHeight() << " as video resolution" << std::endl;
-    
-    // Check for a connected display.
-    if (!_drmConnector.IsConnected())
+    for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
     {
-        throw std::runtime_error(Logger::LogError(LOG_ERR,
-                                                  DrmConnectorNotConnected));
+        _pDrmDumbBuffers[i].reset(new DRM_DumbBuffer(_drmDevice, _drmConnector,
+                                                     width, height,
+                                                     _format.bitsPerPixel));
+        _pDrmFrameBuffers[i].reset(new DRM_FrameBuffer(_drmDevice,
+                                                       *_pDrmDumbBuffers[i],
+                                                       _format.depth));
     }
+    
+    std::cout << "Selecting " << _pDrmDumbBuffers[0]->GetWidth() << " x " <<
+            _pDrmDumbBuffers[0]->GetHeight() << " as video resolution, in " <<
+            _format.name << " format" << std::endl;
  
-    // Perform mode setting.
+    // Perform mode setting, starting with black displayed.
     uint32_t connectorId = _drmConnector.GetId();
-    drmModeModeInfo modeInfo = _drmDumbBuffer.GetModeInfo();
+    drmModeModeInfo modeInfo = _pDrmDumbBuffers[0]->GetModeInfo();
     if (drmModeSetCrtc(_drmDevice.GetFileDescriptor(), _drmEncoder.GetCrtcId(),
-                       _drmFrameBuffer.GetId(), 0, 0, &connectorId, 1,
-                       &modeInfo) < 0)
+                       _pDrmFrameBuffers[BLACK_BUFFER]->GetId(), 0, 0,
+                       &connectorId, 1, &modeInfo) < 0)
     {
         throw std::runtime_error(Logger::LogError(LOG_ERR, errno,
                                                   DrmCantSetCrtc));
     }
     
+    for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
+    {
+        _frameBufferIds[i] = _pDrmFrameBuffers[i]->GetId();
+        _pFrameBufferMaps[i] = Map(*_pDrmDumbBuffers[i]);
+    }
+    
+    SetBuffers(_format, _pDrmDumbBuffers[0]->GetPitch(), _pFrameBufferMaps);
+}
+
+FrameBuffer::~FrameBuffer()
+{
+    uint64_t size = _pDrmDumbBuffers[0]->GetSize();
+    std::memset(_pFrameBufferMaps[GetDisplayed()], 0, size);
+    for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
+        munmap(_pFrameBufferMaps[i], size);
+}
+
+// Returns the given scan-out format, if the display pipeline can show it at 
+// the given resolution, or else 8-bit indexed gray if it can be shown, as it 
+// takes the least memory and time to write, and bandwidth to scan out, of the
+// formats that keep every gray level.  Otherwise, returns XRGB8888, which is
+// used without first checking that it's supported.
+const ScanoutFormat& FrameBuffer::SelectFormat(int width, int height,
+                                               const ScanoutFormat* pFormat)
+{
+    // Check for a connected display before trying formats on it.
+    if (!_drmConnector.IsConnected())
+    {
+        throw std::runtime_error(Logger::LogError(LOG_ERR,
+                                                  DrmConnectorNotConnected));
+    }
+    
+    if (pFormat)
+    {
+        if (!CanDisplay(*pFormat, width, height))
+        {
+            throw std::runtime_error(Logger::LogError(LOG_ERR, 
+                                                DrmScanoutFormatNotSupported));
+        }
+        return *pFormat;
+    }
+    
+    if (CanDisplay(SCANOUT_FORMATS[INDEXED_GRAY_FORMAT], width, height))
+        return SCANOUT_FORMATS[INDEXED_GRAY_FORMAT];
+    
+    return SCANOUT_FORMATS[XRGB8888_FORMAT];
+}
+
+// Returns true if the driver accepts a frame buffer in the given format and 
+// can set the mode with it (and for indexed color, a gray palette), found by 
+// displaying a cleared one.  Failures are expected here, so aren't logged.
+bool FrameBuffer::CanDisplay(const ScanoutFormat& format, int width, 
+                             int height)
+{
+    int fd = _drmDevice.GetFileDescriptor();
+    DRM_DumbBuffer probe(_drmDevice, _drmConnector, width, height,
+                         format.bitsPerPixel);
+    // Map the probe buffer just to clear it, so only black is displayed.
+    munmap(Map(probe), probe.GetSize());
+    
+    uint32_t id;
+    if (drmModeAddFB(fd, probe.GetWidth(), probe.GetHeight(), format.depth,
+                     format.bitsPerPixel, probe.GetPitch(), probe.GetHandle(),
+                     &id) < 0)
+    {
+        return false;
+    }
+    
+    uint32_t connectorId = _drmConnector.GetId();
+    drmModeModeInfo modeInfo = probe.GetModeInfo();
+    bool canDisplay = (format.bitsPerPixel != 8 || SetGrayPalette()) &&
+                      drmModeSetCrtc(fd, _drmEncoder.GetCrtcId(), id, 0, 0,
+                                     &connectorId, 1, &modeInfo) == 0;
+    
+    drmModeRmFB(fd, id);
+    return canDisplay;
+}
+
+// Loads a palette mapping each 8-bit index to the gray of that intensity, 
+// returning false if the CRTC has no 256-entry palette to load.
+bool FrameBuffer::SetGrayPalette()
+{
+    uint16_t gray[256];
+    for (int i = 0; i < 256; i++)
+        gray[i] = i * 257;
+    
+    return drmModeCrtcSetGamma(_drmDevice.GetFileDescriptor(), 
+                               _drmEncoder.GetCrtcId(), 256, gray, gray, 
+                               gray) == 0;
+}
+
+uint8_t* FrameBuffer::Map(const DRM_DumbBuffer& drmDumbBuffer)
+{
     // Prepare buffer for memory mapping.
     drm_mode_map_dumb mapRequest;
     std::memset(&mapRequest, 0, sizeof(mapRequest));
-    mapRequest.handle = _drmDumbBuffer.GetHandle();
+    mapRequest.handle = drmDumbBuffer.GetHandle();
     if (drmIoctl(_drmDevice.GetFileDescriptor(), DRM_IOCTL_MODE_MAP_DUMB,
                  &mapRequest) < 0)
     {
@@ -75,59 +180,83 @@ _image(width * height)
     }
 
     // Perform actual memory mapping.
-    _pFrameBufferMap = static_cast<uint8_t*>(mmap(0, _drmDumbBuffer.GetSize(),
-                                             PROT_READ | PROT_WRITE, MAP_SHARED,
-                                             _drmDevice.GetFileDescriptor(),
-                                             mapRequest.offset));
+    uint8_t* pMap = static_cast<uint8_t*>(mmap(0, drmDumbBuffer.GetSize(),
+                                          PROT_READ | PROT_WRITE, MAP_SHARED,
+                                          _drmDevice.GetFileDescriptor(),
+                                          mapRequest.offset));
 
-    if (_pFrameBufferMap == MAP_FAILED)
+    if (pMap == MAP_FAILED)
     {
         throw std::runtime_error(Logger::LogError(LOG_ERR, errno,
                                                   DrmCantMapDumbBuffer));
     }
 
     // Clear the frame buffer.
-    std::memset(_pFrameBufferMap, 0, _drmDumbBuffer.GetSize());
+    std::memset(pMap, 0, drmDumbBuffer.GetSize());
     
+    return pMap;
 }
 
-FrameBuffer::~FrameBuffer()
-{
-    std::memset(_pFrameBufferMap, 0, _drmDumbBuffer.GetSize());
-    munmap(_pFrameBufferMap, _drmDumbBuffer.GetSize());
-}
-
-// Copies the green channel from the specified image into an auxiliary buffer
-// but does not display the result.
-void FrameBuffer::Blit(Magick::Image& image)
-{
-    image.write(0, 0, _drmDumbBuffer.GetWidth(), _drmDumbBuffer.GetHeight(),
-                "G", Magick::CharPixel, _image.data());
-}
-
-// Sets all pixels of the frame buffer to the specified value and displays the
-// result immediately.
-void FrameBuffer::Fill(uint8_t value)
+// Scans out the given buffer, from the next vertical blank, returning once 
+// it's being scanned out, so that the projector's LEDs aren't turned on while
+// the previous image is still being shown.
+void FrameBuffer::Display(int buffer)
 {
-    std::memset(_pFrameBufferMap, value, _drmDumbBuffer.GetSize());
+    int fd = _drmDevice.GetFileDescriptor();
+    uint32_t crtcId = _drmEncoder.GetCrtcId();
+    
+    if (drmModePageFlip(fd, crtcId, _frameBufferIds[buffer], 
+                        DRM_MODE_PAGE_FLIP_EVENT, this) == 0)
+        AwaitPageFlip();
+    else
+    {
+        // fall back on setting the mode again, if the driver can't flip pages
+        uint32_t connectorId = _drmConnector.GetId();
+        drmModeModeInfo modeInfo = _pDrmDumbBuffers[0]->GetModeInfo();
+        if (drmModeSetCrtc(fd, crtcId, _frameBufferIds[buffer], 0, 0, 
+                           &connectorId, 1, &modeInfo) < 0)
+        {
+            throw std::runtime_error(Logger::LogError(LOG_ERR, errno,
+                                                      DrmCantSetCrtc));
+        }
+    }
 }
 
-// Displays the contents of the auxiliary buffer immediately.
-void FrameBuffer::Swap()
+// Waits for the event signaling that the page flip just requested has been 
+// completed.
+void FrameBuffer::AwaitPageFlip()
 {
-    int pitch = _drmDumbBuffer.GetPitch();
-    int width = _drmDumbBuffer.GetWidth();
-    int height = _drmDumbBuffer.GetHeight();
+    int fd = _drmDevice.GetFileDescriptor();
     
-    for (int y = 0; y < height; y++)
+    drmEventContext eventContext;
+    std::memset(&eventContext, 0, sizeof(eventContext));
+    eventContext.version = DRM_EVENT_CONTEXT_VERSION;
+    eventContext.page_flip_handler = PageFlipHandler;
+    
+    _flipPending = true;
+    while (_flipPending)
     {
-        for (int x = 0; x < width; x++)
+        pollfd pollFd = {fd, POLLIN, 0};
+        int ready = poll(&pollFd, 1, PAGE_FLIP_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        
+        if (ready == 0)
+            errno = ETIMEDOUT;
+        
+        if (ready <= 0 || drmHandleEvent(fd, &eventContext) != 0)
         {
-            uint8_t value = _image[width * y + x];
-            *(uint32_t*)&_pFrameBufferMap[pitch * y + x * 4] =
-                    (value << 16) | // red
-                    (value << 8)  | // green
-                     value;         // blue
+            throw std::runtime_error(Logger::LogError(LOG_ERR, errno,
+                                                      DrmPageFlipTimeout));
         }
     }
-}
\ No newline at end of file
+}
+
+// Notes the completion of a page flip requested by the FrameBuffer given as 
+// context.
+void FrameBuffer::PageFlipHandler(int /*fd*/, unsigned int /*sequence*/, 
+                                  unsigned int /*seconds*/, 
+                                  unsigned int /*micros*/, void* context)
+{
+    static_cast<FrameBuffer*>(context)->_flipPending = false;
+}
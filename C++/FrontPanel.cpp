@@ -22,21 +22,41 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
+#include <stdexcept>
+
 #include <FrontPanel.h>
 #include <Hardware.h>
 #include <Logger.h>
 #include "I_I2C_Device.h"
 
 FrontPanel::FrontPanel(const I_I2C_Device& i2cDevice) :
+_writerThread(0),
+_exiting(false),
+_commandsLength(0),
 _i2cDevice(i2cDevice),
-_showScreenThread(0),
 _settings(PrinterSettings::Instance())
 {
+    pthread_mutex_init(&_queueMutex, NULL);
+    pthread_cond_init(&_queueChanged, NULL);
+    pthread_mutex_init(&_commandsMutex, NULL);
+
     // don't clear the OLED display here, just leave the logo showing
 
     // clear LEDs
     AnimateLEDs(0);
     ClearLEDs();
+    Flush();
+
+    // screens are drawn by a separate thread, so that handling status 
+    // updates never waits on the front panel
+    int err = pthread_create(&_writerThread, NULL, &WriterThread, this);
+    if (err != 0)
+    {
+        _writerThread = 0;
+        throw std::runtime_error(ErrorMessage::Format(
+                                        CantStartFrontPanelThread, err));
+    }
 
     ScreenBuilder::BuildScreens(_screens);
     _lastUserName = _settings.GetString(USER_NAME_SETTING);
@@ -46,8 +66,8 @@ _settings(PrinterSettings::Instance())
 // Base class closes connection to the device
 FrontPanel::~FrontPanel() 
 {
-    // make sure a display thread isn't still running
-    AwaitThreadComplete();
+    // make sure the writer thread isn't still drawing a screen
+    AwaitWriterExit();
 
     // delete all the screens
     for (std::map<int, Screen*>::iterator it = _screens.begin(); 
@@ -55,6 +75,10 @@ FrontPanel::~FrontPanel()
     {
         delete it->second;
     }
+    
+    pthread_mutex_destroy(&_commandsMutex);
+    pthread_cond_destroy(&_queueChanged);
+    pthread_mutex_destroy(&_queueMutex);
 }    
 
 // Handles events forwarded by the event handler
@@ -119,39 +143,100 @@ void FrontPanel::ShowStatus(const PrinterStatus& ps)
         Screen* pScreen = _screens[key];
         if (pScreen != NULL)
         {
-            // make sure a display thread isn't already running
-            AwaitThreadComplete();
-            
-            // display the selected screen in a separate thread, to
+            // display the selected screen in the writer thread, to
             // avoid blocking here
-            FrontPanelScreen* pFPS = new FrontPanelScreen(this, ps, pScreen);
-            pthread_create(&_showScreenThread, NULL, &ThreadHelper, pFPS);  
+            QueueScreen(new FrontPanelScreen(ps, pScreen));
         }
     }
 }
 
-// Wait for any screen drawing to be completed
-void FrontPanel::AwaitThreadComplete()
+// Queues a screen for the writer thread to draw, dropping any queued screens
+// that it supersedes, i.e. an earlier status for the same screen, or all the
+// queued screens if it clears both the display and the LEDs.
+void FrontPanel::QueueScreen(FrontPanelScreen* pFPS)
 {
-    if (_showScreenThread != 0)
+    pthread_mutex_lock(&_queueMutex);
+    
+    if (pFPS->_pScreen->NeedsScreenClear() && pFPS->_pScreen->NeedsLEDClear())
+    {
+        // nothing drawn for the queued screens would remain visible
+        while (!_screenQueue.empty())
+        {
+            delete _screenQueue.front();
+            _screenQueue.pop_front();
+        }
+    }
+    else if (!_screenQueue.empty() && 
+             _screenQueue.back()->_pScreen == pFPS->_pScreen)
     {
-        void* result;
-        pthread_join(_showScreenThread, &result);
-    }    
+        delete _screenQueue.back();
+        _screenQueue.pop_back();
+    }
+    
+    _screenQueue.push_back(pFPS);
+    pthread_cond_signal(&_queueChanged);
+    pthread_mutex_unlock(&_queueMutex);
 }
 
+// Waits for a screen to be queued and removes it from the queue, or returns 
+// NULL if the writer thread should exit.
+FrontPanelScreen* FrontPanel::AwaitScreen()
+{
+    FrontPanelScreen* pFPS = NULL;
+    
+    pthread_mutex_lock(&_queueMutex);
+    while (!_exiting && _screenQueue.empty())
+        pthread_cond_wait(&_queueChanged, &_queueMutex);
+    
+    if (!_exiting)
+    {
+        pFPS = _screenQueue.front();
+        _screenQueue.pop_front();
+    }
+    pthread_mutex_unlock(&_queueMutex);
+    
+    return pFPS;
+}
 
-// Thread helper function that calls the actual screen drawing routine
-void* FrontPanel::ThreadHelper(void* context)
+// Stop the writer thread once it has drawn any screen it's already drawing, 
+// and discard any screens still queued.
+void FrontPanel::AwaitWriterExit()
 {
-    FrontPanelScreen* fps =  (FrontPanelScreen*)context; 
-    fps->_pFrontPanel->ShowScreen(fps->_pScreen, &(fps->_PS));
-    delete fps;
+    if (_writerThread != 0)
+    {
+        pthread_mutex_lock(&_queueMutex);
+        _exiting = true;
+        pthread_cond_signal(&_queueChanged);
+        pthread_mutex_unlock(&_queueMutex);
+        
+        pthread_join(_writerThread, NULL);
+        _writerThread = 0;
+    }
+    
+    while (!_screenQueue.empty())
+    {
+        delete _screenQueue.front();
+        _screenQueue.pop_front();
+    }
+}
+
+// Thread function that draws each queued screen in turn, until the writer 
+// thread is told to exit
+void* FrontPanel::WriterThread(void* context)
+{
+    FrontPanel* pFrontPanel = (FrontPanel*)context;
+    FrontPanelScreen* pFPS;
+    
+    while ((pFPS = pFrontPanel->AwaitScreen()) != NULL)
+    {
+        pFrontPanel->ShowScreen(pFPS->_pScreen, &(pFPS->_PS));
+        delete pFPS;
+    }
     pthread_exit(NULL);
 }
 
 // Display the selected screen 
-void* FrontPanel::ShowScreen(Screen* pScreen, PrinterStatus* pPS)
+void FrontPanel::ShowScreen(Screen* pScreen, PrinterStatus* pPS)
 {
     // no need to display null screens,
     if (pScreen != NULL)
@@ -165,30 +250,33 @@ void* FrontPanel::ShowScreen(Screen* pScreen, PrinterStatus* pPS)
             ClearScreen();
 
         pScreen->Draw(this, pPS);
+        
+        // send all the commands for the screen together
+        Flush();
     }  
-    return NULL;
 }
 
-// Illuminate the given number of LEDs 
+// Illuminate the given number of LEDs, setting all of them in one command
 void FrontPanel::ShowLEDs(int numLEDs)
 {   
     if (numLEDs < 0 || numLEDs > NUM_LEDS_IN_RING)
         return; // invalid number of LEDs to light
     
+    // the command structure is:
+    // [CMD_START][FRAME LENGTH][CMD_RING][CMD_RING_LED_VALUES][LED COUNT]
+    // [LED VALUE BYTES][CMD_END]
+    unsigned char cmdBuf[6 + NUM_LEDS_IN_RING] = {
+        CMD_START, 3 + NUM_LEDS_IN_RING, 
+        CMD_RING, CMD_RING_LED_VALUES, NUM_LEDS_IN_RING
+    };
     for(int i = 0; i < NUM_LEDS_IN_RING; i++)
     {
         // turn on the given number of LEDs (+1) to full intensity, 
         // and turn the rest off
-        unsigned char color = (i <= numLEDs) ? 0xFF : 0;
-        unsigned char cmdBuf[8] = {
-            CMD_START, 5, CMD_RING, CMD_RING_LED,
-            static_cast<unsigned char>(i), color, color, CMD_END
-        };
-        // only do a ready wait on first call
-        SendCommand(cmdBuf, 8, i == 0);
-        if (i < NUM_LEDS_IN_RING - 1)
-            usleep(10);  // wait 10us to avoid having LED #3 not turn on
+        cmdBuf[5 + i] = (i <= numLEDs) ? 0xFF : 0;
     }
+    cmdBuf[5 + NUM_LEDS_IN_RING] = CMD_END;
+    SendCommand(cmdBuf, 6 + NUM_LEDS_IN_RING);
 }
 
 // Turn off all the LEDs.
@@ -220,6 +308,7 @@ void FrontPanel::Reset()
     unsigned char cmdBuf[4] = {CMD_START, 2, CMD_RESET, CMD_END};
 
     SendCommand(cmdBuf, 4);
+    Flush();
 }
 
 // Show on line of text on the OLED display, using its location, alignment, 
@@ -258,6 +347,45 @@ void FrontPanel::ShowText(Alignment align, unsigned char x, unsigned char y,
     SendCommand(cmdBuf, 11 + textLen);
 }
 
+// Show a line of text on the OLED display as the line with the given ID, so 
+// that the front panel only redraws the characters that differ from the text 
+// it last showed for that line.
+void FrontPanel::UpdateText(int lineID, Alignment align, unsigned char x, 
+                            unsigned char y, unsigned char size, int color, 
+                            std::string text)
+{    
+    // determine the alignment to use
+    unsigned char alignment = CMD_OLED_SETTEXT;
+    if (align == Center)
+        alignment = CMD_OLED_CENTERTEXT;
+    else if (align == Right)
+        alignment = CMD_OLED_RIGHTTEXT;
+    
+    int textLen = text.length();
+    if (textLen > MAX_OLED_LINE_LEN)
+    {
+        Logger::HandleError(LongFrontPanelString, false, NULL, textLen);  
+        // truncate text so that the command fits in a single I2C write 
+        textLen = MAX_OLED_LINE_LEN;
+    }
+    
+    // the command structure is:
+    // [CMD_START][FRAME LENGTH][CMD_OLED][CMD_OLED_LINE][LINE ID][ALIGNMENT]
+    // [X BYTE][Y BYTE][SIZE BYTE] [HI COLOR BYTE][LO COLOR BYTE][TEXT LENGTH]
+    // [TEXT BYTES] ...[CMD_END]
+    unsigned char cmdBuf[MAX_FP_WRITE_LEN] = {
+        CMD_START, static_cast<unsigned char>(10 + textLen),
+        CMD_OLED, CMD_OLED_LINE, static_cast<unsigned char>(lineID), 
+        alignment, x, y, size,
+        static_cast<unsigned char>((color & 0xFF00) >> 8),
+        static_cast<unsigned char>(color & 0xFF),
+        static_cast<unsigned char>(textLen)
+    };
+    memcpy(cmdBuf + 12, text.c_str(), textLen);
+    cmdBuf[12 + textLen] = CMD_END;
+    SendCommand(cmdBuf, 13 + textLen);
+}
+
 constexpr int POLL_INTERVAL_MSEC = 10;
 constexpr int MAX_WAIT_TIME_SEC  = 10; 
 constexpr int MAX_READY_TRIES    = MAX_WAIT_TIME_SEC * 1000 / POLL_INTERVAL_MSEC; 
@@ -289,15 +417,68 @@ bool FrontPanel::IsReady()
     return ready;
 }
 
-// Send a command to the front panel, checking readiness first and retrying
-// on I2C write failure.
-void FrontPanel::SendCommand(unsigned char* buf, int len, bool awaitReady)
+// Add a command frame to those to be sent to the front panel, first sending
+// the ones already added if it couldn't buffer them all.
+void FrontPanel::SendCommand(const unsigned char* buf, int len)
 {
-    if (awaitReady)
-        IsReady();
+    pthread_mutex_lock(&_commandsMutex);
+    
+    if (_commandsLength + len > FP_CMD_BUFFER_SIZE)
+        WriteCommands();
 
+    _commands.push_back(std::vector<unsigned char>(buf, buf + len));
+    _commandsLength += len;
+    
+    pthread_mutex_unlock(&_commandsMutex);
+}
+
+// Send any command frames not yet sent to the front panel.
+void FrontPanel::Flush()
+{
+    pthread_mutex_lock(&_commandsMutex);
+    WriteCommands();
+    pthread_mutex_unlock(&_commandsMutex);
+}
+
+// Write the pending command frames to the front panel, checking readiness 
+// first.  The front panel handles each complete frame it receives, so as many 
+// frames as fit are packed into each I2C write.  Callers must hold 
+// _commandsMutex.
+void FrontPanel::WriteCommands()
+{
+    if (_commands.empty())
+        return;
+    
+    // the front panel is only ready once its command buffer is empty, so it 
+    // can then take all the pending frames without waiting again
+    IsReady();
+    
+    std::vector<unsigned char> bytes;
+    for (size_t i = 0; i < _commands.size(); i++)
+    {
+        if (!bytes.empty() && 
+            bytes.size() + _commands[i].size() > MAX_FP_WRITE_LEN)
+        {
+            WriteBytes(bytes);
+            bytes.clear();
+            // wait 10us between writes, to avoid having LED #3 not turn on
+            usleep(10);
+        }
+        bytes.insert(bytes.end(), _commands[i].begin(), _commands[i].end());
+    }
+    WriteBytes(bytes);
+    
+    _commands.clear();
+    _commandsLength = 0;
+}
+
+// Write the given bytes to the front panel's command register, retrying on 
+// I2C write failure.
+void FrontPanel::WriteBytes(const std::vector<unsigned char>& bytes)
+{
     int tries = 0;
-    while(tries++ < MAX_I2C_CMD_TRIES && !_i2cDevice.Write(FP_COMMAND, buf, len));
+    while(tries++ < MAX_I2C_CMD_TRIES && 
+          !_i2cDevice.Write(FP_COMMAND, bytes.data(), bytes.size()));
 }
 
 // Set the time after which the screen goes to sleep (to extend the lifetime
@@ -308,14 +489,12 @@ void FrontPanel::SetAwakeTime(int minutes)
     unsigned char cmdBuf[5] = {CMD_START, 2, CMD_SLEEP, (unsigned char)minutes,
                                 CMD_END};
     SendCommand(cmdBuf, 5);
+    Flush();
 }
 
 
 // Constructor
-FrontPanelScreen::FrontPanelScreen(FrontPanel* pFrontPanel, 
-                                   const PrinterStatus& ps, 
-                                   Screen* pScreen) :
-_pFrontPanel(pFrontPanel),
+FrontPanelScreen::FrontPanelScreen(const PrinterStatus& ps, Screen* pScreen) :
 _PS(ps),
 _pScreen(pScreen)          
 {
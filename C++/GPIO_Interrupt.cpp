@@ -21,6 +21,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
 #include <stdexcept>
@@ -132,17 +133,14 @@ int GPIO_Interrupt::GetFileDescriptor() const
     return _fd;
 }
 
-EventDataVec GPIO_Interrupt::Read()
+void GPIO_Interrupt::Read(EventDataVec& eventData)
 {
     char buffer;
-    EventDataVec eventData;
 
     lseek(_fd, 0, SEEK_SET);
     
     if (read(_fd, &buffer, 1) == 1)
         eventData.push_back(EventData(buffer));
-
-    return eventData;
 }
 
 bool GPIO_Interrupt::QualifyEvents(uint32_t events) const
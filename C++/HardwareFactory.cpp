@@ -29,16 +29,24 @@
 #include "Settings.h"
 #include "FrameBuffer.h"
 
+// Simulation is only possible with mock hardware.
+bool HardwareFactory::Simulate(VirtualClock& clock)
+{
+    return false;
+}
+
 I2C_DevicePtr HardwareFactory::CreateMotorControllerI2cDevice()
 {
-    return I2C_DevicePtr(new I2C_Device(MOTOR_SLAVE_ADDRESS, I2C2_PORT));
+    return I2C_DevicePtr(new I2C_Device(MOTOR_SLAVE_ADDRESS, I2C2_PORT,
+                                        HighI2cPriority));
 }
 
 I2C_DevicePtr HardwareFactory::CreateFrontPanelI2cDevice()
 {
     return I2C_DevicePtr(new I2C_Device(FP_SLAVE_ADDRESS,
             PrinterSettings::Instance().GetInt(HARDWARE_REV) == 0 ? 
-                                                        I2C2_PORT : I2C1_PORT));
+                                                        I2C2_PORT : I2C1_PORT,
+            LowI2cPriority));
 }
 
 //StreamBufferPtr HardwareFactory::CreateProjectorI2cDevice()
@@ -0,0 +1,215 @@
+//  File:   I2C_Bus.cpp
+//  Serializes and prioritizes the transfers made by the devices on an I2C bus
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include "I2C_Bus.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <stdexcept>
+
+#include "ErrorMessage.h"
+#include "utils.h"
+
+// Sets up a transfer to be submitted to a bus.
+I2C_Transfer::I2C_Transfer(int fd, I2C_Priority priority, I2C_Stats* pStats,
+                           const unsigned char* writeData, int writeLength,
+                           unsigned char* readData, int readLength) :
+_fd(fd),
+_priority(priority),
+_pStats(pStats),
+_writeData(writeData),
+_writeLength(writeLength),
+_readData(readData),
+_readLength(readLength),
+_pBus(NULL),
+_submitTime(0),
+_done(false),
+_succeeded(false),
+_writeFailed(false),
+_errno(0)
+{
+}
+
+// Waits for the submitted transfer to be performed, and returns whether or not
+// it succeeded.
+bool I2C_Transfer::Await()
+{
+    if (_pBus != NULL)
+        _pBus->Await(this);
+    
+    return _succeeded;
+}
+
+// the buses in use, by port
+static std::map<int, std::weak_ptr<I2C_Bus> > buses;
+static pthread_mutex_t busesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Returns the bus for the given port, starting it if no device is using it.
+std::shared_ptr<I2C_Bus> I2C_Bus::Get(int port)
+{
+    pthread_mutex_lock(&busesMutex);
+    std::shared_ptr<I2C_Bus> pBus = buses[port].lock();
+    if (!pBus)
+    {
+        try
+        {
+            pBus.reset(new I2C_Bus());
+        }
+        catch (...)
+        {
+            pthread_mutex_unlock(&busesMutex);
+            throw;
+        }
+        buses[port] = pBus;
+    }
+    pthread_mutex_unlock(&busesMutex);
+    
+    return pBus;
+}
+
+// Starts the thread that performs the transfers on the bus.
+I2C_Bus::I2C_Bus() :
+_submissions(0),
+_exiting(false)
+{
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_queueChanged, NULL);
+    pthread_cond_init(&_transferDone, NULL);
+
+    int err = pthread_create(&_thread, NULL, &BusThread, this);
+    if (err != 0)
+    {
+        pthread_cond_destroy(&_transferDone);
+        pthread_cond_destroy(&_queueChanged);
+        pthread_mutex_destroy(&_mutex);
+        throw std::runtime_error(ErrorMessage::Format(CantStartI2cBusThread, 
+                                                      err));
+    }
+}
+
+// Stops the bus thread, once it's performed any transfers still queued.
+I2C_Bus::~I2C_Bus()
+{
+    pthread_mutex_lock(&_mutex);
+    _exiting = true;
+    pthread_cond_signal(&_queueChanged);
+    pthread_mutex_unlock(&_mutex);
+
+    pthread_join(_thread, NULL);
+    
+    pthread_cond_destroy(&_transferDone);
+    pthread_cond_destroy(&_queueChanged);
+    pthread_mutex_destroy(&_mutex);
+}
+
+// Queues the given transfer, to be performed ahead of any already queued with 
+// a lower priority.  Returns without waiting for the transfer to be performed.
+void I2C_Bus::Submit(I2C_Transfer* pTransfer)
+{
+    pTransfer->_pBus = this;
+    pTransfer->_done = false;
+    pTransfer->_submitTime = GetMicros();
+
+    pthread_mutex_lock(&_mutex);
+    _queue[std::make_pair((int)pTransfer->_priority, _submissions++)] = 
+                                                                    pTransfer;
+    pthread_cond_signal(&_queueChanged);
+    pthread_mutex_unlock(&_mutex);
+}
+
+// Waits until the given submitted transfer has been performed.
+void I2C_Bus::Await(I2C_Transfer* pTransfer)
+{
+    pthread_mutex_lock(&_mutex);
+    while (!pTransfer->_done)
+        pthread_cond_wait(&_transferDone, &_mutex);
+    pthread_mutex_unlock(&_mutex);
+}
+
+// Performs the queued transfers in order, until the bus is destroyed.
+void* I2C_Bus::BusThread(void* context)
+{
+    I2C_Bus* pBus = (I2C_Bus*)context;
+
+    pthread_mutex_lock(&pBus->_mutex);
+    while (true)
+    {
+        if (pBus->_queue.empty())
+        {
+            if (pBus->_exiting)
+                break;
+            
+            pthread_cond_wait(&pBus->_queueChanged, &pBus->_mutex);
+            continue;
+        }
+        
+        I2C_Transfer* pTransfer = pBus->_queue.begin()->second;
+        pBus->_queue.erase(pBus->_queue.begin());
+        pthread_mutex_unlock(&pBus->_mutex);
+        
+        pBus->Perform(pTransfer);
+        
+        pthread_mutex_lock(&pBus->_mutex);
+        pTransfer->_done = true;
+        pthread_cond_broadcast(&pBus->_transferDone);
+    }
+    pthread_mutex_unlock(&pBus->_mutex);
+
+    return NULL;
+}
+
+// Writes and/or reads the device, recording how long that took and how long 
+// the transfer was queued.
+void I2C_Bus::Perform(I2C_Transfer* pTransfer)
+{
+    uint64_t start = GetMicros();
+    
+    pTransfer->_succeeded = true;
+    pTransfer->_writeFailed = false;
+    pTransfer->_errno = 0;
+    errno = 0;
+    if (pTransfer->_writeLength > 0 && 
+        write(pTransfer->_fd, pTransfer->_writeData, pTransfer->_writeLength)
+                                                != pTransfer->_writeLength)
+    {
+        pTransfer->_succeeded = false;
+        pTransfer->_writeFailed = true;
+        pTransfer->_errno = errno;
+    }
+    else if (pTransfer->_readLength > 0 &&
+             read(pTransfer->_fd, pTransfer->_readData, 
+                  pTransfer->_readLength) != pTransfer->_readLength)
+    {
+        pTransfer->_succeeded = false;
+        pTransfer->_errno = errno;
+    }
+
+    if (pTransfer->_pStats != NULL)
+    {
+        uint64_t end = GetMicros();
+        pTransfer->_pStats->queueing.Record(start - pTransfer->_submitTime);
+        pTransfer->_pStats->transfer.Record(end - start);
+        if (!pTransfer->_succeeded)
+            pTransfer->_pStats->errors++;
+    }
+}
@@ -24,7 +24,9 @@
 
 #include "I2C_Device.h"
 
+#include <unistd.h>
 #include <sstream>
+#include <cstdio>
 #include <fcntl.h>
 #include <stdexcept>
 #include <linux/i2c-dev.h>
@@ -33,9 +35,17 @@
 #include "ErrorMessage.h"
 #include "Logger.h"
 #include "Hardware.h"
-
-// Public constructor, opens I2C connection and sets slave address
-I2C_Device::I2C_Device(unsigned char slaveAddress, int port)
+#include "MessageStrings.h"
+
+// Public constructor, opens I2C connection and sets slave address.  Transfers
+// with devices on the same port are made by that port's bus, in order of the 
+// given priority.
+I2C_Device::I2C_Device(unsigned char slaveAddress, int port, 
+                       I2C_Priority priority) :
+_slaveAddress(slaveAddress),
+_port(port),
+_priority(priority),
+_pBus(I2C_Bus::Get(port))
 {
     // open the I2C port
     std::ostringstream i2cFileNameStream;
@@ -56,16 +66,42 @@ I2C_Device::I2C_Device(unsigned char slaveAddress, int port)
     }
 }
 
-// Closes connection to the device
+// Logs the statistics for the transfers made, and closes connection to the 
+// device
 I2C_Device::~I2C_Device()
 {
+    if (_stats.transfer.GetCount() > 0)
+    {
+        char summary[256];
+        snprintf(summary, sizeof(summary), LOG_I2C_TRANSFER_SUMMARY, 
+                 _slaveAddress, _port,
+                 (unsigned long long)_stats.transfer.GetCount(),
+                 (unsigned long long)_stats.errors,
+                 (unsigned long long)_stats.queueing.GetPercentile(99.0),
+                 (unsigned long long)_stats.transfer.GetPercentile(99.0),
+                 (unsigned long long)_stats.transfer.GetMax());
+        Logger::LogMessage(LOG_INFO, summary);
+    }
+    
     close(_fd);
 }
 
+// Submits the given transfer to the bus and waits for it to be performed, 
+// leaving errno set as the transfer left it.  Returns whether or not the 
+// transfer succeeded.
+bool I2C_Device::Perform(I2C_Transfer& transfer) const
+{
+    _pBus->Submit(&transfer);
+    bool succeeded = transfer.Await();
+    errno = transfer.GetErrno();
+    return succeeded;
+}
+
 // Write a single byte to the device
 bool I2C_Device::Write(unsigned char data) const
 {
-    if (write(_fd, &data, 1) != 1) 
+    I2C_Transfer transfer(_fd, _priority, &_stats, &data, 1);
+    if (!Perform(transfer)) 
     {
         Logger::LogError(LOG_WARNING, errno, I2cWrite);
         return false;
@@ -79,7 +115,8 @@ bool I2C_Device::Write(unsigned char registerAddress, unsigned char data) const
 {
     unsigned char buffer[2] = { registerAddress, data };
 
-    if (write(_fd, &buffer, 2) != 2) 
+    I2C_Transfer transfer(_fd, _priority, &_stats, buffer, 2);
+    if (!Perform(transfer)) 
     {
         Logger::LogError(LOG_WARNING, errno, I2cWrite);
         return false;
@@ -96,7 +133,8 @@ bool I2C_Device::Write(unsigned char registerAddress, const unsigned char* data,
     buffer[0] = registerAddress;
     memcpy(&buffer[1], data, length);
 
-    if (write(_fd, &buffer[0], length + 1) != length + 1) 
+    I2C_Transfer transfer(_fd, _priority, &_stats, buffer, length + 1);
+    if (!Perform(transfer)) 
     {
         Logger::LogError(LOG_WARNING, errno, I2cWrite);
         return false;
@@ -108,17 +146,16 @@ bool I2C_Device::Write(unsigned char registerAddress, const unsigned char* data,
 // Read a single byte from the given register
 unsigned char I2C_Device::Read(unsigned char registerAddress) const
 {
-    if (write(_fd, &registerAddress, 1) != 1) 
-    {
-        Logger::LogError(LOG_ERR, errno, I2cReadWrite);
-        return ERROR_STATUS;
-    }
-
     unsigned char buffer;
     
-    if (read(_fd, &buffer, 1) != 1)
+    // the register address is written and the data read in a single transfer,
+    // so that no other transfer on the bus can come between them
+    I2C_Transfer transfer(_fd, _priority, &_stats, &registerAddress, 1, 
+                          &buffer, 1);
+    if (!Perform(transfer)) 
     {
-        Logger::LogError(LOG_ERR, errno, I2cReadRead);
+        Logger::LogError(LOG_ERR, errno, transfer.WriteFailed() ? 
+                                         I2cReadWrite : I2cReadRead);
         return ERROR_STATUS;
     }
 
@@ -129,16 +166,14 @@ unsigned char I2C_Device::Read(unsigned char registerAddress) const
 bool I2C_Device::Read(unsigned char registerAddress, unsigned char* data, 
                      int length) const
 {
-    if (write(_fd, &registerAddress, 1) != 1) 
-    {
-        Logger::LogError(LOG_ERR, errno, I2cReadWrite);
-        return false;
-    }
-
     unsigned char buffer[length];
-    if (read(_fd, buffer, length) != length)
+    
+    I2C_Transfer transfer(_fd, _priority, &_stats, &registerAddress, 1, 
+                          buffer, length);
+    if (!Perform(transfer)) 
     {
-        Logger::LogError(LOG_ERR, errno, I2cReadRead);
+        Logger::LogError(LOG_ERR, errno, transfer.WriteFailed() ? 
+                                         I2cReadWrite : I2cReadRead);
         return false;
     }
     
@@ -150,23 +185,23 @@ constexpr int MAX_READ_WHEN_READY_ATTEMPTS = 40;
 constexpr unsigned int DELAY_5_Ms = 5000;
 
 // Read a single byte from the given register, from a device (such as the 
-// projector) that returns an initial byte indicating its readiness.
+// projector) that returns an initial byte indicating its readiness.  Each 
+// attempt is a separate transfer, and the wait between attempts is made 
+// without holding up the bus.
 unsigned char I2C_Device::ReadWhenReady(unsigned char registerAddress, 
                                         unsigned char readyStatus) const
 {
-    if (write(_fd, &registerAddress, 1) != 1) 
-    {
-        Logger::LogError(LOG_ERR, errno, I2cReadWrite);
-        return ERROR_STATUS;
-    }
-
     unsigned char buffer[2];
     
     for(int i = 0; i < MAX_READ_WHEN_READY_ATTEMPTS; i++)
     {
-        if (read(_fd, buffer, 2) != 2)
+        // only the first attempt writes the register address
+        I2C_Transfer transfer(_fd, _priority, &_stats, &registerAddress, 
+                              i == 0 ? 1 : 0, buffer, 2);
+        if (!Perform(transfer))
         {
-            Logger::LogError(LOG_ERR, errno, I2cReadReadWhenReady);
+            Logger::LogError(LOG_ERR, errno, transfer.WriteFailed() ? 
+                                        I2cReadWrite : I2cReadReadWhenReady);
             return ERROR_STATUS;
         }
         else if(buffer[0] == readyStatus)
@@ -184,21 +219,17 @@ bool I2C_Device::ReadWhenReady(unsigned char registerAddress,
                                unsigned char* data, int length,
                                unsigned char readyStatus) const
 {
-    if (write(_fd, &registerAddress, 1) != 1) 
-    {
-        Logger::LogError(LOG_ERR, errno, I2cReadWrite);
-        return false;
-    }
-
     int lengthPlusOne = length + 1;
     unsigned char buffer[lengthPlusOne];
         
     for(int i = 0; i < MAX_READ_WHEN_READY_ATTEMPTS; i++)
     {
-        
-        if (read(_fd, buffer, lengthPlusOne) != lengthPlusOne)
+        I2C_Transfer transfer(_fd, _priority, &_stats, &registerAddress, 
+                              i == 0 ? 1 : 0, buffer, lengthPlusOne);
+        if (!Perform(transfer))
         {
-            Logger::LogError(LOG_ERR, errno, I2cReadReadWhenReady);
+            Logger::LogError(LOG_ERR, errno, transfer.WriteFailed() ? 
+                                        I2cReadWrite : I2cReadReadWhenReady);
             return false;
         }
         else if(buffer[0] == readyStatus)
@@ -53,13 +53,15 @@ int I2C_Resource::GetFileDescriptor() const
 // I2C device
 // Return the data from the I2C device and discard the data from the underlying
 // resource
-EventDataVec I2C_Resource::Read()
+void I2C_Resource::Read(EventDataVec& eventData)
 {
-    _resource.Read();
+    // the wrapped resource only needs to be read to clear its event, 
+    // so discard any data it adds
+    size_t numEvents = eventData.size();
+    _resource.Read(eventData);
+    eventData.resize(numEvents, EventData(0));
 
-    EventDataVec eventData;
     eventData.push_back(EventData(_i2cDevice.Read(_readRegister)));
-    return eventData;
 }
 
 bool I2C_Resource::QualifyEvents(uint32_t events) const
@@ -112,4 +112,17 @@ Magick::Image* ImageProcessor::MapForPatternMode(Image& imageIn)
     }
     _pPatternModeView->sync();
     return &_patternModeImage;
-}
\ No newline at end of file
+}
+
+// Measure the cured cross-section of the given slice image.
+void ImageProcessor::Measure(Image& image, CrossSection& crossSection)
+{
+    int width  = (int) image.columns();
+    int height = (int) image.rows();
+    
+    // get the image as 8-bit grayscale, reusing the buffer for each layer
+    _pixels.resize((size_t)width * height);
+    image.write(0, 0, width, height, "I", CharPixel, _pixels.data());
+    
+    crossSection.Measure(_pixels.data(), width, height);
+}
@@ -0,0 +1,95 @@
+//  File:   LatencyHistogram.cpp
+//  Accumulates a histogram of latencies in power-of-two microsecond buckets
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <cstring>
+
+#include <LatencyHistogram.h>
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+// Add one latency measurement to the histogram.
+void LatencyHistogram::Record(uint64_t microseconds)
+{
+    int bucket = 0;
+    if (microseconds > 0)
+    {
+        // the bucket index is the number of significant bits
+        bucket = 64 - __builtin_clzll(microseconds);
+        if (bucket >= NUM_LATENCY_BUCKETS)
+            bucket = NUM_LATENCY_BUCKETS - 1;
+    }
+    _buckets[bucket]++;
+    _count++;
+    _total += microseconds;
+    if (microseconds > _max)
+        _max = microseconds;
+}
+
+// Discard all measurements.
+void LatencyHistogram::Reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _total = 0;
+    _max = 0;
+}
+
+// Get the mean of all measurements, in microseconds.
+uint64_t LatencyHistogram::GetMean() const
+{
+    return _count == 0 ? 0 : _total / _count;
+}
+
+// Get the upper limit of the bucket containing the given percentile (0-100) 
+// of measurements, in microseconds.  The result never exceeds the maximum 
+// measurement.
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (_count == 0)
+        return 0;
+    
+    uint64_t threshold = (uint64_t)(_count * percentile / 100.0 + 0.5);
+    if (threshold < 1)
+        threshold = 1;
+    
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_LATENCY_BUCKETS; i++)
+    {
+        seen += _buckets[i];
+        if (seen >= threshold)
+        {
+            uint64_t limit = GetBucketLimit(i);
+            return limit < _max ? limit : _max;
+        }
+    }
+    return _max;
+}
+
+// Get the exclusive upper limit of the given bucket, in microseconds.
+uint64_t LatencyHistogram::GetBucketLimit(int bucket)
+{
+    return 1ULL << bucket;
+}
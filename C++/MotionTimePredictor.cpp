@@ -0,0 +1,207 @@
+//  File:   MotionTimePredictor.cpp
+//  Predicts how long the motor controller takes to perform motor commands
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <algorithm>
+
+#include <MotionTimePredictor.h>
+#include <MotorController.h>
+
+// indices of the axes, as used by the motor controller
+constexpr int Z_AXIS = 0;
+constexpr int R_AXIS = 1;
+
+// the motor controller receives jerk settings in units/minute^3/1E6
+constexpr double JERK_SETTING_SCALE = 1e6;
+
+// the shortest time the motor controller gives to a segment of a move, below
+// which it won't plan an acceleration or deceleration (from its Planner.cpp)
+constexpr double MIN_SEGMENT_MINUTES = 2500.0 / 60e6;
+
+// lengths below this are too short for the motor controller to move
+constexpr double MIN_MOVE_LENGTH = 0.00001;
+
+// Constructs a predictor for commands sent after a motor controller reset,
+// i.e. with no moves yet and nothing set for either axis.
+MotionTimePredictor::MotionTimePredictor() :
+_seconds(0.0)
+{
+    for (int axis = Z_AXIS; axis <= R_AXIS; axis++)
+    {
+        _axes[axis].speed = 0.0;
+        _axes[axis].jerk = 0.0;
+        _axes[axis].linkedDistance = 0.0;
+    }
+}
+
+// Follows the given command, adding the time for it if it's a move.
+void MotionTimePredictor::Add(const MotorCommand& command)
+{
+    int axis;
+    switch (command.GetRegister())
+    {
+        case MC_Z_SETTINGS_REG:
+        case MC_Z_ACTION_REG:
+            axis = Z_AXIS;
+            break;
+
+        case MC_ROT_SETTINGS_REG:
+        case MC_ROT_ACTION_REG:
+            axis = R_AXIS;
+            break;
+
+        case MC_GENERAL_REG:
+            if (command.GetCommand() == MC_CLEAR ||
+                command.GetCommand() == MC_RESET)
+            {
+                // the motor controller discards any linked distances
+                _axes[Z_AXIS].linkedDistance = 0.0;
+                _axes[R_AXIS].linkedDistance = 0.0;
+            }
+            return;
+
+        default:
+            return;
+    }
+
+    double value = command.GetValue();
+
+    if (command.GetRegister() == MC_Z_SETTINGS_REG ||
+        command.GetRegister() == MC_ROT_SETTINGS_REG)
+    {
+        switch (command.GetCommand())
+        {
+            case MC_SPEED:
+                _axes[axis].speed = value;
+                break;
+
+            case MC_JERK:
+                _axes[axis].jerk = value * JERK_SETTING_SCALE;
+                break;
+
+            case MC_LINKED_MOVE:
+                _axes[axis].linkedDistance = value;
+                break;
+        }
+    }
+    else if (command.GetCommand() == MC_MOVE)
+        AddMove(axis, value);
+    else if (command.GetCommand() == MC_HOME)
+    {
+        // a homing move may stop at the limit switch well before this, and
+        // it's never linked to a move of the other axis
+        _seconds += GetMoveSeconds(std::abs(value), _axes[axis].speed,
+                                                    _axes[axis].jerk);
+    }
+}
+
+// Follows each of the given commands in turn.
+void MotionTimePredictor::Add(const std::vector<MotorCommand>& commands)
+{
+    for (size_t i = 0; i < commands.size(); i++)
+        Add(commands[i]);
+}
+
+// Adds the time for a move of the given axis, together with any distance
+// linked to it for the other axis.  When both axes move, they move along a
+// single line, at the highest speed and jerk allowed by the settings of both.
+void MotionTimePredictor::AddMove(int axis, double distance)
+{
+    double distances[2];
+    int other = axis == Z_AXIS ? R_AXIS : Z_AXIS;
+
+    distances[axis] = std::abs(distance);
+    distances[other] = std::abs(_axes[other].linkedDistance);
+    _axes[other].linkedDistance = 0.0;
+
+    double length = std::sqrt(distances[Z_AXIS] * distances[Z_AXIS] +
+                              distances[R_AXIS] * distances[R_AXIS]);
+    if (length < MIN_MOVE_LENGTH)
+        return;
+
+    // limit the speed and jerk along the line so that neither axis exceeds
+    // its own settings
+    double speed = 0.0;
+    double jerk = 0.0;
+    bool first = true;
+    for (int i = Z_AXIS; i <= R_AXIS; i++)
+    {
+        if (distances[i] == 0.0)
+            continue;
+
+        double scale = length / distances[i];
+        if (first || _axes[i].speed * scale < speed)
+            speed = _axes[i].speed * scale;
+        if (first || _axes[i].jerk * scale < jerk)
+            jerk = _axes[i].jerk * scale;
+        first = false;
+    }
+
+    _seconds += GetMoveSeconds(length, speed, jerk);
+}
+
+// Returns the time in seconds the motor controller takes to move the given
+// length from rest to rest, with the given speed (in units/minute) and
+// jerk (in units/minute^3).  This follows the motor controller's trapezoid
+// calculation for a move that starts and ends at rest: it accelerates and
+// decelerates with the jerk limited S-curve that reaches the speed, unless
+// the move is too short to reach it, or the acceleration would take less
+// than the minimum segment time, in which case the move is made at constant
+// speed.
+double MotionTimePredictor::GetMoveSeconds(double length, double speed,
+                                           double jerk)
+{
+    if (length < MIN_MOVE_LENGTH || speed <= 0.0 || jerk <= 0.0)
+        return 0.0;
+
+    double minutes;
+
+    // length needed to reach the speed from rest, and to stop from it
+    double headLength = speed * std::sqrt(speed / jerk);
+    if (headLength < MIN_SEGMENT_MINUTES * speed)
+        headLength = 0.0;
+
+    if (length < 2.0 * headLength)
+    {
+        // too short to reach the speed, so accelerate for half the length
+        // and decelerate for the other half, from the highest speed reached
+        double peakSpeed = std::min(speed, std::pow(length / 2.0, 2.0 / 3.0) *
+                                           std::cbrt(jerk));
+        // each half averages half the peak speed
+        minutes = 2.0 * length / peakSpeed;
+    }
+    else
+    {
+        // accelerating and decelerating each average half the speed, with
+        // any remaining length at the full speed in between
+        double bodyLength = length - 2.0 * headLength;
+        if (headLength > 0.0 && bodyLength < MIN_SEGMENT_MINUTES * speed)
+            // a body too short for a segment is split between the
+            // acceleration and deceleration instead
+            minutes = 2.0 * length / speed;
+        else
+            minutes = (4.0 * headLength + bodyLength) / speed;
+    }
+
+    return minutes * 60.0;
+}
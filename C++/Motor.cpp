@@ -24,8 +24,11 @@
 #include <Motor.h>
 
 #include <unistd.h>
+#include <algorithm>
 
 #include <MotorController.h>
+#include <Hardware.h>
+#include <MotionTimePredictor.h>
 #include "I_I2C_Device.h"
 
 constexpr int DELAY_AFTER_RESET_MSEC  = 500;
@@ -33,7 +36,9 @@ constexpr int DELAY_AFTER_RESET_MSEC  = 500;
 // Public constructor, base class opens I2C connection and sets slave address
 Motor::Motor(const I_I2C_Device& i2cDevice) :
 _i2cDevice(i2cDevice),
-_settings(PrinterSettings::Instance())
+_settings(PrinterSettings::Instance()),
+_preparedRevision(0),
+_preparedSendCount(0)
 {
 }
 
@@ -43,13 +48,18 @@ Motor::~Motor()
     DisableMotors();
 }    
 
-// Send a set of commands to the motor controller.  Returns false immediately 
-// if any of the commands cannot be sent.
-bool Motor::SendCommands(std::vector<MotorCommand> commands)
+// Send a set of commands to the motor controller, in as few I2C writes as 
+// possible.  Returns false immediately if any of the commands cannot be sent.
+bool Motor::SendCommands(const std::vector<MotorCommand>& commands)
 {
-    for(int i = 0; i < commands.size(); i++)
-        if (!commands[i].Send(_i2cDevice))
+    for (size_t first = 0; first < commands.size(); 
+                           first += MC_MAX_BATCH_COMMANDS)
+    {
+        int count = std::min(commands.size() - first, 
+                             static_cast<size_t>(MC_MAX_BATCH_COMMANDS));
+        if (!MotorCommand::SendBatch(_i2cDevice, &commands[first], count))
             return false;
+    }
     return true;
 }
 
@@ -223,32 +233,7 @@ bool Motor::GoToStartPosition()
 // Separate the current layer 
 bool Motor::Separate(const CurrentLayerSettings& cls)
 {
-    std::vector<MotorCommand> commands;
-
-    // rotate the previous layer from the PDMS
-    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_JERK, 
-                                    cls.SeparationRotJerk));
-    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_SPEED, 
-                                    cls.SeparationRPM * R_SPEED_FACTOR));
-    
-    int rotation = cls.RotationMilliDegrees / R_SCALE_FACTOR;
-    if (rotation != 0)
-        commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_MOVE, -rotation));
-    
-    // lift the build platform
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, 
-                                    cls.SeparationZJerk));
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
-                                 cls.SeparationMicronsPerSec * Z_SPEED_FACTOR));
-    
-    if (cls.ZLiftMicrons != 0)
-        commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
-                                                            cls.ZLiftMicrons));
-    
-    // request an interrupt when these commands are completed
-    commands.push_back(MotorCommand(MC_GENERAL_REG, MC_INTERRUPT));
-    
-    return SendCommands(commands);
+    return SendLayerMotion(SeparateMotion, cls);
 }
 
 // Go to the position for exposing the next layer (with optional jam recovery
@@ -259,41 +244,7 @@ bool Motor::Approach(const CurrentLayerSettings& cls, bool unJamFirst)
         if (!UnJam(cls, false))
             return false;
 
-    std::vector<MotorCommand> commands;
-    
-    // rotate back to the PDMS
-    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_JERK, 
-                                    cls.ApproachRotJerk));
-    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_SPEED, 
-                                    cls.ApproachRPM * R_SPEED_FACTOR));
-    
-    int rotation = cls.RotationMilliDegrees / R_SCALE_FACTOR;
-    if (rotation != 0)
-    {
-        // see if we should use homing on approach, to avoid not rotating far 
-        // enough back when there's been drag (a partial jam) on separation
-        if (_settings.GetInt(HOME_ON_APPROACH) != 0)
-            commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_HOME, 
-                                                                 2 * rotation));
-        else
-            commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_MOVE, 
-                                                                     rotation));
-    }
-    
-    // lower into position to expose the next layer
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, 
-                                    cls.ApproachZJerk));
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
-                                   cls.ApproachMicronsPerSec * Z_SPEED_FACTOR));
-    
-    int deltaZ = cls.LayerThicknessMicrons - cls.ZLiftMicrons;
-    if (deltaZ != 0)
-        commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, deltaZ));
-    
-    // request an interrupt when these commands are completed
-    commands.push_back(MotorCommand(MC_GENERAL_REG, MC_INTERRUPT));
-    
-    return SendCommands(commands);
+    return SendLayerMotion(ApproachMotion, cls);
 }
 
 // Rotate the tray and (if CanInspect is true) lift the build head to inspect 
@@ -402,40 +353,272 @@ bool Motor::UnJam(const CurrentLayerSettings& cls, bool withInterrupt)
 // position.
 bool Motor::Press(const CurrentLayerSettings& cls)
 {
-    // reuse existing jerk settings from approach
+    return SendLayerMotion(PressMotion, cls);
+}
 
+// Move the tray back up into position for exposing the next layer, allowing
+// resin to fill in for the height of a full layer. 
+bool Motor::Unpress(const CurrentLayerSettings& cls)
+{
+    return SendLayerMotion(UnpressMotion, cls);
+}
+
+// Send the separation for a layer ahead of time, e.g. while it's still being
+// exposed.  The motor controller holds the motion until ReleaseHeldMotion() 
+// sends the interrupt request that would otherwise end the sequence, so that 
+// the separation starts with a single byte write.  Returns false without 
+// sending anything if the motor controller doesn't have room for the whole 
+// sequence, in which case the separation should be sent as usual instead.
+bool Motor::HoldSeparation(const CurrentLayerSettings& cls)
+{
     std::vector<MotorCommand> commands;
+    GetLayerMotionCommands(SeparateMotion, cls, commands);
     
-    // press down on the tray
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
-                                    cls.PressMicronsPerSec * Z_SPEED_FACTOR));
-    if (cls.PressMicrons != 0)
-        commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
-                                                        -cls.PressMicrons));
+    // leave off the interrupt request, so that the motion is held
+    commands.pop_back();
     
-    // request an interrupt when these commands are completed
-    commands.push_back(MotorCommand(MC_GENERAL_REG, MC_INTERRUPT));
+    if (GetCommandSpace() < static_cast<int>(commands.size()))
+        return false;
     
     return SendCommands(commands);
 }
 
-// Move the tray back up into position for exposing the next layer, allowing
-// resin to fill in for the height of a full layer. 
-bool Motor::Unpress(const CurrentLayerSettings& cls)
+// Start the motion held by the motor controller since HoldSeparation(), 
+// requesting an interrupt when it's completed.  A held motion that's no longer
+// wanted can be discarded with ClearPendingCommands() instead.
+bool Motor::ReleaseHeldMotion()
+{
+    return MotorCommand(MC_GENERAL_REG, MC_INTERRUPT).Send(_i2cDevice);
+}
+
+// Get the number of commands the motor controller can currently accept, or 
+// 0 if that can't be read.
+int Motor::GetCommandSpace()
+{
+    unsigned char space = _i2cDevice.Read(MC_QUEUE_REG);
+    return space == ERROR_STATUS ? 0 : space;
+}
+
+// Pre-encode the separation, approach, press, and unpress motions for a layer
+// with the given settings, so that sending each of them later takes only a 
+// single buffer write.  Layers with the same motion settings share the same 
+// encoded motions.  Any motion that can't be encoded (e.g. due to an invalid 
+// setting) is left to be built when it's sent, so that the error is reported
+// at that point.
+void Motor::PrepareLayer(const CurrentLayerSettings& cls)
+{
+    // the approach depends on a printer setting as well
+    if (_settings.GetRevision() != _preparedRevision)
+    {
+        _preparedMotions.clear();
+        _preparedRevision = _settings.GetRevision();
+    }
+    
+    LayerMotionKey key = GetLayerMotionKey(cls);
+    if (_preparedMotions.count(key) > 0 || 
+        _preparedMotions.size() >= MAX_PREPARED_LAYER_MOTIONS)
+        return;
+    
+    EncodedLayerMotions& encoded = _preparedMotions[key];
+    
+    std::vector<MotorCommand> commands;
+    unsigned char buf[MAX_BATCH_FRAME_SIZE];
+    for (int motion = 0; motion < NumLayerMotions; motion++)
+    {
+        commands.clear();
+        GetLayerMotionCommands(static_cast<LayerMotion>(motion), cls, 
+                                                                    commands);
+        
+        // a single command isn't sent as a batch 
+        if (commands.size() < 2)
+            continue;
+        
+        int length = MotorCommand::EncodeBatch(&commands[0], commands.size(), 
+                                               buf, false);
+        encoded[motion].assign(buf, buf + length);
+    }
+}
+
+// Discard all pre-encoded layer motions.
+void Motor::ClearPreparedLayers()
 {
-    // reuse existing jerk settings from approach
+    _preparedMotions.clear();
+}
 
+// Predict the time (in seconds) the motor controller takes to perform the 
+// given motion for a layer with the given settings.  Pressing and unpressing 
+// reuse the jerk settings sent for approach, so those are followed first.
+double Motor::GetLayerMotionSec(LayerMotion motion, 
+                                const CurrentLayerSettings& cls)
+{
+    MotionTimePredictor predictor;
     std::vector<MotorCommand> commands;
     
-    // lift up on the tray
-    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
+    if (motion == PressMotion || motion == UnpressMotion)
+    {
+        GetLayerMotionCommands(ApproachMotion, cls, commands);
+        predictor.Add(commands);
+        commands.clear();
+    }
+    double startSec = predictor.GetSeconds();
+    
+    GetLayerMotionCommands(motion, cls, commands);
+    predictor.Add(commands);
+    
+    return predictor.GetSeconds() - startSec;
+}
+
+// Send the given motion for a layer with the given settings, using its 
+// pre-encoded form if there is one. 
+bool Motor::SendLayerMotion(LayerMotion motion, 
+                            const CurrentLayerSettings& cls)
+{
+    if (_settings.GetRevision() == _preparedRevision && 
+        !_preparedMotions.empty())
+    {
+        std::map<LayerMotionKey, EncodedLayerMotions>::const_iterator it = 
+                                _preparedMotions.find(GetLayerMotionKey(cls));
+        if (it != _preparedMotions.end() && !it->second[motion].empty())
+        {
+            _preparedSendCount++;
+            return MotorCommand::SendEncodedBatch(_i2cDevice, 
+                                                  &it->second[motion][0],
+                                                  it->second[motion].size());
+        }
+    }
+    
+    std::vector<MotorCommand> commands;
+    GetLayerMotionCommands(motion, cls, commands);
+    return SendCommands(commands);
+}
+
+// Get the values of the settings used by GetLayerMotionCommands().
+LayerMotionKey Motor::GetLayerMotionKey(const CurrentLayerSettings& cls)
+{
+    LayerMotionKey key = {{
+        cls.PressMicrons,
+        cls.PressMicronsPerSec,
+        cls.UnpressMicronsPerSec,
+        cls.SeparationRotJerk,
+        cls.SeparationRPM,
+        cls.RotationMilliDegrees,
+        cls.SeparationZJerk,
+        cls.SeparationMicronsPerSec,
+        cls.ZLiftMicrons,
+        cls.ApproachRotJerk,
+        cls.ApproachRPM,
+        cls.ApproachZJerk,
+        cls.ApproachMicronsPerSec,
+        cls.LayerThicknessMicrons
+    }};
+    return key;
+}
+
+// Build the commands for the given motion, for a layer with the given 
+// settings.
+void Motor::GetLayerMotionCommands(LayerMotion motion, 
+                                   const CurrentLayerSettings& cls, 
+                                   std::vector<MotorCommand>& commands)
+{
+    int rotation = cls.RotationMilliDegrees / R_SCALE_FACTOR;
+    // see if the rotation should be linked to the Z move that follows it, so 
+    // that the motor controller moves both axes at once, rather than bringing
+    // the tray to a stop before moving the build platform
+    bool coordinated = _settings.GetInt(COORDINATED_MOTION) != 0;
+    
+    switch (motion)
+    {
+        case SeparateMotion:
+            // rotate the previous layer from the PDMS
+            commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_JERK, 
+                                            cls.SeparationRotJerk));
+            commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_SPEED, 
+                                        cls.SeparationRPM * R_SPEED_FACTOR));
+
+            if (rotation != 0)
+            {
+                if (coordinated && cls.ZLiftMicrons != 0)
+                    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, 
+                                                    MC_LINKED_MOVE, -rotation));
+                else
+                    commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_MOVE, 
+                                                                  -rotation));
+            }
+
+            // lift the build platform
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, 
+                                            cls.SeparationZJerk));
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
+                                 cls.SeparationMicronsPerSec * Z_SPEED_FACTOR));
+
+            if (cls.ZLiftMicrons != 0)
+                commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
+                                                            cls.ZLiftMicrons));
+            break;
+            
+        case ApproachMotion:
+        {
+            int deltaZ = cls.LayerThicknessMicrons - cls.ZLiftMicrons;
+            
+            // rotate back to the PDMS
+            commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_JERK, 
+                                            cls.ApproachRotJerk));
+            commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_SPEED, 
+                                            cls.ApproachRPM * R_SPEED_FACTOR));
+
+            if (rotation != 0)
+            {
+                // see if we should use homing on approach, to avoid not 
+                // rotating far enough back when there's been drag (a partial 
+                // jam) on separation, though a homing move can't be linked 
+                // to the Z move
+                if (_settings.GetInt(HOME_ON_APPROACH) != 0)
+                    commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_HOME, 
+                                                                 2 * rotation));
+                else if (coordinated && deltaZ != 0)
+                    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, 
+                                                    MC_LINKED_MOVE, rotation));
+                else
+                    commands.push_back(MotorCommand(MC_ROT_ACTION_REG, MC_MOVE, 
+                                                                     rotation));
+            }
+
+            // lower into position to expose the next layer
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, 
+                                            cls.ApproachZJerk));
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
+                                   cls.ApproachMicronsPerSec * Z_SPEED_FACTOR));
+
+            if (deltaZ != 0)
+                commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
+                                                                    deltaZ));
+            break;
+        }
+            
+        case PressMotion:
+            // press down on the tray, reusing existing jerk settings from 
+            // approach
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
+                                    cls.PressMicronsPerSec * Z_SPEED_FACTOR));
+            if (cls.PressMicrons != 0)
+                commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
+                                                        -cls.PressMicrons));
+            break;
+            
+        case UnpressMotion:
+            // lift up on the tray, reusing existing jerk settings from 
+            // approach
+            commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, 
                                     cls.UnpressMicronsPerSec * Z_SPEED_FACTOR));
-    if (cls.PressMicrons != 0)
-        commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
+            if (cls.PressMicrons != 0)
+                commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 
                                                             cls.PressMicrons));
+            break;
+            
+        default:
+            return;
+    }
     
     // request an interrupt when these commands are completed
     commands.push_back(MotorCommand(MC_GENERAL_REG, MC_INTERRUPT));
-    
-    return SendCommands(commands);
 }
@@ -39,28 +39,51 @@ _value(value)
  {   
  }
  
-// Sends a command to the motor controller, checking for valid commands and
-// retrying in case there's an I2C write failure.
-bool MotorCommand::Send(const I_I2C_Device& i2cDevice) 
+// Checks that the command's value is allowed, optionally reporting an error 
+// if not.
+bool MotorCommand::IsValid(bool reportErrors) const
 {
+    ErrorCode error = Success;
+    
     // don't allow zero values for settings and actions
     if (_cmdRegister != MC_GENERAL_REG && _value == 0)
+        error = ZeroInMotorCommand;
+    // don't allow negative values for settings, other than the distance of a 
+    // linked move
+    else if ((_cmdRegister == MC_ROT_SETTINGS_REG ||
+             _cmdRegister == MC_Z_SETTINGS_REG) && _cmd != MC_LINKED_MOVE &&
+             _value < 0)
+        error = NegativeInMotorCommand;
+    
+    if (error != Success && reportErrors)
     {
         char msg[100];
         sprintf(msg, LOG_INVALID_MOTOR_COMMAND, _cmdRegister, _cmd);
-        Logger::HandleError(ZeroInMotorCommand, true, msg);
-        return false;
+        Logger::HandleError(error, true, msg);
     }
     
-    // don't allow negative values for settings 
-    if ((_cmdRegister == MC_ROT_SETTINGS_REG ||
-        _cmdRegister == MC_Z_SETTINGS_REG) && _value < 0)
-    {
-        char msg[100];
-        sprintf(msg, LOG_INVALID_MOTOR_COMMAND, _cmdRegister, _cmd);
-        Logger::HandleError(NegativeInMotorCommand, true, msg);
+    return error == Success;
+}
+
+// Writes the command into the given buffer, as its register, command, and 
+// value (least significant byte first).  General commands are written the same
+// way, with a zero value.
+void MotorCommand::Encode(unsigned char* buffer) const
+{
+    buffer[0] = _cmdRegister;
+    buffer[1] = _cmd;
+    buffer[2] = static_cast<unsigned char>( _value        & 0xFF);
+    buffer[3] = static_cast<unsigned char>((_value >> 8)  & 0xFF);
+    buffer[4] = static_cast<unsigned char>((_value >> 16) & 0xFF);
+    buffer[5] = static_cast<unsigned char>((_value >> 24) & 0xFF);
+}
+
+// Sends a command to the motor controller, checking for valid commands and
+// retrying in case there's an I2C write failure.
+bool MotorCommand::Send(const I_I2C_Device& i2cDevice) const
+{
+    if (!IsValid())
         return false;
-    }
     
     if (_cmdRegister == MC_GENERAL_REG)
     {
@@ -92,21 +115,75 @@ bool MotorCommand::Send(const I_I2C_Device& i2cDevice)
 //                           (int)((_value >> 24)  & 0xFF) << ")"  <<  
 //      std::endl; 
 
-        unsigned char buf[5] = {
-            _cmd,
-            static_cast<unsigned char>( _value        & 0xFF),
-            static_cast<unsigned char>((_value >> 8)  & 0xFF),
-            static_cast<unsigned char>((_value >> 16) & 0xFF), 
-            static_cast<unsigned char>((_value >> 24) & 0xFF)
-        };
+        // the register is written separately, ahead of the remaining bytes
+        unsigned char buf[MOTOR_COMMAND_SIZE];
+        Encode(buf);
         
         int tries = 0;
         while(tries++ < MAX_I2C_CMD_TRIES)
         {
-            if (i2cDevice.Write(_cmdRegister, buf, 5))
+            if (i2cDevice.Write(_cmdRegister, &buf[1], MOTOR_COMMAND_SIZE - 1))
                 return true;   
         }
     }
     
     return false;
-}
\ No newline at end of file
+}
+
+// Sends a sequence of up to MC_MAX_BATCH_COMMANDS commands to the motor 
+// controller in a single I2C write, checking for valid commands and retrying 
+// in case there's an I2C write failure.
+bool MotorCommand::SendBatch(const I_I2C_Device& i2cDevice, 
+                             const MotorCommand* commands, int count)
+{
+    if (count == 1)
+        return commands[0].Send(i2cDevice);
+    
+    unsigned char buf[MAX_BATCH_FRAME_SIZE];
+    int length = EncodeBatch(commands, count, buf);
+    
+    return length > 0 && SendEncodedBatch(i2cDevice, buf, length);
+}
+
+// Writes a sequence of up to MC_MAX_BATCH_COMMANDS commands into the given 
+// buffer (of at least MAX_BATCH_FRAME_SIZE bytes) as a batch: the command 
+// count, the commands, and their checksum.  Returns the number of bytes 
+// written, or 0 if any of the commands are invalid.
+int MotorCommand::EncodeBatch(const MotorCommand* commands, int count, 
+                              unsigned char* buffer, bool reportErrors)
+{
+    if (count < 1 || count > MC_MAX_BATCH_COMMANDS)
+        return 0;
+    
+    buffer[0] = static_cast<unsigned char>(count);
+    unsigned char checksum = MC_UpdateBatchChecksum(0, buffer[0]);
+    int length = 1;
+    for (int i = 0; i < count; i++)
+    {
+        if (!commands[i].IsValid(reportErrors))
+            return 0;
+        
+        commands[i].Encode(&buffer[length]);
+        for (int j = 0; j < MOTOR_COMMAND_SIZE; j++)
+            checksum = MC_UpdateBatchChecksum(checksum, buffer[length++]);
+    }
+    buffer[length++] = checksum;
+    
+    return length;
+}
+
+// Sends a batch already encoded by EncodeBatch(), retrying in case there's an
+// I2C write failure.  The motor controller discards a batch it doesn't receive
+// completely, so the retry can't repeat any of the commands.
+bool MotorCommand::SendEncodedBatch(const I_I2C_Device& i2cDevice, 
+                                    const unsigned char* buffer, int length)
+{
+    int tries = 0;
+    while(tries++ < MAX_I2C_CMD_TRIES)
+    {
+        if (i2cDevice.Write(MC_BATCH_REG, buffer, length))
+            return true;   
+    }
+    
+    return false;
+}
@@ -25,25 +25,58 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <stdio.h>
-#include <fstream>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <algorithm>
 
 #include <NetworkInterface.h>
 #include <Logger.h>
 #include <utils.h>
 #include <Shared.h>
 #include <Settings.h>
+#include <MessageStrings.h>
 
-// Constructor
-NetworkInterface::NetworkInterface() :
+// how long to wait before first retrying pipes that were backed up, the 
+// longest the wait may grow to as retries fail, and how long pipes may stay 
+// backed up before the status held for them is dropped and retries stop
+constexpr long PIPE_RETRY_MS = 250;
+constexpr long PIPE_MAX_RETRY_MS = 8000;
+constexpr long PIPE_GIVE_UP_MS = 60000;
+
+// Constructor.  Without a publish timer, every status update is published
+// as soon as it's received.
+NetworkInterface::NetworkInterface(const Timer* pPublishTimer) :
 _statusJSON("\n"),
-_statusPushFd(-1)
+_pPublishTimer(pPublishTimer),
+_lastPublishMillis(-1),
+_publishPending(false),
+_coalescedCount(0),
+_droppedCount(0),
+_retryMillis(PIPE_RETRY_MS),
+_backedUpSinceMillis(-1)
 {    
+    AddStatusPipe(STATUS_TO_WEB_PIPE);
 }
 
 // Destructor
 NetworkInterface::~NetworkInterface()
 {
+    if (_coalescedCount > 0 || _droppedCount > 0)
+    {
+        char msg[100];
+        sprintf(msg, LOG_STATUS_COALESCING, _coalescedCount, _droppedCount);
+        Logger::LogMessage(LOG_INFO, msg);
+    }
+    
+    for (size_t i = 0; i < _statusPipes.size(); i++)
+        delete _statusPipes[i];
+}
 
+// Add another named pipe to which status updates will be pushed.
+void NetworkInterface::AddStatusPipe(const std::string& path)
+{
+    _statusPipes.push_back(new StatusPipe(path));
 }
 
 // Handle printer status updates and requests to report that status
@@ -52,28 +85,51 @@ void NetworkInterface::Callback(EventType eventType, const EventData& data)
     switch(eventType)
     {               
         case PrinterStatusUpdate:
+        {
+            const PrinterStatus& status = data.Get<PrinterStatus>();
             // we don't care about states that are being left
-            if (data.Get<PrinterStatus>()._change != Leaving)
+            if (status._change == Leaving)
+                break;
+            
+            // any status not yet published is superseded by this one
+            if (_publishPending)
+                _coalescedCount++;
+            _statusJSON = status.ToString();
+            
+            long window = 0;
+            if (_pPublishTimer != NULL)
+                window = PrinterSettings::Instance().GetInt(STATUS_COALESCE_MS);
+            long sinceLastPublish = GetMillisSincePublish();
+            
+            // errors are always published right away
+            if (window <= 0 || status._isError || sinceLastPublish >= window)
+                Publish();
+            else
             {
-                SaveCurrentStatus(data.Get<PrinterStatus>());
-                // we only want to push status if there's a listener on
-                // the pipe used for reporting status to the web 
-                if (_statusPushFd < 0)
-                {
-                    // see if that pipe has been created
-                    if (access(STATUS_TO_WEB_PIPE, F_OK) != -1) 
-                    {
-                        open(STATUS_TO_WEB_PIPE, O_RDONLY|O_NONBLOCK);
-                        _statusPushFd = open(STATUS_TO_WEB_PIPE, 
-                                             O_WRONLY|O_NONBLOCK);
-                        if (_statusPushFd < 0)
-                            Logger::HandleError(StatusToWebPipeOpen);
-                    }
-                }
-                if (_statusPushFd >= 0)
-                    SendStringToPipe(_statusJSON.c_str(), _statusPushFd);
+                _publishPending = true;
+                ScheduleRetry(window - sinceLastPublish);
             }
             break;
+        }
+            
+        case StatusPublishTimer:
+        {
+            long window = PrinterSettings::Instance().GetInt(STATUS_COALESCE_MS);
+            long sinceLastPublish = GetMillisSincePublish();
+            if (_publishPending && sinceLastPublish < window)
+            {
+                // the timer was set earlier to retry a backed up pipe
+                ScheduleRetry(window - sinceLastPublish);
+            }
+            else if (_publishPending)
+                Publish();
+            
+            bool backedUp = false;
+            for (size_t i = 0; i < _statusPipes.size(); i++)
+                backedUp |= !_statusPipes[i]->Flush();
+            RetryBackedUpPipes(backedUp);
+            break;
+        }
             
         default:
             Logger::LogError(LOG_WARNING, errno, UnexpectedEvent, eventType);
@@ -81,25 +137,236 @@ void NetworkInterface::Callback(EventType eventType, const EventData& data)
     }
 }
 
-// Save the current printer status in a JSON string and a file.
-void NetworkInterface::SaveCurrentStatus(const PrinterStatus& status)
+// Save the latest status and push it to all the status pipes.
+void NetworkInterface::Publish()
 {
-    _statusJSON = status.ToString();
+    _publishPending = false;
+    _lastPublishMillis = GetTimeMillis();
+    
+    SaveCurrentStatus();
     
-    // save it in a file as well
-    std::ofstream statusFile(PRINTER_STATUS_FILE, std::ios::trunc);
-    if (!statusFile.is_open())
+    bool backedUp = false;
+    for (size_t i = 0; i < _statusPipes.size(); i++)
+    {
+        _statusPipes[i]->Send(_statusJSON, _droppedCount);
+        backedUp |= _statusPipes[i]->IsBackedUp();
+    }
+    
+    // retries already under way continue on their own schedule
+    if (!backedUp || _backedUpSinceMillis < 0)
+        RetryBackedUpPipes(backedUp);
+}
+
+// Save the current printer status in a file.  The status is written to a 
+// temporary file in tmpfs that then replaces the status file, so that readers 
+// never see a partially written status.
+void NetworkInterface::SaveCurrentStatus()
+{
+    int fd = open(PRINTER_STATUS_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
     {
         Logger::HandleError(SaveStatusToFileError);
         return;
     }
-    statusFile << _statusJSON;
+    
+    bool written = write(fd, _statusJSON.c_str(), _statusJSON.length()) == 
+                                                    (ssize_t)_statusJSON.length();
+    close(fd);
+    
+    if (!written || rename(PRINTER_STATUS_TEMP_FILE, PRINTER_STATUS_FILE) != 0)
+        Logger::HandleError(SaveStatusToFileError);
+}
+
+// Get the current time, in milliseconds, on the publish timer's clock (which 
+// may be simulated).
+long NetworkInterface::GetTimeMillis()
+{
+    if (_pPublishTimer == NULL)
+        return GetMillis();
+    
+    return _pPublishTimer->GetTimeMillis();
+}
+
+// Get the time since status was last published, in milliseconds, which is as
+// long as can be if it hasn't yet been published.
+long NetworkInterface::GetMillisSincePublish()
+{
+    if (_lastPublishMillis < 0)
+        return LONG_MAX;
+    
+    return GetTimeMillis() - _lastPublishMillis;
+}
+
+// Arrange for the publish timer to fire within the given number of 
+// milliseconds, unless it's already due to fire sooner.
+void NetworkInterface::ScheduleRetry(long delayMillis)
+{
+    if (_pPublishTimer == NULL)
+        return;
+    
+    double delaySec = delayMillis / 1000.0;
+    double remainingSec = _pPublishTimer->GetRemainingTimeSeconds();
+    if (remainingSec <= 0.0 || remainingSec > delaySec)
+        _pPublishTimer->Start(delaySec);
 }
 
-// Write the latest printer status to the status to web pipe
-void NetworkInterface::SendStringToPipe(std::string str, int fileDescriptor)
+// Arrange for backed up pipes to be retried, waiting twice as long after each
+// retry that fails (up to a limit).  Once they've been backed up for too long
+// (as when nothing ever reads one), the status held for them is dropped and 
+// they aren't retried again until there's new status to send.
+void NetworkInterface::RetryBackedUpPipes(bool backedUp)
 {
-    if (write(fileDescriptor, str.c_str(), str.length()) != str.length())
-        Logger::HandleError(SendStringToPipeError);
+    long now = GetTimeMillis();
+    
+    if (backedUp && _backedUpSinceMillis < 0)
+        _backedUpSinceMillis = now;
+    else if (backedUp && now - _backedUpSinceMillis >= PIPE_GIVE_UP_MS)
+    {
+        for (size_t i = 0; i < _statusPipes.size(); i++)
+            _statusPipes[i]->Discard(_droppedCount);
+        backedUp = false;
+    }
+    
+    if (!backedUp)
+    {
+        _retryMillis = PIPE_RETRY_MS;
+        _backedUpSinceMillis = -1;
+        return;
+    }
+    
+    ScheduleRetry(_retryMillis);
+    _retryMillis = std::min(_retryMillis * 2, PIPE_MAX_RETRY_MS);
+}
+
+// Constructor.  The pipe isn't opened until there's status to send to it.
+StatusPipe::StatusPipe(const std::string& path) :
+_path(path),
+_readFd(-1),
+_writeFd(-1),
+_loggedBackup(false)
+{
+}
+
+// Destructor
+StatusPipe::~StatusPipe()
+{
+    if (_writeFd >= 0)
+        close(_writeFd);
+    if (_readFd >= 0)
+        close(_readFd);
+}
+
+// Open the pipe for writing, if it's been created.  Returns true if the pipe
+// is open.
+bool StatusPipe::Open()
+{
+    if (_writeFd >= 0)
+        return true;
+    
+    // we only want to push status if the pipe has been created
+    if (access(_path.c_str(), F_OK) == -1) 
+        return false;
+    
+    // opening the pipe for writing without blocking requires that it also 
+    // be open for reading
+    _readFd = open(_path.c_str(), O_RDONLY | O_NONBLOCK);
+    _writeFd = open(_path.c_str(), O_WRONLY | O_NONBLOCK);
+    if (_writeFd < 0)
+    {
+        Logger::HandleError(StatusToWebPipeOpen);
+        if (_readFd >= 0)
+            close(_readFd);
+        _readFd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Send the given status to the pipe, after any status still being held for 
+// it.  If the pipe is backed up, the given status replaces any status waiting
+// to be sent, and the count of dropped updates is incremented.
+void StatusPipe::Send(const std::string& str, unsigned long& dropped)
+{
+    if (!Open())
+        return;
+    
+    if (!Flush())
+    {
+        if (!_queued.empty())
+            dropped++;
+        _queued = str;
+        
+        if (!_loggedBackup)
+        {
+            Logger::LogError(LOG_WARNING, errno, StatusPipeBackedUp, _path);
+            _loggedBackup = true;
+        }
+        return;
+    }
+    
+    if (!TryWrite(str) && _unsent.empty())
+        _queued = str;
+}
+
+// Write anything being held for the pipe.  Returns true if nothing remains to 
+// be written.
+bool StatusPipe::Flush()
+{
+    if (_writeFd < 0)
+        return true;
+    
+    if (!_unsent.empty())
+    {
+        std::string remainder;
+        remainder.swap(_unsent);
+        if (!TryWrite(remainder))
+        {
+            if (_unsent.empty())
+                _unsent.swap(remainder);
+            return false;
+        }
+    }
+    
+    if (!_queued.empty())
+    {
+        bool sent = TryWrite(_queued);
+        // a partially written status is now held as unsent
+        if (sent || !_unsent.empty())
+            _queued.clear();
+        if (!sent)
+            return false;
+    }
+    
+    _loggedBackup = false;
+    return true;
+}
+
+// Drop any status waiting to be sent, counting it as dropped.  The remainder
+// of a partially written status is kept, so that the reader never sees a
+// truncated status.
+void StatusPipe::Discard(unsigned long& dropped)
+{
+    if (_queued.empty())
+        return;
+    
+    _queued.clear();
+    dropped++;
+}
+
+// Write the given string to the pipe.  Returns true if it was all written.  
+// If only part of it could be written, the rest is held as unsent.
+bool StatusPipe::TryWrite(const std::string& str)
+{
+    ssize_t written = write(_writeFd, str.c_str(), str.length());
+    if (written == (ssize_t)str.length())
+        return true;
+    
+    if (written < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            Logger::HandleError(SendStringToPipeError);
+    }
+    else
+        _unsent = str.substr(written);
+    return false;
 }
- 
\ No newline at end of file
@@ -25,14 +25,21 @@
 #include <sys/stat.h>
 #include <string.h>
 #include <unistd.h>
+#include <sstream>
 
+#include <Logger.h>
 #include <PrintData.h>
 #include <PrintDataDirectory.h>
 #include <PrintDataZip.h>
 #include <utils.h>
 #include <TarGzFile.h>
+#include <Filenames.h>
 #include "PrintFileStorage.h"
 
+// parameters of the 64-bit FNV-1a hash
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
 // Use the specified storage object to find a print file and return an
 // appropriate PrintData instance, placing the print data in the specified
 // dataParentDirectory. The print data is renamed to or placed in a directory
@@ -127,3 +134,52 @@ PrintData* PrintData::CreateFromExistingData(const std::string& printDataPath)
         return NULL;
     }
 }
+
+// Read the contents of the slice image file for the given layer, along with 
+// a fingerprint of them, so that layers with identical images can be 
+// recognized without decoding them.  Returns false if the file can't be read.
+bool PrintData::GetLayerData(int layer, std::string& data, 
+                             uint64_t& fingerprint)
+{
+    if (!GetFileContents(GetSliceFileName(layer), data))
+        return false;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+    
+    fingerprint = hash;
+    return true;
+}
+
+// Decode the slice image for the given layer from the contents of its file, 
+// as already read by GetLayerData, so that the file needn't be read again.
+bool PrintData::DecodeLayerImage(int layer, const std::string& data, 
+                                 Magick::Image* pImage)
+{
+    try
+    {
+        Magick::Blob blob(data.data(), data.size()); 
+        pImage->read(blob);
+    }
+    catch(std::exception)
+    {
+        Logger::LogError(LOG_ERR, errno, LoadImageError, 
+                         GetSliceFileName(layer).c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+// Get the name of the slice image file for the given layer, within the print 
+// data.
+std::string PrintData::GetSliceFileName(int layer)
+{
+    std::ostringstream fileName;
+    fileName << SLICE_IMAGE_PREFIX << layer << "." << SLICE_IMAGE_EXTENSION;
+    return fileName.str();
+}
@@ -28,6 +28,8 @@
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <string.h>
+#include <math.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/types.h>
@@ -67,7 +69,9 @@ _gotRotationInterrupt(false),
 _alreadyOverheated(false),
 _inspectionRequested(false),
 _skipCalibration(false),
+_separationHeld(false),
 _remainingMotorTimeoutSec(0.0),
+_approachWaitFactor(1.0),
 _demoModeRequested(false),
 _printerStatusQueue(printerStatusQueue),
 _exposureTimer(exposureTimer),
@@ -94,6 +98,10 @@ _settings(PrinterSettings::Instance())
     
     _pThermometer = new Thermometer(haveHardware);
     
+    // no layer has been measured yet
+    _threadData.measureCrossSection = false;
+    _threadData.measuredImageID = NO_IMAGE_ID;
+    
     // create a PrintData instance if previously loaded print data exists
     _pPrintData.reset(PrintData::CreateFromExistingData(
         _settings.GetString(PRINT_DATA_DIR) + "/" + PRINT_DATA_NAME));
@@ -383,7 +391,8 @@ void PrintEngine::Handle(Command command)
             break;
             
         case Exit:
-            // EventHandler handles exit
+        case ShowEventStats:
+            // EventHandler handles these
             break;
             
         default:
@@ -485,6 +494,9 @@ void PrintEngine::StartExposureTimer(double seconds)
 {
     try
     {
+        // the projector ends the exposure itself, on time, and the timer then
+        // lets the state machine know it's ended
+        _projector.TurnLEDsOffAfter(seconds);
         _exposureTimer.Start(seconds);
     }
     catch (const std::runtime_error& e)
@@ -534,6 +546,19 @@ bool PrintEngine::IsBurnInLayer()
             _printerStatus._currentLayer <= 1 + numBurnInLayers);
 }
 
+// Returns the type of the given layer
+LayerType PrintEngine::GetLayerType(int n)
+{
+    if (n == 1)
+        return First;
+    
+    int numBurnInLayers = _settings.GetInt(BURN_IN_LAYERS);
+    if (numBurnInLayers > 0 && n <= 1 + numBurnInLayers)
+        return BurnIn;
+    
+    return Model;
+}
+
 // Start the timer whose expiration indicates that the motor controller hasn't 
 // signaled its command completion in the expected time
 void PrintEngine::StartMotorTimeoutTimer(int seconds)
@@ -584,6 +609,7 @@ void PrintEngine::SetNumLayers(int numLayers)
     // the number of layers should only be set before starting a print,
     // or when clearing it at the end or canceling of a print
     _printerStatus._currentLayer = 0;
+    _approachWaitFactor = 1.0;
 }
 
 // Increment the current layer number, get any layer-specific settings, 
@@ -597,6 +623,15 @@ void PrintEngine::NextLayer()
     
     GetCurrentLayerSettings();
     
+    // the wait after the previous layer's approach is this layer's pre-exposure
+    // delay, so any speed-up of that approach applies to it here
+    if (_approachWaitFactor != 1.0)
+    {
+        _cls.ApproachWaitMS = (int)(_cls.ApproachWaitMS / _approachWaitFactor 
+                                                                        + 0.5);
+        _approachWaitFactor = 1.0;
+    }
+    
     // log temperature at start, end, and quartile points
     int layer = _printerStatus._currentLayer;
     int total = _printerStatus._numLayers;
@@ -650,6 +685,11 @@ bool PrintEngine::LoadNextLayerImage()
         _threadData.usePatternMode = true;
     }     
     _threadData.imageProcessor = &_imageProcessor;
+    // only model layers have their motions and exposure adapted to their 
+    // cross-sections
+    _threadData.measureCrossSection = (_settings.GetInt(ADAPTIVE_MOTION) != 0 ||
+                                       _settings.GetInt(ADAPTIVE_EXPOSURE) != 0)
+                                      && GetLayerType(nextLayer) == Model;
 
     _threadError = Success;
     _threadErrorMsg = NULL;
@@ -683,45 +723,32 @@ bool PrintEngine::AwaitEndOfBackgroundThread(bool ignoreErrors)
             HandleError(_threadError, true);
         return false;
     }
+    
+    // once the current layer's image has been measured, its separation, 
+    // approach, and exposure can be adapted to it (just once)
+    if (_threadData.measureCrossSection && 
+        _threadData.layer == _printerStatus._currentLayer)
+    {
+        AdaptLayerSettings(_threadData.crossSection, _cls);
+        _threadData.measureCrossSection = false;
+    }
     return true;
 }
 
-// Sets the estimated print time
+// Sets the estimated print time, from the time predicted for each of the
+// remaining layers.
 void PrintEngine::SetEstimatedPrintTime()
 {
-    int layersLeft = _printerStatus._numLayers - 
-                    (_printerStatus._currentLayer - 1);
-
-    double burnInLayers = _settings.GetInt(BURN_IN_LAYERS);
-    double burnInTime = GetLayerTimeSec(BurnIn);
-    double modelTime = GetLayerTimeSec(Model);
-    double layerTimes = 0.0;
-
-    // remaining time depends first on what kind of layer we're in
-    if (IsFirstLayer())
-    {
-        layerTimes = GetLayerTimeSec(First) +
-                     burnInLayers * burnInTime + 
-                     (_printerStatus._numLayers - (burnInLayers + 1)) * 
-                                                                    modelTime;
-    } 
-    else if (IsBurnInLayer())
-    {
-        double burnInLayersLeft = burnInLayers - 
-                               (_printerStatus._currentLayer - 2);            
-        double modelLayersLeft = layersLeft - burnInLayersLeft;
-
-        layerTimes = burnInLayersLeft * burnInTime + 
-                   modelLayersLeft  * modelTime;
-
-    }
-    else
-    {
-        // all the remaining layers are model layers
-        layerTimes = layersLeft * modelTime;
-    }
+    // the predictions are normally made when the print starts
+    if (_remainingLayerTimesSec.size() != 
+                                (size_t) (_printerStatus._numLayers + 1))
+        EstimateLayerTimes();
+    
+    int layer = std::max(_printerStatus._currentLayer, 1);
+    double remainingTime = layer <= _printerStatus._numLayers ? 
+                                    _remainingLayerTimesSec[layer - 1] : 0.0;
 
-    _printerStatus._estimatedSecondsRemaining = (int)(layerTimes + 0.5);
+    _printerStatus._estimatedSecondsRemaining = (int)(remainingTime + 0.5);
 }
 
 // Tells state machine that an interrupt has arrived from the motor controller,
@@ -842,7 +869,13 @@ void PrintEngine::SendMotorCommand(HighLevelMotorCommand command)
             break;
             
         case Separate:
-            success = _motor.Separate(_cls);
+            if (_separationHeld)
+            {
+                success = _motor.ReleaseHeldMotion();
+                _separationHeld = false;
+            }
+            else
+                success = _motor.Separate(_cls);
             StartMotorTimeoutTimer(GetSeparationTimeoutSec());
             break;
                         
@@ -905,6 +938,19 @@ void PrintEngine::ClearCurrentPrint(bool withInterrupt)
     sprintf(msg, LOG_TEMPERATURE, _temperature);
     Logger::LogMessage(LOG_INFO, msg); 
     
+    // log how long it took to start each exposure
+    if (_exposureStartLatency.GetCount() > 0)
+    {
+        char latencyMsg[150];
+        snprintf(latencyMsg, sizeof(latencyMsg), LOG_EXPOSURE_START,
+            (unsigned long long)_exposureStartLatency.GetCount(),
+            (unsigned long long)_exposureStartLatency.GetMean(),
+            (unsigned long long)_exposureStartLatency.GetPercentile(99.0),
+            (unsigned long long)_exposureStartLatency.GetMax());
+        Logger::LogMessage(LOG_INFO, latencyMsg);
+        _exposureStartLatency.Reset();
+    }
+    
     // clear the number of layers
     SetNumLayers(0);
     // clear timers
@@ -965,12 +1011,30 @@ bool PrintEngine::DoorIsOpen()
 	return (value == (_invertDoorSwitch ? '0' : '1'));
 }
 
-// Wraps Projector's ShowCurrentImage method and handles errors
+// Sets up the projector ahead of the next exposure, so that starting it takes
+// as little time as possible.  (The image itself is staged in the background
+// thread.)
+void PrintEngine::PrepareExposure()
+{
+    try
+    {
+        _projector.PrepareLEDs();
+    }
+    catch (const std::exception& e)
+    {
+        HandleError(CantShowImage, true, NULL, _printerStatus._currentLayer);
+    }
+}
+
+// Wraps Projector's ShowCurrentImage method and handles errors, and records 
+// how long it took to start showing the image.
 void PrintEngine::ShowImage()
 {
     try
     {
+        uint64_t start = GetMicros();
         _projector.ShowCurrentImage();
+        _exposureStartLatency.Record(GetMicros() - start);
     }
     catch (const std::exception& e)
     {
@@ -1003,6 +1067,7 @@ bool PrintEngine::TryStartPrint()
 {
     ClearError();            
     _skipCalibration = false;
+    _separationHeld = false;
             
     // make sure we have valid data
     if (!_pPrintData || !_pPrintData->Validate())
@@ -1039,6 +1104,9 @@ bool PrintEngine::TryStartPrint()
     if (IsPrinterTooHot())
         return false;
     
+    PrepareLayerMotions();
+    EstimateLayerTimes();
+    
     // this would be a good point at which to validate print settings, 
     // if we knew the valid range for each
 
@@ -1288,77 +1356,24 @@ void PrintEngine::ClearPrintData()
         HandleError(CantRemovePrintData);        
 }
 
-// Gets the time (in seconds) required to print a layer based on the 
-// current settings for the type of layer.  Note: does not take into account
-// per-layer setting overrides that may change the actual print time.
-double PrintEngine::GetLayerTimeSec(LayerType type)
-{
-    double time, press, revs, zLift;
-    double height = _settings.GetInt(LAYER_THICKNESS);
-       
-    switch(type)
-    {
-        case First:
-            // start with the exposure time, in seconds
-            time = (double) _settings.GetDouble(FIRST_EXPOSURE);
-            // plus additional delay (converted from ms)
-            time += _settings.GetInt(FL_APPROACH_WAIT) / 1000.0;
-            // add separation time
-            revs = _settings.GetInt(FL_ROTATION) / MILLIDEGREES_PER_REV;
-            // rotation speeds in RPM, convert to revs per sec
-            time += (revs / _settings.GetInt(FL_SEPARATION_R_SPEED)) * 60.0;
-            // Z speeds are in microns/s
-            zLift = _settings.GetInt(FL_Z_LIFT);
-            time += zLift / _settings.GetInt(FL_SEPARATION_Z_SPEED);
-            // add approach time
-            time += (revs / _settings.GetInt(FL_APPROACH_R_SPEED)) * 60.0;    
-            time += (zLift - height) / _settings.GetInt(FL_APPROACH_Z_SPEED);
-            // add press/delay/unpress times, if tray deflection used
-            press = _settings.GetInt(FL_PRESS);
-            if (press != 0)
-            {
-                time += press / _settings.GetInt(FL_PRESS_SPEED);
-                time += _settings.GetInt(FL_PRESS_WAIT) / 1000.0;
-                time += press / _settings.GetInt(FL_UNPRESS_SPEED);
-            }
-            break;
-            
-        case BurnIn:
-            time = (double) _settings.GetDouble(BURN_IN_EXPOSURE);
-            time += _settings.GetInt(BI_APPROACH_WAIT) / 1000.0;   
-            revs = _settings.GetInt(BI_ROTATION) / MILLIDEGREES_PER_REV;
-            time += (revs / _settings.GetInt(BI_SEPARATION_R_SPEED)) * 60.0;
-            zLift = _settings.GetInt(BI_Z_LIFT);
-            time += zLift / _settings.GetInt(BI_SEPARATION_Z_SPEED);
-            time += (revs / _settings.GetInt(BI_APPROACH_R_SPEED)) * 60.0;    
-            time += (zLift - height) / _settings.GetInt(BI_APPROACH_Z_SPEED);
-            press = _settings.GetInt(BI_PRESS);
-            if (press != 0)
-            {
-                time += press / _settings.GetInt(BI_PRESS_SPEED);
-                time += _settings.GetInt(BI_PRESS_WAIT) / 1000.0;
-                time += press / _settings.GetInt(BI_UNPRESS_SPEED);
-            }
-            break;
-            
-        case Model:
-            time = (double) _settings.GetDouble(MODEL_EXPOSURE);
-            time += _settings.GetInt(ML_APPROACH_WAIT) / 1000.0;    
-            revs = _settings.GetInt(ML_ROTATION) / MILLIDEGREES_PER_REV;
-            time += (revs / _settings.GetInt(ML_SEPARATION_R_SPEED)) * 60.0;
-            zLift = _settings.GetInt(ML_Z_LIFT);
-            time += zLift / _settings.GetInt(ML_SEPARATION_Z_SPEED);
-            time += (revs / _settings.GetInt(ML_APPROACH_R_SPEED)) * 60.0;    
-            time += (zLift - height) / _settings.GetInt(ML_APPROACH_Z_SPEED);
-            press = _settings.GetInt(ML_PRESS);
-            if (press != 0)
-            {
-                time += press / _settings.GetInt(ML_PRESS_SPEED);
-                time += _settings.GetInt(ML_PRESS_WAIT) / 1000.0;
-                time += press / _settings.GetInt(ML_UNPRESS_SPEED);
-            }
-
-            break; 
+// Gets the time (in seconds) required to print a layer with the given 
+// settings, with its motions taking the time predicted for the way the motor
+// controller performs them.
+double PrintEngine::GetLayerTimeSec(const CurrentLayerSettings& cls)
+{
+    // start with the exposure time, in seconds
+    double time = cls.ExposureSec;
+    // plus additional delay (converted from ms)
+    time += cls.ApproachWaitMS / 1000.0;
+    // add separation and approach times
+    time += _motor.GetLayerMotionSec(SeparateMotion, cls);
+    time += _motor.GetLayerMotionSec(ApproachMotion, cls);
+    // add press/delay/unpress times, if tray deflection used
+    if (cls.PressMicrons != 0)
+    {
+        time += _motor.GetLayerMotionSec(PressMotion, cls);
+        time += cls.PressWaitMS / 1000.0;
+        time += _motor.GetLayerMotionSec(UnpressMotion, cls);
     }
     
     // add measured overhead 
@@ -1435,6 +1450,8 @@ void PrintEngine::ClearPendingMovement(bool withInterrupt)
     if (!_motor.ClearPendingCommands(withInterrupt))  
         HandleError(MotorError, true);
     
+    _separationHeld = false;
+    
     ClearMotorTimeoutTimer();
     _remainingMotorTimeoutSec= 0.0;
     
@@ -1442,6 +1459,22 @@ void PrintEngine::ClearPendingMovement(bool withInterrupt)
         StartMotorTimeoutTimer((int)_settings.GetDouble(MIN_MOTOR_TIMEOUT_SEC));
 }
 
+// Send the current layer's separation to the motor controller while the layer
+// is being exposed, so that only a single byte needs to be sent to start it 
+// once the exposure is completed.
+void PrintEngine::HoldSeparation()
+{
+    _separationHeld = _motor.HoldSeparation(_cls);
+}
+
+// Discard the separation held by the motor controller (if any), when leaving
+// the Exposing state before the exposure has been completed.
+void PrintEngine::DiscardHeldSeparation()
+{
+    if (_separationHeld)
+        ClearPendingMovement();
+}
+
 // Get the amount of tray deflection (if any) wanted after approach.
 int PrintEngine::GetTrayDeflection()
 {
@@ -1468,6 +1501,15 @@ int  PrintEngine::PadTimeout(double rawTime)
                             _settings.GetDouble(MIN_MOTOR_TIMEOUT_SEC));
 }
 
+// Pad the time predicted by the motor controller's planning for a layer 
+// motion by only a small margin, so that a jam is detected soon after the 
+// motion should have completed.
+int  PrintEngine::PadPredictedTimeout(double predictedTime)
+{
+    return (int) ceil(predictedTime * PREDICTED_MOTION_TIMEOUT_FACTOR + 
+                      PREDICTED_MOTION_TIMEOUT_SEC);
+}
+
 // Returns the timeout (in seconds) to allow for getting to the home position
 int PrintEngine::GetHomingTimeoutSec()
 {
@@ -1543,40 +1585,25 @@ int PrintEngine::GetUnjammingTimeoutSec()
 // Get the time required for the tray deflection movement.
 int PrintEngine::GetPressTimeoutSec()
 {
-    return PadTimeout(_cls.PressMicrons / (double) _cls.PressMicronsPerSec);
+    return PadPredictedTimeout(_motor.GetLayerMotionSec(PressMotion, _cls));
 }
 
 // Get the time required for moving back from tray deflection.
 int PrintEngine::GetUnpressTimeoutSec()
 {
-    return PadTimeout(_cls.PressMicrons / (double) _cls.UnpressMicronsPerSec);
+    return PadPredictedTimeout(_motor.GetLayerMotionSec(UnpressMotion, _cls));
 }
 
-// Gets the time required for separation from PDMS.  Assumes infinite jerk.
+// Gets the time required for separation from PDMS.
 int PrintEngine::GetSeparationTimeoutSec()
 {    
-    // rotational speeds are in RPM
-    double revs = _cls.RotationMilliDegrees / MILLIDEGREES_PER_REV;
-    double time = (revs / _cls.SeparationRPM) * 60.0;
-    
-    // Z speeds are in microns/s
-    time += _cls.ZLiftMicrons / (double) _cls.SeparationMicronsPerSec;
-        
-    return PadTimeout(time);   
+    return PadPredictedTimeout(_motor.GetLayerMotionSec(SeparateMotion, _cls));   
 }
 
 // Gets the time required for approach back to PDMS
 int PrintEngine::GetApproachTimeoutSec()
 {
-    // rotational speeds are in RPM
-    double revs = _cls.RotationMilliDegrees / MILLIDEGREES_PER_REV;
-    double time = (revs / _cls.ApproachRPM) * 60.0;    
-    
-    // Z speeds are in microns/s
-    time += (_cls.ZLiftMicrons - _cls.LayerThicknessMicrons) / 
-                                            (double) _cls.ApproachMicronsPerSec;
-            
-    return PadTimeout(time);   
+    return PadPredictedTimeout(_motor.GetLayerMotionSec(ApproachMotion, _cls));   
 }
 
 // Read all of the settings applicable to the current layer into a struct
@@ -1584,102 +1611,178 @@ int PrintEngine::GetApproachTimeoutSec()
 // called once per layer, after the layer number has been incremented 
 // for it.
 void PrintEngine::GetCurrentLayerSettings()
+{
+    GetLayerSettings(GetCurrentLayerNum(), _cls);
+    
+    // to avoid changes while pause & inspect is already in progress:
+    _cls.InspectionHeightMicrons = _settings.GetInt(INSPECTION_HEIGHT);
+    // see if there's enough headroom to lift the model for inspection.
+    _cls.CanInspect = (_cls.InspectionHeightMicrons != 0) && 
+                      (_settings.GetInt(MAX_Z_TRAVEL) > (_currentZPosition +  
+                                                        _cls.ZLiftMicrons +
+                                                _cls.InspectionHeightMicrons));
+}
+
+// Read the settings applicable to the given layer (other than those for 
+// inspection, which depend on the current position) into the given struct.
+void PrintEngine::GetLayerSettings(int n, CurrentLayerSettings& cls)
 {
     // The settings after exposure use the same layer type, but use the number
     // of the next layer for any per-layer overrides.
-    int n = GetCurrentLayerNum();
     int p = n + 1;
     
-    // find the type of layer n
-    LayerType type = Model;
-    if (n == 1)
-        type = First;
-    else
-    {
-        int numBurnInLayers = _settings.GetInt(BURN_IN_LAYERS);
-        if (numBurnInLayers > 0 && n <= 1 + numBurnInLayers)
-            type = BurnIn;
-    }
-
-    switch(type)
+    switch(GetLayerType(n))
     {
         case First:
-            _cls.PressMicrons = _perLayer.GetInt(n, FL_PRESS);
-            _cls.PressMicronsPerSec = _perLayer.GetInt(n, FL_PRESS_SPEED);
-            _cls.PressWaitMS = _perLayer.GetInt(n, FL_PRESS_WAIT);
-            _cls.UnpressMicronsPerSec = _perLayer.GetInt(n, FL_UNPRESS_SPEED);
-            _cls.ApproachWaitMS = _perLayer.GetInt(n, FL_APPROACH_WAIT);
-            _cls.ExposureSec = _perLayer.GetDouble(n, FIRST_EXPOSURE);
+            cls.PressMicrons = _perLayer.GetInt(n, FL_PRESS);
+            cls.PressMicronsPerSec = _perLayer.GetInt(n, FL_PRESS_SPEED);
+            cls.PressWaitMS = _perLayer.GetInt(n, FL_PRESS_WAIT);
+            cls.UnpressMicronsPerSec = _perLayer.GetInt(n, FL_UNPRESS_SPEED);
+            cls.ApproachWaitMS = _perLayer.GetInt(n, FL_APPROACH_WAIT);
+            cls.ExposureSec = _perLayer.GetDouble(n, FIRST_EXPOSURE);
             
-            _cls.SeparationRotJerk = _perLayer.GetInt(p, FL_SEPARATION_R_JERK);
-            _cls.SeparationRPM = _perLayer.GetInt(p, FL_SEPARATION_R_SPEED);
-            _cls.RotationMilliDegrees = _perLayer.GetInt(p, FL_ROTATION);
-            _cls.SeparationZJerk = _perLayer.GetInt(p, FL_SEPARATION_Z_JERK);
-            _cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
+            cls.SeparationRotJerk = _perLayer.GetInt(p, FL_SEPARATION_R_JERK);
+            cls.SeparationRPM = _perLayer.GetInt(p, FL_SEPARATION_R_SPEED);
+            cls.RotationMilliDegrees = _perLayer.GetInt(p, FL_ROTATION);
+            cls.SeparationZJerk = _perLayer.GetInt(p, FL_SEPARATION_Z_JERK);
+            cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
                                                         FL_SEPARATION_Z_SPEED);
-            _cls.ZLiftMicrons = _perLayer.GetInt(p, FL_Z_LIFT);
-            _cls.ApproachRotJerk = _perLayer.GetInt(p, FL_APPROACH_R_JERK);
-            _cls.ApproachRPM = _perLayer.GetInt(p, FL_APPROACH_R_SPEED);
-            _cls.ApproachZJerk = _perLayer.GetInt(p, FL_APPROACH_Z_JERK);
-            _cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
+            cls.ZLiftMicrons = _perLayer.GetInt(p, FL_Z_LIFT);
+            cls.ApproachRotJerk = _perLayer.GetInt(p, FL_APPROACH_R_JERK);
+            cls.ApproachRPM = _perLayer.GetInt(p, FL_APPROACH_R_SPEED);
+            cls.ApproachZJerk = _perLayer.GetInt(p, FL_APPROACH_Z_JERK);
+            cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
                                                         FL_APPROACH_Z_SPEED);
             break;
             
         case BurnIn:
-            _cls.PressMicrons = _perLayer.GetInt(n, BI_PRESS);
-            _cls.PressMicronsPerSec = _perLayer.GetInt(n, BI_PRESS_SPEED);
-            _cls.PressWaitMS = _perLayer.GetInt(n, BI_PRESS_WAIT);
-            _cls.UnpressMicronsPerSec = _perLayer.GetInt(n, BI_UNPRESS_SPEED);
-            _cls.ApproachWaitMS = _perLayer.GetInt(n, BI_APPROACH_WAIT);
-            _cls.ExposureSec = _perLayer.GetDouble(n, BURN_IN_EXPOSURE);
+            cls.PressMicrons = _perLayer.GetInt(n, BI_PRESS);
+            cls.PressMicronsPerSec = _perLayer.GetInt(n, BI_PRESS_SPEED);
+            cls.PressWaitMS = _perLayer.GetInt(n, BI_PRESS_WAIT);
+            cls.UnpressMicronsPerSec = _perLayer.GetInt(n, BI_UNPRESS_SPEED);
+            cls.ApproachWaitMS = _perLayer.GetInt(n, BI_APPROACH_WAIT);
+            cls.ExposureSec = _perLayer.GetDouble(n, BURN_IN_EXPOSURE);
             
-            _cls.SeparationRotJerk = _perLayer.GetInt(p, BI_SEPARATION_R_JERK);
-            _cls.SeparationRPM = _perLayer.GetInt(p, BI_SEPARATION_R_SPEED);
-            _cls.RotationMilliDegrees = _perLayer.GetInt(p, BI_ROTATION);
-            _cls.SeparationZJerk = _perLayer.GetInt(p, BI_SEPARATION_Z_JERK);
-            _cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
+            cls.SeparationRotJerk = _perLayer.GetInt(p, BI_SEPARATION_R_JERK);
+            cls.SeparationRPM = _perLayer.GetInt(p, BI_SEPARATION_R_SPEED);
+            cls.RotationMilliDegrees = _perLayer.GetInt(p, BI_ROTATION);
+            cls.SeparationZJerk = _perLayer.GetInt(p, BI_SEPARATION_Z_JERK);
+            cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
                                                         BI_SEPARATION_Z_SPEED);
-            _cls.ZLiftMicrons = _perLayer.GetInt(p, BI_Z_LIFT);
-            _cls.ApproachRotJerk = _perLayer.GetInt(p, BI_APPROACH_R_JERK);
-            _cls.ApproachRPM = _perLayer.GetInt(p, BI_APPROACH_R_SPEED);
-            _cls.ApproachZJerk = _perLayer.GetInt(p, BI_APPROACH_Z_JERK);
-            _cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
+            cls.ZLiftMicrons = _perLayer.GetInt(p, BI_Z_LIFT);
+            cls.ApproachRotJerk = _perLayer.GetInt(p, BI_APPROACH_R_JERK);
+            cls.ApproachRPM = _perLayer.GetInt(p, BI_APPROACH_R_SPEED);
+            cls.ApproachZJerk = _perLayer.GetInt(p, BI_APPROACH_Z_JERK);
+            cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
                                                         BI_APPROACH_Z_SPEED);
             break;
             
         case Model:
-            _cls.PressMicrons = _perLayer.GetInt(n, ML_PRESS);
-            _cls.PressMicronsPerSec = _perLayer.GetInt(n, ML_PRESS_SPEED);
-            _cls.PressWaitMS = _perLayer.GetInt(n, ML_PRESS_WAIT);
-            _cls.UnpressMicronsPerSec = _perLayer.GetInt(n, ML_UNPRESS_SPEED);
-            _cls.ApproachWaitMS = _perLayer.GetInt(n, ML_APPROACH_WAIT);
-            _cls.ExposureSec = _perLayer.GetDouble(n, MODEL_EXPOSURE); 
+            cls.PressMicrons = _perLayer.GetInt(n, ML_PRESS);
+            cls.PressMicronsPerSec = _perLayer.GetInt(n, ML_PRESS_SPEED);
+            cls.PressWaitMS = _perLayer.GetInt(n, ML_PRESS_WAIT);
+            cls.UnpressMicronsPerSec = _perLayer.GetInt(n, ML_UNPRESS_SPEED);
+            cls.ApproachWaitMS = _perLayer.GetInt(n, ML_APPROACH_WAIT);
+            cls.ExposureSec = _perLayer.GetDouble(n, MODEL_EXPOSURE); 
             
-            _cls.SeparationRotJerk = _perLayer.GetInt(p, ML_SEPARATION_R_JERK);
-            _cls.SeparationRPM = _perLayer.GetInt(p, ML_SEPARATION_R_SPEED);
-            _cls.RotationMilliDegrees = _perLayer.GetInt(p, ML_ROTATION);
-            _cls.SeparationZJerk = _perLayer.GetInt(p, ML_SEPARATION_Z_JERK);
-            _cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
+            cls.SeparationRotJerk = _perLayer.GetInt(p, ML_SEPARATION_R_JERK);
+            cls.SeparationRPM = _perLayer.GetInt(p, ML_SEPARATION_R_SPEED);
+            cls.RotationMilliDegrees = _perLayer.GetInt(p, ML_ROTATION);
+            cls.SeparationZJerk = _perLayer.GetInt(p, ML_SEPARATION_Z_JERK);
+            cls.SeparationMicronsPerSec = _perLayer.GetInt(p, 
                                                         ML_SEPARATION_Z_SPEED);
-            _cls.ZLiftMicrons = _perLayer.GetInt(p, ML_Z_LIFT);
-            _cls.ApproachRotJerk = _perLayer.GetInt(p, ML_APPROACH_R_JERK);
-            _cls.ApproachRPM = _perLayer.GetInt(p, ML_APPROACH_R_SPEED);
-            _cls.ApproachZJerk = _perLayer.GetInt(p, ML_APPROACH_Z_JERK);
-            _cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
+            cls.ZLiftMicrons = _perLayer.GetInt(p, ML_Z_LIFT);
+            cls.ApproachRotJerk = _perLayer.GetInt(p, ML_APPROACH_R_JERK);
+            cls.ApproachRPM = _perLayer.GetInt(p, ML_APPROACH_R_SPEED);
+            cls.ApproachZJerk = _perLayer.GetInt(p, ML_APPROACH_Z_JERK);
+            cls.ApproachMicronsPerSec = _perLayer.GetInt(p, 
                                                         ML_APPROACH_Z_SPEED);
             break;
     }
     
     // likewise any layer thickness overrides come from the next layer
-    _cls.LayerThicknessMicrons = _perLayer.GetInt(p, LAYER_THICKNESS);
+    cls.LayerThicknessMicrons = _perLayer.GetInt(p, LAYER_THICKNESS);
+}
+
+// Speed up the separation and approach for a layer whose cured cross-section
+// is small enough to need less care, as determined by the adaptive motion
+// settings, and lengthen or shorten its exposure according to how much of 
+// that cross-section is solid, as determined by the adaptive exposure 
+// settings.
+void PrintEngine::AdaptLayerSettings(const CrossSection& crossSection, 
+                                     CurrentLayerSettings& cls)
+{
+    if (_settings.GetInt(ADAPTIVE_EXPOSURE) != 0)
+    {
+        double exposureFactor = crossSection.GetExposureFactor(
+                                    _settings.GetDouble(ADAPTIVE_SOLID_EDGE),
+                                    _settings.GetDouble(ADAPTIVE_THIN_EDGE),
+                                    _settings.GetDouble(ADAPTIVE_MIN_EXPOSURE),
+                                    _settings.GetDouble(ADAPTIVE_MAX_EXPOSURE));
+        cls.ExposureSec *= exposureFactor;
+        
+        // record the exposure chosen for each layer
+        char msg[150];
+        snprintf(msg, sizeof(msg), LOG_ADAPTED_EXPOSURE, 
+                 _printerStatus._currentLayer, cls.ExposureSec, exposureFactor,
+                 crossSection.GetEdgePercent());
+        Logger::LogMessage(LOG_INFO, msg);
+    }
     
-    // to avoid changes while pause & inspect is already in progress:
-    _cls.InspectionHeightMicrons = _settings.GetInt(INSPECTION_HEIGHT);
-    // see if there's enough headroom to lift the model for inspection.
-    _cls.CanInspect = (_cls.InspectionHeightMicrons != 0) && 
-                      (_settings.GetInt(MAX_Z_TRAVEL) > (_currentZPosition +  
-                                                        _cls.ZLiftMicrons +
-                                                _cls.InspectionHeightMicrons));
+    if (_settings.GetInt(ADAPTIVE_MOTION) == 0)
+        return;
+    
+    double factor = crossSection.GetSpeedFactor(
+                                    _settings.GetDouble(ADAPTIVE_SMALL_AREA),
+                                    _settings.GetDouble(ADAPTIVE_LARGE_AREA),
+                                    _settings.GetDouble(ADAPTIVE_SPEED_FACTOR),
+                                    _settings.GetInt(ADAPTIVE_MAX_ISLANDS));
+    if (factor == 1.0)
+        return;
+    
+    cls.SeparationRotJerk = (int)(cls.SeparationRotJerk * factor + 0.5);
+    cls.SeparationRPM = (int)(cls.SeparationRPM * factor + 0.5);
+    cls.SeparationZJerk = (int)(cls.SeparationZJerk * factor + 0.5);
+    cls.SeparationMicronsPerSec = 
+                            (int)(cls.SeparationMicronsPerSec * factor + 0.5);
+    cls.ApproachRotJerk = (int)(cls.ApproachRotJerk * factor + 0.5);
+    cls.ApproachRPM = (int)(cls.ApproachRPM * factor + 0.5);
+    cls.ApproachZJerk = (int)(cls.ApproachZJerk * factor + 0.5);
+    cls.ApproachMicronsPerSec = 
+                            (int)(cls.ApproachMicronsPerSec * factor + 0.5);
+    // the wait after this approach belongs to the next layer's settings, 
+    // so it's shortened when they're read
+    _approachWaitFactor = factor;
+}
+
+// Pre-encode the separation, approach, press, and unpress motions for every 
+// layer of the print, so that sending them takes as little time as possible.
+void PrintEngine::PrepareLayerMotions()
+{
+    _motor.ClearPreparedLayers();
+    
+    CurrentLayerSettings cls;
+    for (int n = 1; n <= _printerStatus._numLayers; n++)
+    {
+        GetLayerSettings(n, cls);
+        _motor.PrepareLayer(cls);
+    }
+}
+
+// Predict the time needed for each layer of the current print, from its own 
+// settings, and keep the total for each layer through to the end of the print.
+void PrintEngine::EstimateLayerTimes()
+{
+    int numLayers = _printerStatus._numLayers;
+    _remainingLayerTimesSec.assign(numLayers + 1, 0.0);
+    
+    CurrentLayerSettings cls;
+    for (int n = numLayers; n >= 1; n--)
+    {
+        GetLayerSettings(n, cls);
+        _remainingLayerTimesSec[n - 1] = _remainingLayerTimesSec[n] + 
+                                         GetLayerTimeSec(cls);
+    }
 }
 
 // Indicate whether the last print is regarded as successful or failed.
@@ -1794,7 +1897,31 @@ void* PrintEngine::InBackground(void* context)
 
         ThreadData* pData = (ThreadData*)context;
 
-        if (!pData->pPrintData->GetImageForLayer(pData->layer, pData->pImage))
+        // a layer whose slice image is identical to that of the image 
+        // already prepared in the projector (as is common for the layers of 
+        // prismatic parts) needs no decoding, processing, or blitting
+        std::string sliceData;
+        uint64_t fingerprint;
+        if (!pData->pPrintData->GetLayerData(pData->layer, sliceData, 
+                                             fingerprint))
+        {
+            _threadError = NoImageForLayer;
+            pthread_exit(NULL);
+        }
+        uint64_t imageID = GetPreparedImageID(fingerprint, pData->scaleFactor, 
+                                              pData->usePatternMode);
+        
+        if (pData->pProjector->GetImageID() == imageID &&
+            (!pData->measureCrossSection || pData->measuredImageID == imageID))
+        {
+            // though it may still need to be staged for display
+            pData->pProjector->StageCurrentImage();
+            pthread_exit(NULL);
+        }
+        
+        // otherwise decode it from the data already read
+        if (!pData->pPrintData->DecodeLayerImage(pData->layer, sliceData, 
+                                                 pData->pImage))
         {
             _threadError = NoImageForLayer;
             pthread_exit(NULL);
@@ -1804,13 +1931,23 @@ void* PrintEngine::InBackground(void* context)
         if (pData->scaleFactor != 1.0)
             pData->imageProcessor->Scale(pData->pImage, pData->scaleFactor);
         
+        // measure the area to be cured, for adapting the layer's motions
+        if (pData->measureCrossSection)
+        {
+            pData->imageProcessor->Measure(*pData->pImage, 
+                                           pData->crossSection);
+            pData->measuredImageID = imageID;
+        }
+        
         Magick::Image* pOutput = pData->pImage;
         // remap the image for pattern mode if needed
         if (pData->usePatternMode)
             pOutput = pData->imageProcessor->MapForPatternMode(*pData->pImage);
         
-        // convert the image to a projectable format
-        pData->pProjector->SetImage(*pOutput);
+        // convert the image to a projectable format, and get it ready to be 
+        // displayed
+        pData->pProjector->SetImage(*pOutput, imageID);
+        pData->pProjector->StageCurrentImage();
     }
     catch (const std::exception& e)
     {
@@ -1821,6 +1958,24 @@ void* PrintEngine::InBackground(void* context)
     pthread_exit(NULL);
 }
 
+// Returns an identifier for the image prepared in the projector from a slice 
+// image with the given fingerprint, scaled and mapped as given, so that the 
+// same slice image prepared differently isn't taken to be the same image.
+uint64_t PrintEngine::GetPreparedImageID(uint64_t fingerprint, 
+                                         double scaleFactor, 
+                                         bool usePatternMode)
+{
+    uint64_t scaleBits;
+    memcpy(&scaleBits, &scaleFactor, sizeof(scaleBits));
+    
+    uint64_t id = fingerprint ^ (scaleBits * 0x9E3779B97F4A7C15ULL);
+    if (usePatternMode)
+        id = ~id;
+    
+    // avoid the value reserved for images with unknown contents
+    return id == NO_IMAGE_ID ? 1 : id;
+}
+
 // Set or clear PrinterStatus flag indicating if we can load print data.
 void PrintEngine::SetCanLoadPrintData(bool canLoad)
 {
@@ -0,0 +1,200 @@
+//  File:   PrintSimulator.cpp
+//  Runs a print in simulated time and reports how long each layer took
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <errno.h>
+#include <algorithm>
+
+#include <PrintSimulator.h>
+#include <VirtualClock.h>
+#include <Logger.h>
+#include <MessageStrings.h>
+
+PrintSimulator::PrintSimulator(const VirtualClock& clock,
+                               ICommandTarget& printEngine,
+                               ICommandTarget& eventHandler,
+                               const char* reportPath) :
+_clock(clock),
+_printEngine(printEngine),
+_eventHandler(eventHandler),
+_reportPath(reportPath),
+_started(false),
+_finished(false),
+_startSec(0.0),
+_lastSec(0.0),
+_layer(0),
+_numLayers(0),
+_estimatedSec(0),
+_layerTimes(1, StateTimes())
+{
+    _layerTimes[0].fill(0.0);
+}
+
+void PrintSimulator::Callback(EventType eventType, const EventData& data)
+{
+    switch(eventType)
+    {
+        case PrinterStatusUpdate:
+            if (!_finished)
+                Follow(data.Get<PrinterStatus>());
+            break;
+
+        default:
+            Logger::LogError(LOG_WARNING, errno, UnexpectedEvent, eventType);
+            break;
+    }
+}
+
+// Charges the time since the last status to the state the printer was in
+// until now, and keeps track of the states entered and left.  Starts the print
+// when the printer first gets home (skipping calibration), and finishes when it
+// gets back there (or into an error).
+void PrintSimulator::Follow(const PrinterStatus& status)
+{
+    double now = _clock.GetSeconds();
+    if (_started && !_states.empty())
+        _layerTimes[_layer][_states.back()] += now - _lastSec;
+    _lastSec = now;
+
+    if (status._change == Entering)
+        _states.push_back(status._state);
+    else if (status._change == Leaving)
+    {
+        std::vector<PrintEngineState>::reverse_iterator it =
+                    std::find(_states.rbegin(), _states.rend(), status._state);
+        if (it != _states.rend())
+            _states.erase((it + 1).base());
+    }
+
+    // the layer count and number are cleared as the print ends
+    if (status._numLayers > 0)
+    {
+        _layer = status._currentLayer;
+        _numLayers = status._numLayers;
+        if (_layer >= static_cast<int>(_layerTimes.size()))
+        {
+            StateTimes none;
+            none.fill(0.0);
+            _layerTimes.resize(_layer + 1, none);
+        }
+
+        // the estimate is made as the first layer starts
+        if (_layer == 1 && _estimatedSec == 0)
+            _estimatedSec = status._estimatedSecondsRemaining;
+    }
+    else
+        _layer = 0;
+
+    if (status._change != Entering)
+        return;
+
+    if (status._state == ErrorState)
+        Finish("failed");
+    else if (!_started && status._state == HomeState)
+    {
+        if (status._UISubState == NoPrintData)
+            Finish("had no print data");
+        else
+            _printEngine.Handle(Start);
+    }
+    else if (!_started && status._state == MovingToStartPositionState)
+    {
+        _started = true;
+        _startSec = now;
+        
+        // there's no one to calibrate the printer, so skip it, as if the 
+        // right button had been pressed
+        if (status._UISubState == CalibratePrompt)
+            _printEngine.Handle(Button2);
+    }
+    else if (_started && (status._state == HomeState ||
+                          status._state == GettingFeedbackState))
+        Finish(status._UISubState == PrintCanceled ? "canceled" : "completed");
+}
+
+// Reports the time taken by the print, and ends the simulation.
+void PrintSimulator::Finish(const char* outcome)
+{
+    _finished = true;
+
+    double total = _started ? _lastSec - _startSec : 0.0;
+    int layersPrinted = std::max(static_cast<int>(_layerTimes.size()) - 1, 0);
+
+    if (WriteReport())
+    {
+        char msg[256];
+        snprintf(msg, sizeof(msg), LOG_SIMULATION_SUMMARY, outcome,
+                 layersPrinted, _numLayers, total, _estimatedSec,
+                 _reportPath.c_str());
+        Logger::LogMessage(LOG_INFO, msg);
+    }
+
+    _eventHandler.Handle(Exit);
+}
+
+// Writes the time spent in each state during each layer as CSV, with a
+// column for each state the printer was in at some point in the print, and a
+// row for each layer (with layer 0 for the time outside of any layer).
+bool PrintSimulator::WriteReport()
+{
+    FILE* pFile = fopen(_reportPath.c_str(), "w");
+    if (pFile == NULL)
+    {
+        Logger::LogError(LOG_WARNING, errno, CantWriteSimulationReport);
+        return false;
+    }
+
+    std::vector<int> states;
+    for (int s = UndefinedPrintEngineState + 1; s < MaxPrintEngineState; s++)
+    {
+        for (size_t layer = 0; layer < _layerTimes.size(); layer++)
+        {
+            if (_layerTimes[layer][s] > 0.0)
+            {
+                states.push_back(s);
+                break;
+            }
+        }
+    }
+
+    fprintf(pFile, "layer");
+    for (size_t i = 0; i < states.size(); i++)
+        fprintf(pFile, ",%s",
+                PrinterStatus::GetStateName((PrintEngineState)states[i]));
+    fprintf(pFile, ",total\n");
+
+    for (size_t layer = 0; layer < _layerTimes.size(); layer++)
+    {
+        double total = 0.0;
+        fprintf(pFile, "%zu", layer);
+        for (size_t i = 0; i < states.size(); i++)
+        {
+            fprintf(pFile, ",%.3f", _layerTimes[layer][states[i]]);
+            total += _layerTimes[layer][states[i]];
+        }
+        fprintf(pFile, ",%.3f\n", total);
+    }
+
+    fclose(pFile);
+    return true;
+}
@@ -817,6 +817,9 @@ Pressing::Pressing(my_context ctx) : my_base(ctx)
     
     PRINTENGINE->SendStatus(PressingState, Entering, uiSubState);
     
+    // get the projector ready for exposure while the tray is pressed 
+    PRINTENGINE->PrepareExposure();
+    
     if (context<PrinterStateMachine>()._motionCompleted) 
         post_event(EvMotionCompleted());
 }
@@ -893,6 +896,10 @@ PreExposureDelay::PreExposureDelay(my_context ctx) : my_base(ctx)
     
     PRINTENGINE->SendStatus(PreExposureDelayState, Entering, uiSubState);
 
+    // get the projector ready for exposure during the delay, if that wasn't
+    // already done while pressing
+    PRINTENGINE->PrepareExposure();
+    
     if (PRINTENGINE->NeedsPreExposureDelay())
     {
         PRINTENGINE->StartDelayTimer(PRINTENGINE->GetPreExposureDelayTimeSec());
@@ -943,6 +950,9 @@ Exposing::Exposing(my_context ctx) : my_base(ctx)
     PRINTENGINE->ShowImage();
     
     PRINTENGINE->StartExposureTimer(exposureTimeSec);
+    
+    // send the separation ahead of time, to be started when exposure ends
+    PRINTENGINE->HoldSeparation();
 }
 
 Exposing::~Exposing()
@@ -950,6 +960,9 @@ Exposing::~Exposing()
     // black out the projected image
     PRINTENGINE->TurnProjectorOff();
     
+    // the held separation isn't wanted if the exposure wasn't completed
+    PRINTENGINE->DiscardHeldSeparation();
+    
     // if we're leaving during the middle of exposure, 
     // we need to record that fact, 
     // as well as our layer and the remaining exposure time
@@ -1171,12 +1184,12 @@ UpgradingProjector::~UpgradingProjector()
 
 sc::result UpgradingProjector::react(const EvDelayEnded&)
 {
-    // do actual re-programming of projector firmware
+    // start re-programming the projector firmware, or check on its progress
     PRINTENGINE->UpgradeProjectorFirmware();
     if(!PRINTENGINE->ProjectorProgrammingCompleted())
     {
-        // minimal delay, to allow progress update, which itself takes 300 ms
-        PRINTENGINE->StartDelayTimer(0.001);
+        // programming continues on its own thread in the meantime
+        PRINTENGINE->StartDelayTimer(UPGRADE_PROGRESS_INTERVAL_SEC);
         // send status, to update progress indicator
         PRINTENGINE->SendStatus(UpgradingProjectorState, NoChange);
     }
@@ -23,12 +23,12 @@
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include <exception>
+#include <climits>
 
 #define RAPIDJSON_ASSERT(x)                         \
   if (x);                                            \
   else throw std::exception();  
 
-#include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 
@@ -40,6 +40,21 @@
 
 using namespace rapidjson;
 
+// The unique ID given to statuses when they're first constructed.  Since 
+// statuses are constructed for every event delivered, the ID is only read once, 
+// and a new one is only requested when the print engine clears the job ID.
+static const char* GetInitialUUID()
+{
+    static char uuid[UUID_LEN + 1];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        GetUUID(uuid);
+        initialized = true;
+    }
+    return uuid;
+}
+
 // Constructor
 PrinterStatus::PrinterStatus() :
 _state(PrinterOnState),
@@ -58,7 +73,7 @@ _jobID(""),
 _canLoadPrintData(false),
 _canUpgradeProjector(false)
 {
-    GetUUID(_localJobUniqueID); 
+    memcpy(_localJobUniqueID, GetInitialUUID(), UUID_LEN + 1); 
 }
 
 // Gets the name of a print engine state machine state
@@ -152,110 +167,127 @@ const char* PrinterStatus::GetSubStateName(UISubState substate)
     return substateNames[substate];
 }
 
-// Returns printer status as a JSON formatted string.
+std::string _lastErrorMessage = "";
+
+// Buffer reused for serializing each status, to avoid reallocating it on 
+// every state transition.  Status is only serialized from the main thread.
+static StringBuffer _jsonBuffer;
+
+// The job name comes from settings, but only needs to be retrieved again when 
+// the settings have changed.
+static std::string _cachedJobName = "";
+static unsigned long _jobNameRevision = ULONG_MAX;
+
+// Returns the job name, retrieving it from settings only if they've changed 
+// since it was last retrieved.
+static const std::string& GetJobName()
+{
+    Settings& settings = PrinterSettings::Instance();
+    if (settings.GetRevision() != _jobNameRevision)
+    {
+        _cachedJobName = settings.GetString(JOB_NAME_SETTING);
+        _jobNameRevision = settings.GetRevision();
+    }
+    return _cachedJobName;
+}
+
+// Write the given key and string value.
+static void WriteString(Writer<StringBuffer>& writer, const char* key, 
+                        const char* value, SizeType length)
+{
+    writer.String(key);
+    writer.String(value, length);
+}
+
+// Write the given key and null-terminated string value.
+static void WriteString(Writer<StringBuffer>& writer, const char* key, 
+                        const char* value)
+{
+    WriteString(writer, key, value, strlen(value));
+}
+
+// Write the given key and string value.
+static void WriteString(Writer<StringBuffer>& writer, const char* key, 
+                        const std::string& value)
+{
+    WriteString(writer, key, value.c_str(), value.size());
+}
+
+// Returns printer status as a JSON formatted string.  The JSON is written 
+// directly, in the same order as the keys have always been written, rather 
+// than by parsing a template document and then serializing it again.
 std::string PrinterStatus::ToString() const
 {
     std::string retVal = "";
    
-    std::ostringstream json;
-    json << "{" <<
-            "\"" << STATE_PS_KEY           << "\": \"\"," <<
-            "\"" << UISUBSTATE_PS_KEY      << "\": \"\"," <<
-            "\"" << CHANGE_PS_KEY          << "\": \"\"," <<
-            "\"" << IS_ERROR_PS_KEY        << "\": false," <<
-            "\"" << ERROR_CODE_PS_KEY      << "\": 0," <<
-            "\"" << ERRNO_PS_KEY           << "\": 0," <<
-            "\"" << ERROR_MSG_PS_KEY       << "\": \"\"," <<
-            "\"" << JOB_NAME_PS_KEY        << "\": \"\"," <<  
-            "\"" << JOB_ID_PS_KEY          << "\": \"\"," <<  
-            "\"" << LAYER_PS_KEY           << "\": 0," <<
-            "\"" << TOTAL_LAYERS_PS_KEY    << "\": 0," <<
-            "\"" << SECONDS_LEFT_PS_KEY    << "\": 0," <<
-            "\"" << TEMPERATURE_PS_KEY     << "\": 0.0," <<
-            "\"" << PRINT_RATING_PS_KEY    << "\": \"\"," <<
-            "\"" << SPARK_STATE_PS_KEY     << "\": \"\"," <<
-            "\"" << SPARK_JOB_STATE_PS_KEY << "\": \"\"," <<
-            "\"" << LOCAL_JOB_UUID_PS_KEY  << "\": \"\"," <<
-            "\"" << CAN_LOAD_PS_KEY        << "\": \"\"," <<
-            "\"" << CAN_UPGRADE_PROJECTOR_PS_KEY    << "\": false" <<
-            "}";
-    
     try
     {
-        std::string jsonString = json.str();
-        Document doc;
-        doc.Parse(jsonString.c_str());
+        _jsonBuffer.Clear();
+        Writer<StringBuffer> writer(_jsonBuffer);
         
-        Value value;
-        const char* state = GetStateName(_state);
-        value.SetString(state, strlen(state), doc.GetAllocator());       
-        doc[STATE_PS_KEY] = value; 
+        writer.StartObject();
+        
+        WriteString(writer, STATE_PS_KEY, GetStateName(_state));
+        WriteString(writer, UISUBSTATE_PS_KEY, GetSubStateName(_UISubState));
         
-        const char* substate = GetSubStateName(_UISubState);
-        value.SetString(substate, strlen(substate), doc.GetAllocator()); 
-        doc[UISUBSTATE_PS_KEY] = value;
-       
         if (_change == Entering)
-           value.SetString(StringRef(ENTERING));
+            WriteString(writer, CHANGE_PS_KEY, ENTERING);
         else if (_change == Leaving)
-           value.SetString(StringRef(LEAVING));
+            WriteString(writer, CHANGE_PS_KEY, LEAVING);
         else
-            value.SetString(StringRef(NO_CHANGE));
-        doc[CHANGE_PS_KEY] = value; 
-
-        if (_printRating == Succeeded)
-           value.SetString(StringRef(PRINT_SUCCESSFUL));
-        else if (_printRating == Failed)
-           value.SetString(StringRef(PRINT_FAILED));
-        else
-           value.SetString(StringRef(UNKNOWN_PRINT_FEEDBACK));
-        doc[PRINT_RATING_PS_KEY] = value;         
+            WriteString(writer, CHANGE_PS_KEY, NO_CHANGE);
         
-        doc[IS_ERROR_PS_KEY] = _isError;        
-        doc[ERROR_CODE_PS_KEY] = _errorCode; 
-        doc[ERRNO_PS_KEY] = _errno; 
-        value.SetString(GetLastErrorMessage().c_str(), 
-                    GetLastErrorMessage().size(), doc.GetAllocator()); 
-        doc[ERROR_MSG_PS_KEY] = value;       
+        writer.String(IS_ERROR_PS_KEY);
+        writer.Bool(_isError);
+        writer.String(ERROR_CODE_PS_KEY);
+        writer.Int(_errorCode);
+        writer.String(ERRNO_PS_KEY);
+        writer.Int(_errno);
+        WriteString(writer, ERROR_MSG_PS_KEY, _lastErrorMessage);
         
         // job name comes from settings rather than PrinterStatus
-        std::string ss = 
-                    PrinterSettings::Instance().GetString(JOB_NAME_SETTING);
-        value.SetString(ss.c_str(), ss.size(), doc.GetAllocator()); 
-        doc[JOB_NAME_PS_KEY] = value;        
+        WriteString(writer, JOB_NAME_PS_KEY, GetJobName());
+        WriteString(writer, JOB_ID_PS_KEY, _jobID);
         
-        value.SetString(_jobID.c_str(), _jobID.size(), doc.GetAllocator()); 
-        doc[JOB_ID_PS_KEY] = value;        
+        writer.String(LAYER_PS_KEY);
+        writer.Int(_currentLayer);
+        writer.String(TOTAL_LAYERS_PS_KEY);
+        writer.Int(_numLayers);
+        writer.String(SECONDS_LEFT_PS_KEY);
+        writer.Int(_estimatedSecondsRemaining);
+        writer.String(TEMPERATURE_PS_KEY);
+        writer.Double(_temperature);
         
-        doc[LAYER_PS_KEY] = _currentLayer;
-        doc[TOTAL_LAYERS_PS_KEY] = _numLayers;
-        doc[SECONDS_LEFT_PS_KEY] = _estimatedSecondsRemaining;
-        doc[TEMPERATURE_PS_KEY] = _temperature;
+        if (_printRating == Succeeded)
+            WriteString(writer, PRINT_RATING_PS_KEY, PRINT_SUCCESSFUL);
+        else if (_printRating == Failed)
+            WriteString(writer, PRINT_RATING_PS_KEY, PRINT_FAILED);
+        else
+            WriteString(writer, PRINT_RATING_PS_KEY, UNKNOWN_PRINT_FEEDBACK);
         
         // get the Spark API printer and job states
-        ss = SparkStatus::GetSparkStatus(_state, _UISubState, 
-                                                            _canLoadPrintData);
-        value.SetString(ss.c_str(), ss.size(), doc.GetAllocator()); 
-        doc[SPARK_STATE_PS_KEY] = value;
+        WriteString(writer, SPARK_STATE_PS_KEY, 
+            SparkStatus::GetSparkStatus(_state, _UISubState, 
+                                                            _canLoadPrintData));
         
         // we know we're printing if we have a non-zero number of layers 
-        ss = SparkStatus::GetSparkJobStatus(_state, _UISubState, 
-                                                                _numLayers > 0);
-        value.SetString(ss.c_str(), ss.size(), doc.GetAllocator()); 
-        doc[SPARK_JOB_STATE_PS_KEY] = value;
+        WriteString(writer, SPARK_JOB_STATE_PS_KEY, 
+            SparkStatus::GetSparkJobStatus(_state, _UISubState, 
+                                                                _numLayers > 0));
         
         // write the UUID used by Spark for local jobs
-        value.SetString(_localJobUniqueID, strlen(_localJobUniqueID), 
-                                                            doc.GetAllocator()); 
-        doc[LOCAL_JOB_UUID_PS_KEY] = value;
+        WriteString(writer, LOCAL_JOB_UUID_PS_KEY, _localJobUniqueID);
+        
+        writer.String(CAN_LOAD_PS_KEY);
+        writer.Bool(_canLoadPrintData);
+        writer.String(CAN_UPGRADE_PROJECTOR_PS_KEY);
+        writer.Bool(_canUpgradeProjector);
         
-        doc[CAN_LOAD_PS_KEY] = _canLoadPrintData; 
-        doc[CAN_UPGRADE_PROJECTOR_PS_KEY] = _canUpgradeProjector;
+        writer.EndObject();
         
-        StringBuffer buffer; 
-        Writer<StringBuffer> writer(buffer);
-        doc.Accept(writer);        
-        retVal = std::string(buffer.GetString()) + "\n";
+        retVal.reserve(_jsonBuffer.GetSize() + 1);
+        retVal.append(_jsonBuffer.GetString(), _jsonBuffer.GetSize());
+        retVal.push_back('\n');
     }
     catch(std::exception)
     {
@@ -264,8 +296,6 @@ std::string PrinterStatus::ToString() const
     return retVal; 
 }
 
-std::string _lastErrorMessage = "";
-
 // Static method to set the one and only last error message.
 void PrinterStatus::SetLastErrorMsg(std::string msg)
 {
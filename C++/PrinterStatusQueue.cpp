@@ -22,6 +22,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <stdexcept>
@@ -59,20 +60,26 @@ int PrinterStatusQueue::GetFileDescriptor() const
 // that the next iteration processes events against the actual state of the 
 // system.  Also read out and discard the number of "eventfd events" from the
 // eventfd instance.
-EventDataVec PrinterStatusQueue::Read()
+void PrinterStatusQueue::Read(EventDataVec& eventData)
 {
-    EventDataVec eventData;
-
     uint64_t buffer;
     read(_fd, &buffer, sizeof(uint64_t));
     
+    // move the queued statuses into storage that's reused from one read to 
+    // the next, where they remain while they're being dispatched
+    size_t numDelivered = 0;
     while (!_queue.empty())
     {
-        eventData.push_back(EventData(_queue.front()));
+        if (numDelivered < _delivered.size())
+            _delivered[numDelivered] = std::move(_queue.front());
+        else
+            _delivered.push_back(std::move(_queue.front()));
         _queue.pop();
+        numDelivered++;
     }
-
-    return eventData;
+    
+    for (size_t i = 0; i < numDelivered; i++)
+        eventData.push_back(EventData(_delivered[i]));
 }
 
 // Add the specified printer status to the back of the queue and write to the
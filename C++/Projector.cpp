@@ -9,7 +9,7 @@
 //  Richard Greene
 //  Jason Lefley
 //
-//  The Projector methods EnterProgramMode, UpgradeFirmware, ReadChecksum, 
+//  The Projector methods EnterProgramMode, PrepareUpgrade, ReadChecksum, 
 //  ProgramFlash, EraseSector, and the flashSectorAddress array were  
 //  derived from "DLPC350 I2C FW load example code", 
 //  Copyright (C) 2016 Texas Instruments Incorporated - http://www.ti.com/
@@ -28,7 +28,13 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
+#include <limits.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <cmath>
 #include <iostream>
+#include <algorithm>
 
 #include "Projector.h"
 #include "I_I2C_Device.h"
@@ -45,15 +51,39 @@
 constexpr unsigned int DELAY_10_Ms  =  10000;
 constexpr unsigned int DELAY_100_Ms = 100000;
 
+// how often to check whether the projector's flash is still busy, once the 
+// delay for each flash operation to start has passed, and how long to wait 
+// for each flash operation, in microseconds
+constexpr unsigned int FLASH_POLL_INTERVAL =     1000;
+constexpr unsigned int PROGRAM_TIMEOUT     =   100000;
+constexpr unsigned int ERASE_TIMEOUT       =  1000000;
+constexpr unsigned int CHECKSUM_TIMEOUT    = 10000000;
+
 Projector::Projector(const I_I2C_Device& i2cDevice) :
 _i2cDevice(i2cDevice),
 _supportsPatternMode(false),
 _totalProgramBytes(0L),
 _programBytesWritten(0L),
-_runningChecksum(0L),
 _programmingComplete(false),
-_pFirmwareFile(NULL)
+_pFirmwareFile(NULL),
+_upgradeThreadStarted(false),
+_upgradeFailed(false),
+_cancelUpgrade(false),
+_imageID(NO_IMAGE_ID),
+_ledCurrent(0),
+_ledCurrentRevision(ULONG_MAX),
+_exposureThreadStarted(false),
+_exitExposureThread(false),
+_ledsOffMicros(0)
 {
+    pthread_mutex_init(&_exposureMutex, NULL);
+    // the exposure thread waits for times from GetMicros
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_exposureChanged, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+    
     // see if we have an I2C connection to the projector
     _canControlViaI2C = (I2CRead(PROJECTOR_HW_STATUS_REG) != ERROR_STATUS);
 
@@ -75,6 +105,15 @@ _pFirmwareFile(NULL)
             _supportsPatternMode = buf[3] == CURRENT_PROJECTOR_FW_MAJ_VERSION && 
                                    buf[2] == CURRENT_PROJECTOR_FW_MIN_VERSION;
         }
+        
+        // without this thread, exposures are still ended when the exposure 
+        // timer's event is handled, just not as precisely
+        int err = pthread_create(&_exposureThread, NULL, &ExposureThread, 
+                                 this);
+        if (err != 0)
+            Logger::LogError(LOG_ERR, err, CantStartExposureThread);
+        else
+            _exposureThreadStarted = true;
     }
 
     TurnLEDOff();
@@ -85,7 +124,9 @@ Projector::~Projector()
     // don't throw exceptions from destructor
     try
     {
+        StopUpgrade();
         TurnLEDOff();
+        StopExposureThread();
         if(_pFirmwareFile != NULL)
             fclose(_pFirmwareFile);
     }
@@ -96,15 +137,38 @@ Projector::~Projector()
 }
 
 // Sets the image for display but does not actually draw it to the screen.
-void Projector::SetImage(Magick::Image& image)
+void Projector::SetImage(Magick::Image& image, uint64_t imageID)
 {
     if (_pFrameBuffer)
     {
         _pFrameBuffer->Blit(image);
     }
+    _imageID = imageID;
+}
+
+// Prepares the currently held image for display, so that showing it needn't 
+// wait for it to be copied to the screen.  May be called from a background 
+// thread, while a previous image or black is being shown.
+void Projector::StageCurrentImage()
+{
+    if (_pFrameBuffer)
+    {
+        _pFrameBuffer->Stage();
+    }
 }
 
-// Display the currently held image.
+// Sets the LED current, if its setting has changed, ahead of the next time the
+// LEDs are turned on, so that turning them on then only requires enabling them.
+void Projector::PrepareLEDs()
+{
+    if (!_canControlViaI2C)
+        return;
+    
+    SetLEDCurrent();
+}
+
+// Display the currently held image, turning the LEDs on only once it's being 
+// scanned out.
 void Projector::ShowCurrentImage()
 {
     if (_pFrameBuffer)
@@ -114,6 +178,91 @@ void Projector::ShowCurrentImage()
     TurnLEDOn();
 }
 
+// Has the exposure thread turn off the LEDs the given number of seconds from 
+// now, ending the exposure at that time however busy this process may be 
+// then.  The LEDs still need to be turned off (by showing black) once the 
+// exposure timer's event is handled, but that's then too late to matter.
+void Projector::TurnLEDsOffAfter(double seconds)
+{
+    if (!_exposureThreadStarted)
+        return;
+    
+    uint64_t micros = seconds > 0.0 ? std::llround(seconds * 1e6) : 0;
+    
+    pthread_mutex_lock(&_exposureMutex);
+    _ledsOffMicros = GetMicros() + micros;
+    pthread_cond_signal(&_exposureChanged);
+    pthread_mutex_unlock(&_exposureMutex);
+}
+
+// Cancels any pending request for the exposure thread to turn off the LEDs.
+// Once this returns, that thread won't turn them off until asked again.
+void Projector::CancelLEDsOff()
+{
+    if (!_exposureThreadStarted)
+        return;
+    
+    pthread_mutex_lock(&_exposureMutex);
+    _ledsOffMicros = 0;
+    pthread_mutex_unlock(&_exposureMutex);
+}
+
+// Turns off the LEDs at the times requested by TurnLEDsOffAfter.
+void* Projector::ExposureThread(void* context)
+{
+    Projector* pProjector = (Projector*)context;
+    
+    // make this thread high priority, so that exposures end on time
+    pid_t tid = syscall(SYS_gettid);
+    setpriority(PRIO_PROCESS, tid, -20); 
+    
+    pthread_mutex_lock(&pProjector->_exposureMutex);
+    while (!pProjector->_exitExposureThread)
+    {
+        uint64_t ledsOffMicros = pProjector->_ledsOffMicros;
+        if (ledsOffMicros == 0)
+            pthread_cond_wait(&pProjector->_exposureChanged, 
+                              &pProjector->_exposureMutex);
+        else if (GetMicros() < ledsOffMicros)
+        {
+            timespec deadline;
+            deadline.tv_sec = ledsOffMicros / 1000000;
+            deadline.tv_nsec = (ledsOffMicros % 1000000) * 1000;
+            pthread_cond_timedwait(&pProjector->_exposureChanged, 
+                                   &pProjector->_exposureMutex, &deadline);
+        }
+        else
+        {
+            // the lock is held while turning them off, so that they can't be
+            // turned on again for another exposure before they are
+            pProjector->_ledsOffMicros = 0;
+            pProjector->I2CWrite(PROJECTOR_LED_ENABLE_REG, 
+                                 PROJECTOR_DISABLE_LEDS);
+        }
+    }
+    pthread_mutex_unlock(&pProjector->_exposureMutex);
+    
+    return NULL;
+}
+
+// Stops the exposure thread, if it's running.
+void Projector::StopExposureThread()
+{
+    if (_exposureThreadStarted)
+    {
+        pthread_mutex_lock(&_exposureMutex);
+        _exitExposureThread = true;
+        pthread_cond_signal(&_exposureChanged);
+        pthread_mutex_unlock(&_exposureMutex);
+        
+        pthread_join(_exposureThread, NULL);
+        _exposureThreadStarted = false;
+    }
+    
+    pthread_cond_destroy(&_exposureChanged);
+    pthread_mutex_destroy(&_exposureMutex);
+}
+
 // Display an all black image.
 void Projector::ShowBlack()
 {
@@ -141,38 +290,64 @@ void Projector::TurnLEDOff()
     if (!_canControlViaI2C)
         return;
  
+    CancelLEDsOff();
     I2CWrite(PROJECTOR_LED_ENABLE_REG, PROJECTOR_DISABLE_LEDS);
 }
 
-// Set the projector's LED(s) current and turn them on. Set the current every
-// time to prevent having to restart the system to observe the effects of
-// changing the LED current setting.
+// Set the projector's LED(s) current, if the setting for it has changed, and 
+// turn them on.  Checking the setting every time prevents having to restart 
+// the system to observe the effects of changing the LED current setting.
 void Projector::TurnLEDOn()
 {
     if (!_canControlViaI2C)
         return;
  
-    // set the LED current, if we have a valid setting value for it
-    int current = PrinterSettings::Instance().GetInt(PROJECTOR_LED_CURRENT);
+    // make sure the end of any earlier exposure can't turn them off again
+    CancelLEDsOff();
+    SetLEDCurrent();
+
+    I2CWrite(PROJECTOR_LED_ENABLE_REG, PROJECTOR_ENABLE_LEDS);
+}
+
+// Set the projector's LED(s) current, if we have a valid setting value for it
+// that differs from the one it was last set to.  The projector keeps the 
+// current while its LEDs are turned off, so this normally writes nothing.
+void Projector::SetLEDCurrent()
+{
+    Settings& settings = PrinterSettings::Instance();
+    if (settings.GetRevision() == _ledCurrentRevision)
+        return;     // the setting can't have changed
+    
+    _ledCurrentRevision = settings.GetRevision();
+    int current = settings.GetInt(PROJECTOR_LED_CURRENT);
     
-    if (current > 0)
+    if (current > 0 && current != _ledCurrent)
     {
-        // Set the PWM polarity.
-        // Though the PRO DLPC350 Programmer’s Guide says to set this after 
-        // setting the LED currents, it appears to need to be set first.
-        // Also, the Programmer’s Guide seems to have the 
-        // polarity backwards.
-        I2CWrite(PROJECTOR_LED_PWM_POLARITY_REG, PROJECTOR_PWM_POLARITY_NORMAL);
-        
         unsigned char c = static_cast<unsigned char>(current);
 
         // use the same value for all three LEDs
         unsigned char buf[3] = {c, c, c};
 
-        I2CWrite(PROJECTOR_LED_CURRENT_REG, buf, 3);
+        // Set the PWM polarity.
+        // Though the PRO DLPC350 Programmer’s Guide says to set this after 
+        // setting the LED currents, it appears to need to be set first.
+        // Also, the Programmer’s Guide seems to have the 
+        // polarity backwards.
+        if (I2CWrite(PROJECTOR_LED_PWM_POLARITY_REG, 
+                     PROJECTOR_PWM_POLARITY_NORMAL) &&
+            I2CWrite(PROJECTOR_LED_CURRENT_REG, buf, 3))
+            _ledCurrent = current;
+        else
+            ForgetLEDCurrent();     // try again next time
     }
+}
 
-    I2CWrite(PROJECTOR_LED_ENABLE_REG, PROJECTOR_ENABLE_LEDS);
+// Forget the LED current last set, so that it will be set again, as is needed
+// whenever the projector may have been reset or reconfigured.
+void Projector::ForgetLEDCurrent()
+{
+    _ledCurrent = 0;
+    _ledCurrentRevision = ULONG_MAX;
 }
 
 constexpr int MAX_DISABLE_GAMMA_ATTEMPTS = 5;
@@ -209,6 +384,9 @@ bool Projector::SetPatternMode()
     if (!SetVideoResolution(PATTERN_MODE_WIDTH, PATTERN_MODE_HEIGHT))
         return false;   // can't set required video resolution
 
+    // the LED current will need to be set again in the new mode
+    ForgetLEDCurrent();
+
     // stop any sequence already in progress, if any 
     // (though there should never be one, since we're in video mode)
     I2CWrite(PROJECTOR_PATTERN_START_REG, PROJECTOR_STOP_PATTERN_SEQ);
@@ -329,6 +507,9 @@ bool Projector::SetVideoMode()
 {    
     if(_canControlViaI2C)
     {
+        // the LED current will need to be set again in the new mode
+        ForgetLEDCurrent();
+        
         // exit pattern mode
         I2CWrite(PROJECTOR_DISPLAY_MODE_REG, PROJECTOR_VIDEO_MODE);
         usleep(DELAY_100_Ms);
@@ -368,7 +549,8 @@ unsigned char Projector::I2CRead(unsigned char registerAddress)
 
 // flash sectors to be erased
 // (from the LightCrafter 4500 GUI application FlashDeviceParameters.txt) 
-unsigned flashSectorAddress[71] = 
+constexpr int NUM_FLASH_SECTORS = 71;
+unsigned flashSectorAddress[NUM_FLASH_SECTORS] = 
     { 0x000000, 0x008000, 0x010000, 0x018000, 0x020000, 0x030000, 0x040000, 
       0x060000, 0x080000, 0x0A0000, 0x0C0000, 0x0E0000, 0x100000, 0x120000, 
       0x140000, 0x160000, 0x180000, 0x1A0000, 0x1C0000, 0x1E0000, 0x200000, 
@@ -388,6 +570,11 @@ bool Projector::EnterProgramMode(bool enter)
     unsigned char cmd;
     bool retVal = false;
     
+    StopUpgrade();
+    
+    // the projector will have been restarted when it next shows anything
+    ForgetLEDCurrent();
+    
     if (enter)
     {
         cmd = PROJECTOR_ENTER_PROGRAM_MODE;  
@@ -396,7 +583,6 @@ bool Projector::EnterProgramMode(bool enter)
         // to the boot-loader program
         _totalProgramBytes = 0L; 
         _programBytesWritten = 0L;
-        _runningChecksum = 0L; 
         _programmingComplete = false;
     }
     else
@@ -422,231 +608,285 @@ double Projector::GetUpgradeProgress()
 }
 
 
-// This is called repeatedly, until programming is complete.  It assumes the
-// projector is already in Program Mode. 
+// Starts upgrading the firmware on a separate thread the first time it's 
+// called, and then just reports whether or not the upgrade is still going 
+// well.  The progress is available from GetUpgradeProgress(), and 
+// ProgrammingComplete() becomes true once the upgrade has been verified.
+// It assumes the projector is already in Program Mode. 
 bool Projector::UpgradeFirmware()
 {     
-    unsigned char wr_buf[256];
+    if (_upgradeThreadStarted)
+        return !_upgradeFailed;
+    
+    if (!PrepareUpgrade())
+        return false;
+    
+    _upgradeFailed = false;
+    _cancelUpgrade = false;
+    int err = pthread_create(&_upgradeThread, NULL, &UpgradeThread, this);
+    if (err != 0)
+    {
+        Logger::LogError(LOG_ERR, err, CantStartProjectorUpgradeThread);
+        return false;
+    }
+    _upgradeThreadStarted = true;
+    
+    return true;
+}
+
+// Opens the firmware file and checks that the projector is one we know how to
+// upgrade.
+bool Projector::PrepareUpgrade()
+{
     unsigned char rd_buf[256];
     
-    if(_totalProgramBytes == 0L)  // first stage
+    // open the firmware binary file 
+    if (_pFirmwareFile != NULL)
+        fclose(_pFirmwareFile);
+    _pFirmwareFile = fopen(PROJECTOR_FW_FILE, "rb");
+    if (_pFirmwareFile == NULL)
     {
-        // open the firmware binary file 
-        _pFirmwareFile = fopen(PROJECTOR_FW_FILE, "rb");
-        if (_pFirmwareFile == NULL)
-        {
-            Logger::LogError(LOG_ERR, errno, CantOpenProjectorFwFile, 
-                                                            PROJECTOR_FW_FILE);
-            return false;
-        }
+        Logger::LogError(LOG_ERR, errno, CantOpenProjectorFwFile, 
+                                                        PROJECTOR_FW_FILE);
+        return false;
+    }
 
-        // request the Manufacturer's ID
-        unsigned char cmd = PROJECTOR_GET_MFR_ID; 
-        if(!I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, &cmd, 1, &rd_buf[0], 10))
-        {
-            Logger::LogError(LOG_ERR, errno, CantReadProjectorMfrID);
-            return false;
-        }    
-        usleep(DELAY_10_Ms);
-        int mfrID = 
-               (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
-        if (mfrID != SUPPORTED_PROJECTOR_MFR_ID) 
-        {
-            Logger::LogError(LOG_ERR, errno, UnknownProjectorMfrID, mfrID);
-            return false;
-        }
+    // request the Manufacturer's ID
+    unsigned char cmd = PROJECTOR_GET_MFR_ID; 
+    if(!I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, &cmd, 1, &rd_buf[0], 10))
+    {
+        Logger::LogError(LOG_ERR, errno, CantReadProjectorMfrID);
+        return false;
+    }    
+    usleep(DELAY_10_Ms);
+    int mfrID = 
+           (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
+    if (mfrID != SUPPORTED_PROJECTOR_MFR_ID) 
+    {
+        Logger::LogError(LOG_ERR, errno, UnknownProjectorMfrID, mfrID);
+        return false;
+    }
 
-        // request the Device ID
-        cmd = PROJECTOR_GET_DEVICE_ID; 
-        if (!I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, &cmd, 1, rd_buf, 10))
-        {
-            Logger::LogError(LOG_ERR, errno, CantReadProjectorDeviceID);
-            return false;
-        }
-        usleep(DELAY_10_Ms);
-        int deviceID = 
-               (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
-        if (deviceID != SUPPORTED_PROJECTOR_DEVICE_ID)
-        {
-            Logger::LogError(LOG_ERR, errno, UnknownProjectorDeviceID, deviceID);
-            return false;
-        }
+    // request the Device ID
+    cmd = PROJECTOR_GET_DEVICE_ID; 
+    if (!I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, &cmd, 1, rd_buf, 10))
+    {
+        Logger::LogError(LOG_ERR, errno, CantReadProjectorDeviceID);
+        return false;
+    }
+    usleep(DELAY_10_Ms);
+    int deviceID = 
+           (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
+    if (deviceID != SUPPORTED_PROJECTOR_DEVICE_ID)
+    {
+        Logger::LogError(LOG_ERR, errno, UnknownProjectorDeviceID, deviceID);
+        return false;
+    }
 
-        // find the size of the binary file
-        fseek(_pFirmwareFile, 0L, SEEK_END);
-        _totalProgramBytes = ftell(_pFirmwareFile);
+    // find the size of the binary file, less the 128k bootloader, which 
+    // isn't programmed
+    fseek(_pFirmwareFile, 0L, SEEK_END);
+    long fileSize = ftell(_pFirmwareFile);
+    if (fileSize <= (long)APP_START_ADDR)
+    {
+        Logger::LogError(LOG_ERR, errno, CantReadProjectorFwFile, 
+                                                        PROJECTOR_FW_FILE);
+        return false;
+    }
+    _totalProgramBytes = fileSize - APP_START_ADDR; 
+    _programBytesWritten = 0;
+    
+    return true;
+}
 
-        // erase sectors  
-        int i = 0;
-        while(_totalProgramBytes > flashSectorAddress[i])
-        {
-            // but skip the bootloader area
-            if (flashSectorAddress[i] >= APP_START_ADDR)
-            {
-                int tries = 0;
-                while(!EraseSector(flashSectorAddress[i]))
-                {
-                    // try up to 10 times to erase each sector
-                    if(++tries > 10)
-                    {
-                        Logger::LogError(LOG_ERR, errno, 
-                               CantEraseProjectorSector, flashSectorAddress[i]);
-                        return false;
-                    }
-                }
-            }
-            i++;
-        }
+// Runs the upgrade on its own thread, so that the rest of the system (such as
+// the front panel's progress indicator) stays responsive while it's going on.
+void* Projector::UpgradeThread(void* context)
+{
+    Projector* pProjector = (Projector*)context;
 
-        // set file pointer to beginning
-        fseek(_pFirmwareFile, 0L, SEEK_SET);
-        // point to the beginning of the main application,
-        // skipping the 128k boot loader area
-        fseek(_pFirmwareFile, APP_START_ADDR, SEEK_SET);
-
-        // likewise, set the projector's start address to that position 
-        wr_buf[0] =  APP_START_ADDR & 0xFF;
-        wr_buf[1] = (APP_START_ADDR & 0xFF00)   >> 8;
-        wr_buf[2] = (APP_START_ADDR & 0xFF0000) >> 16;
-        wr_buf[3] = 0x00;
-        _i2cDevice.Write(PROJECTOR_START_ADDRESS_REG, wr_buf, 4);
-        usleep(DELAY_10_Ms);
-
-        // number of bytes to be written is less the 128k bootloader  
-        _totalProgramBytes -= APP_START_ADDR; 
-
-        // set download data size 
-        wr_buf[0] =  _totalProgramBytes & 0xFF;
-        wr_buf[1] = (_totalProgramBytes & 0xFF00)   >> 8;
-        wr_buf[2] = (_totalProgramBytes & 0xFF0000) >> 16;
-        wr_buf[3] = 0x00;
-        _i2cDevice.Write(PROJECTOR_DATA_SIZE_REG, wr_buf, 4);
-
-        _runningChecksum = 0x00;
-        _programBytesWritten = 0;
-        return true;   // first stage complete
-    }
-    else if (_programBytesWritten < _totalProgramBytes) // middle stage
-    {
-        // loop here so that we only occasionally incur the overhead of 
-        // updating progress, since the LED ring doesn't provide 
-        // many progress increments anyway
-        for(int i = 0; i < 150; i++)
+    if (pProjector->ProgramFirmware())
+        pProjector->_programmingComplete = true;
+    else
+        pProjector->_upgradeFailed = true;
+    
+    fclose(pProjector->_pFirmwareFile);
+    pProjector->_pFirmwareFile = NULL;
+    
+    return NULL;
+}
+
+// Programs the firmware as in TI's example code for the DLPC350: erasing all 
+// the application's flash sectors, then setting the flash range once, for 
+// the whole application, and downloading it in PROJECTOR_FLASH_CHUNK_SIZE 
+// writes, and finally verifying the checksum of the whole range.  Returns 
+// false if any of those fail, or the upgrade was cancelled.
+bool Projector::ProgramFirmware()
+{
+    unsigned long int endAddress = APP_START_ADDR + _totalProgramBytes;
+    
+    for (int i = 0; i < NUM_FLASH_SECTORS && 
+                    flashSectorAddress[i] < endAddress; i++)
+    {
+        // skip the bootloader area
+        if (flashSectorAddress[i] < APP_START_ADDR)
+            continue;
+        
+        if (_cancelUpgrade)
+            return false;
+        
+        int tries = 0;
+        while(!EraseSector(flashSectorAddress[i]))
         {
-            // check if this is the last transaction
-            if ((_totalProgramBytes - _programBytesWritten) <= 256)
+            // try up to 10 times to erase each sector
+            if(++tries > 10)
             {
-                // read the remaining data from the file
-                fread(rd_buf, sizeof(unsigned char), 
-                                    _totalProgramBytes - _programBytesWritten, 
-                                    _pFirmwareFile);
-                // write the remaining number of bytes
-                ProgramFlash(rd_buf, _totalProgramBytes - _programBytesWritten);
-                // compute the checksum for last chunk 
-                _runningChecksum += Checksum(rd_buf, 
-                                     _totalProgramBytes - _programBytesWritten);
-                _programBytesWritten = _totalProgramBytes;
-                fclose(_pFirmwareFile);
-                _pFirmwareFile = NULL;
-                break;
-            }
-            else
-            {                   
-                // read from the binary file, 256 bytes at a time
-                fread(rd_buf, sizeof(unsigned char), 256, _pFirmwareFile);
-                // program the flash 256 bytes at a time
-                ProgramFlash(rd_buf, 256); 
-                _programBytesWritten += 256;
-                _runningChecksum += Checksum(rd_buf, 256);
+                Logger::LogError(LOG_ERR, errno, CantEraseProjectorSector, 
+                                                        flashSectorAddress[i]);
+                return false;
             }
         }
-        return true;
     }
-    else    // final stage
+    
+    // point to the beginning of the main application, skipping the 128k 
+    // boot loader area, in both the file and the projector's flash
+    if (fseek(_pFirmwareFile, APP_START_ADDR, SEEK_SET) != 0)
     {
-        // get the checksum calculated by the projector
-        unsigned long int actualChecksum = 
-                               ReadChecksum(APP_START_ADDR, _totalProgramBytes);
-        if (actualChecksum != _runningChecksum)
+        Logger::LogError(LOG_ERR, errno, CantReadProjectorFwFile, 
+                                                        PROJECTOR_FW_FILE);
+        return false;
+    }
+    SetFlashRange(APP_START_ADDR, _totalProgramBytes);
+    
+    unsigned char data[PROJECTOR_FLASH_CHUNK_SIZE];
+    unsigned long int expectedChecksum = 0;
+    while (_programBytesWritten < _totalProgramBytes)
+    {
+        if (_cancelUpgrade)
+            return false;
+        
+        unsigned long int chunk = std::min(
+                              _totalProgramBytes - _programBytesWritten, 
+                              (unsigned long int)PROJECTOR_FLASH_CHUNK_SIZE);
+        if (fread(data, sizeof(unsigned char), chunk, _pFirmwareFile) != chunk)
         {
-            Logger::LogError(LOG_ERR, errno, UnexpectedChecksum, actualChecksum);
+            Logger::LogError(LOG_ERR, errno, CantReadProjectorFwFile, 
+                                                        PROJECTOR_FW_FILE);
             return false;
-        } 
-        else
-            _programmingComplete = true;
+        }
+        
+        if (!ProgramFlash(data, chunk))
+            return false;
+        
+        expectedChecksum += Checksum(data, chunk);
+        _programBytesWritten += chunk;
     }
-    return true;  
+    
+    unsigned long int actualChecksum = ReadChecksum(APP_START_ADDR, 
+                                                    _totalProgramBytes);
+    if (actualChecksum != expectedChecksum)
+    {
+        Logger::LogError(LOG_ERR, errno, UnexpectedChecksum, actualChecksum);
+        return false;
+    }
+    
+    return true;
 }
 
+// Cancels any upgrade in progress and waits for its thread to exit.
+void Projector::StopUpgrade()
+{
+    if (!_upgradeThreadStarted)
+        return;
+    
+    _cancelUpgrade = true;
+    pthread_join(_upgradeThread, NULL);
+    _upgradeThreadStarted = false;
+}
 
-// Read the checksum for the given area in the projector's flash memory
-unsigned long int Projector::ReadChecksum(unsigned long int startAddress, 
-                                          unsigned long int numBytes)
+// Sets the area of the projector's flash memory on which the next flash 
+// command operates.
+void Projector::SetFlashRange(unsigned long int startAddress, 
+                              unsigned long int numBytes)
 {
-    int timeout = 0;
-    unsigned char wr_buf[256];
-    unsigned char rd_buf[256];
+    unsigned char wr_buf[4];
 
-    //Set start address
+    // set start address
     wr_buf[0] =  startAddress & 0xFF;
     wr_buf[1] = (startAddress & 0xFF00)   >> 8;
     wr_buf[2] = (startAddress & 0xFF0000) >> 16;
     wr_buf[3] = 0x00;
     _i2cDevice.Write(PROJECTOR_START_ADDRESS_REG, wr_buf, 4);
     usleep(DELAY_10_Ms);
-    //Set number of bytes for checksum calculation 
+    
+    // set number of bytes
     wr_buf[0] =  numBytes & 0xFF;
     wr_buf[1] = (numBytes & 0xFF00)   >> 8;
     wr_buf[2] = (numBytes & 0xFF0000) >> 16;
     wr_buf[3] = 0x00;
     _i2cDevice.Write(PROJECTOR_DATA_SIZE_REG, wr_buf, 4);
     usleep(DELAY_10_Ms);
+}
 
-    // issue checksum compute command
-    wr_buf[0] = 0x01;
-    _i2cDevice.Write(PROJECTOR_CALCULATE_CHECKSUM_REG, wr_buf, 1);
-    usleep(DELAY_100_Ms);
-
-    // poll for checksum computation completion 
-    while(1)
+// Waits the given settle time for the projector to start the flash command 
+// just sent (and raise its busy flag), then polls it until its flash is no 
+// longer busy, for up to the given timeout (both in microseconds).  Returns 
+// false if it's still busy by then.
+bool Projector::AwaitFlashReady(unsigned int settleTime, unsigned int timeout)
+{
+    usleep(settleTime);
+    
+    uint64_t deadline = GetMicros() + timeout;
+    while (true)
     {
         unsigned char status = _i2cDevice.Read(PROJECTOR_READ_CONTROL_REG);
-        usleep(DELAY_10_Ms);
+        if ((status & FLASH_BUSY_STATUS) == 0)
+            return true;
 
-        if(status & FLASH_BUSY_STATUS) 
-        {
-            // flash access busy
-            timeout++;
-            // wait up to 10 seconds 
-            if(timeout >= 1000)
-                return -1;
-        }
-        else
-        {
-            // checksum calculation complete, read its value
-            wr_buf[0] = PROJECTOR_GET_CHECKSUM;
-            I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, wr_buf, 1, rd_buf, 10);
-            usleep(DELAY_10_Ms);
-            //BYTE0 BYTE1 BYTE2 BYTE3 BYTE4 BYTE5 []BYTE6 BYTE7 BYTE8 BYTE9]  Checksum [xx xx xx xx] [LSB .. .. MSB] BYTE6 - BYTE9 return checksum
-            //checksum = BYTE9<<24 | BYTE8<<16 | BYTE7<<8 | BYTE6
-            return (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
-        }
+        if (GetMicros() >= deadline)
+            return false;
+
+        usleep(FLASH_POLL_INTERVAL);
     }
 }
 
-// Program flash with data provided from the given buffer
-void Projector::ProgramFlash(unsigned char *buf, unsigned int numBytes)
+// Read the checksum for the given area in the projector's flash memory
+unsigned long int Projector::ReadChecksum(unsigned long int startAddress, 
+                                          unsigned long int numBytes)
+{
+    unsigned char wr_buf[256];
+    unsigned char rd_buf[256];
+
+    SetFlashRange(startAddress, numBytes);
+
+    // issue checksum compute command
+    wr_buf[0] = 0x01;
+    _i2cDevice.Write(PROJECTOR_CALCULATE_CHECKSUM_REG, wr_buf, 1);
+
+    // wait up to 10 seconds for checksum computation completion 
+    if (!AwaitFlashReady(DELAY_100_Ms, CHECKSUM_TIMEOUT))
+        return -1;
+    
+    // checksum calculation complete, read its value
+    wr_buf[0] = PROJECTOR_GET_CHECKSUM;
+    I2CWriteAndRead(PROJECTOR_READ_CONTROL_REG, wr_buf, 1, rd_buf, 10);
+    //BYTE0 BYTE1 BYTE2 BYTE3 BYTE4 BYTE5 []BYTE6 BYTE7 BYTE8 BYTE9]  Checksum [xx xx xx xx] [LSB .. .. MSB] BYTE6 - BYTE9 return checksum
+    //checksum = BYTE9<<24 | BYTE8<<16 | BYTE7<<8 | BYTE6
+    return (rd_buf[9] << 24 | rd_buf[8] << 16 | rd_buf[7] << 8 | rd_buf[6]);
+}
+
+// Program flash with data provided from the given buffer, waiting for the 
+// flash to be no longer busy.  Returns false if it stays busy.
+bool Projector::ProgramFlash(const unsigned char *buf, unsigned int numBytes)
 {
     _i2cDevice.Write(PROJECTOR_DOWNLOAD_DATA_REG, buf, numBytes);
-    usleep(DELAY_10_Ms);
+    return AwaitFlashReady(DELAY_10_Ms, PROGRAM_TIMEOUT);
 }
 
 /* Function: Erase the flash sector depending upon the user provided sector address */
 bool Projector::EraseSector(unsigned long sectorAddress)
 {
-    int timeout = 0;
     unsigned char wr_buf[4];
-    unsigned char rd_buf[4];
 
     wr_buf[0] =  sectorAddress & 0xFF;
     wr_buf[1] = (sectorAddress & 0xFF00)   >> 8;
@@ -657,28 +897,9 @@ bool Projector::EraseSector(unsigned long sectorAddress)
 
     wr_buf[0] = 0x01;
     _i2cDevice.Write(PROJECTOR_ERASE_SECTOR_REG, wr_buf, 1);
-    usleep(DELAY_10_Ms);
-
-    while(1)
-    {
-        unsigned char status = _i2cDevice.Read(PROJECTOR_READ_CONTROL_REG);
 
-        usleep(DELAY_10_Ms);
-
-        if(status & FLASH_BUSY_STATUS) 
-        {
-            // flash access busy
-            timeout++;
-            // wait up to 1 second 
-            if(timeout >= 100)
-                return false;
-        }
-        else
-        {
-            // erased a sector
-            return true;
-        }
-    }
+    // wait up to 1 second for the sector to be erased
+    return AwaitFlashReady(DELAY_10_Ms, ERASE_TIMEOUT);
 }
 
 bool Projector::I2CWriteAndRead(unsigned char regAddress, 
@@ -0,0 +1,103 @@
+//  File:   ScanoutBuffers.cpp
+//  Stages, swaps, and fills layer images in a set of scan-out buffers
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <Magick++.h>
+
+#include <ScanoutBuffers.h>
+
+// Starts with black displayed.  The buffers themselves are provided by the 
+// derived class, with SetBuffers, once it has set them up.
+ScanoutBuffers::ScanoutBuffers(int width, int height) :
+_width(width),
+_height(height),
+_pFormat(NULL),
+_pitch(0),
+_displayed(BLACK_BUFFER),
+_staging(0),
+_staged(false),
+_image(width * height)
+{
+    for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
+        _pBuffers[i] = NULL;
+}
+
+// Sets the buffers to be staged, filled, and displayed, holding pixels in the
+// given format, with rows the given number of bytes apart.
+void ScanoutBuffers::SetBuffers(const ScanoutFormat& format, int pitch,
+                                uint8_t* const pBuffers[NUM_SCANOUT_BUFFERS])
+{
+    _pFormat = &format;
+    _pitch = pitch;
+    for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
+        _pBuffers[i] = pBuffers[i];
+}
+
+// Copies the green channel from the specified image into an auxiliary buffer
+// but does not display the result.
+void ScanoutBuffers::Blit(Magick::Image& image)
+{
+    image.write(0, 0, _width, _height, "G", Magick::CharPixel, _image.data());
+    _staged = false;
+}
+
+void ScanoutBuffers::Fill(uint8_t value)
+{
+    if (value == 0x00)
+    {
+        Show(BLACK_BUFFER);
+        return;
+    }
+    
+    FillGray(*_pFormat, value, _width, _height, _pBuffers[_staging], _pitch);
+    _staged = false;
+    Show(_staging);
+    _staging = 1 - _staging;
+}
+
+// Copies the image into the staging buffer, in the scan-out format.
+void ScanoutBuffers::Stage()
+{
+    if (_staged)
+        return;
+    
+    WriteGrayImage(*_pFormat, _image.data(), _width, _height, 
+                   _pBuffers[_staging], _pitch);
+    _staged = true;
+}
+
+void ScanoutBuffers::Swap()
+{
+    Stage();
+    Show(_staging);
+    
+    // the next image is staged in the other image buffer, which holds an
+    // older image
+    _staging = 1 - _staging;
+    _staged = false;
+}
+
+void ScanoutBuffers::Show(int buffer)
+{
+    Display(buffer);
+    _displayed = buffer;
+}
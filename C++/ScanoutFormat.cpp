@@ -0,0 +1,87 @@
+//  File:   ScanoutFormat.cpp
+//  Pixel formats in which layer images can be scanned out to the projector
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include <algorithm>
+
+#include <ScanoutFormat.h>
+
+// Returns the RGB565 pixel for the gray of the given intensity.
+static inline uint16_t Rgb565(uint8_t value)
+{
+    return ((value >> 3) << 11) | // red
+           ((value >> 2) << 5)  | // green
+            (value >> 3);         // blue
+}
+
+// Writes the given 8-bit gray image into a buffer holding pixels in the given
+// format, with rows the given number of bytes apart.  An indexed color buffer
+// is assumed to have a palette mapping each intensity to its gray.
+void WriteGrayImage(const ScanoutFormat& format, const uint8_t* pImage,
+                    int width, int height, uint8_t* pBuffer, int pitch)
+{
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* pRow = &pImage[width * y];
+        uint8_t* pLine = &pBuffer[pitch * y];
+        
+        switch (format.bitsPerPixel)
+        {
+            case 8:
+                std::memcpy(pLine, pRow, width);
+                break;
+                
+            case 16:
+                for (int x = 0; x < width; x++)
+                    ((uint16_t*)pLine)[x] = Rgb565(pRow[x]);
+                break;
+                
+            default:
+                for (int x = 0; x < width; x++)
+                {
+                    uint8_t value = pRow[x];
+                    ((uint32_t*)pLine)[x] = (value << 16) | // red
+                                            (value << 8)  | // green
+                                             value;         // blue
+                }
+                break;
+        }
+    }
+}
+
+// Fills a buffer holding pixels in the given format with the gray of the 
+// given intensity.
+void FillGray(const ScanoutFormat& format, uint8_t value, int width, 
+              int height, uint8_t* pBuffer, int pitch)
+{
+    if (format.bitsPerPixel != 16)
+    {
+        // every byte of a gray pixel (but the unused one in XRGB8888) holds 
+        // its intensity
+        std::memset(pBuffer, value, pitch * height);
+        return;
+    }
+    
+    for (int y = 0; y < height; y++)
+        std::fill_n((uint16_t*)&pBuffer[pitch * y], width, Rgb565(value));
+}
@@ -68,11 +68,14 @@ void ScreenLine::Draw(IDisplay* pDisplay)
     pDisplay->ShowText(_align, _x, _y, _size, _color, _text.c_str());
 }
 
-// Constructor, just calls base type
+// Constructor for a line whose text can be replaced.  If given a line ID, 
+// the replaced text is updated in place, for lines whose text changes 
+// without the screen being cleared.
 ReplaceableLine::ReplaceableLine(Alignment align, unsigned char x, 
                                  unsigned char y, unsigned char size, int color,
-                                 std::string text) :
-ScreenLine(align, x, y, size, color, text)                                 
+                                 std::string text, int lineID) :
+ScreenLine(align, x, y, size, color, text),
+_lineID(lineID)
 {
 }
 
@@ -88,7 +91,11 @@ void ReplaceableLine::ReplaceWith(std::string replacement)
 // Draw the replaced line of text on a display.
 void ReplaceableLine::Draw(IDisplay* pDisplay)
 {
-    pDisplay->ShowText(_align, _x, _y, _size, _color, _replacedText);
+    if (_lineID == NO_LINE_ID)
+        pDisplay->ShowText(_align, _x, _y, _size, _color, _replacedText);
+    else
+        pDisplay->UpdateText(_lineID, _align, _x, _y, _size, _color, 
+                             _replacedText);
 }
 
 // Destructor deletes the contained ScreenLines.
@@ -269,11 +276,10 @@ _previousTime("")
 // Overrides base type to show the print time remaining and percent completion 
 void PrintStatusScreen::Draw(IDisplay* pDisplay, PrinterStatus* pStatus)
 {
-    // look for the ScreenLines with replaceable text
-    ReplaceableLine* eraseLine = _pScreenText->GetReplaceable(1);
-    ReplaceableLine* timeLine = _pScreenText->GetReplaceable(2);
+    // look for the ScreenLine with replaceable text
+    ReplaceableLine* timeLine = _pScreenText->GetReplaceable(1);
     
-    if (eraseLine != NULL && timeLine != NULL)
+    if (timeLine != NULL)
     {      
         // get and format the remaining time (rounded to nearest minute))
         int roundingTime = pStatus->_estimatedSecondsRemaining + 30;
@@ -290,9 +296,8 @@ void PrintStatusScreen::Draw(IDisplay* pDisplay, PrinterStatus* pStatus)
         if (_previousTime.compare(time) != 0 || pDisplay->_forceDisplay)
         {
             pDisplay->_forceDisplay = false;
-            // erase the time already showing
-            eraseLine->ReplaceWith(_previousTime);
-            // insert the remaining time
+            // insert the remaining time, which replaces the time already 
+            // showing in place
             timeLine->ReplaceWith(time);
             // and record the change
             _previousTime = time;
@@ -114,10 +114,8 @@ void ScreenBuilder::BuildScreens(std::map<PrinterStatusKey, Screen*>& screenMap)
     
     // the next screen adds the remaining print time to print status
     ScreenText* countdown = new ScreenText;
-    // clear the previously shown time
-    countdown->Add(new ReplaceableLine(PRINTING_CLEAR_LINE3));
-    // show the new remaining print time
-    countdown->Add(new ReplaceableLine(PRINTING_LINE3));
+    // show the new remaining print time in place of the previous one
+    countdown->Add(new ReplaceableLine(PRINTING_LINE3, PRINTING_TIME_LINE_ID));
     screenMap[Key(InitializingLayerState, NoUISubState)] = 
             new PrintStatusScreen(countdown, NO_LED_SEQ);  
     
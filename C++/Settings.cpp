@@ -21,6 +21,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <string.h>
 #include <libgen.h>
 #include <exception>
@@ -48,7 +49,8 @@
 // Constructor.
 Settings::Settings(const std::string& path) :
 _settingsPath(path),
-_errorHandler(NULL)
+_errorHandler(NULL),
+_revision(0)
 {
     // The default values of all settings are defined here.
     // Printer settings are common to all prints.
@@ -93,6 +95,8 @@ _errorHandler(NULL)
             "\"" << IMAGE_SCALE_FACTOR     << "\": 1.0," <<
             "\"" << PAT_MODE_SCALE_FACTOR  << "\": 1.0," <<
             "\"" << USB_DRIVE_DATA_DIR     << "\": \"/EmberUSB\"," << 
+            "\"" << STATUS_COALESCE_MS     << "\": 200," <<
+            "\"" << EVENT_CALLBACK_BUDGET  << "\": 250," <<
             "\"" << FW_VERSION             << "\": \"\""; 
     
 
@@ -111,8 +115,21 @@ _errorHandler(NULL)
             "\"" << MODEL_EXPOSURE         << "\": 2.5," <<
             
             "\"" << HOME_ON_APPROACH       << "\": 0," <<
+            "\"" << COORDINATED_MOTION     << "\": 0," <<
             "\"" << USE_PATTERN_MODE       << "\": 0," <<
             
+            "\"" << ADAPTIVE_MOTION        << "\": 0," <<
+            "\"" << ADAPTIVE_SMALL_AREA    << "\": 5.0," <<
+            "\"" << ADAPTIVE_LARGE_AREA    << "\": 25.0," <<
+            "\"" << ADAPTIVE_SPEED_FACTOR  << "\": 2.0," <<
+            "\"" << ADAPTIVE_MAX_ISLANDS   << "\": 50," <<
+            
+            "\"" << ADAPTIVE_EXPOSURE      << "\": 0," <<
+            "\"" << ADAPTIVE_SOLID_EDGE    << "\": 5.0," <<
+            "\"" << ADAPTIVE_THIN_EDGE     << "\": 50.0," <<
+            "\"" << ADAPTIVE_MIN_EXPOSURE  << "\": 0.9," <<
+            "\"" << ADAPTIVE_MAX_EXPOSURE  << "\": 1.1," <<
+            
             "\"" << FL_SEPARATION_R_JERK   << "\": 100000," <<
             "\"" << FL_SEPARATION_R_SPEED  << "\": 6," <<
             "\"" << FL_APPROACH_R_JERK     << "\": 100000," <<
@@ -262,6 +279,7 @@ bool Settings::Load(const std::string& filename, bool initializing)
         FileReadStream frs2(pFile, buf, LOAD_BUF_LEN);
         _settingsDoc.ParseStream(frs2);
         fclose(pFile);  
+        _revision++;
         
         if (initializing && missing.size() > 0)
         {
@@ -269,9 +287,13 @@ bool Settings::Load(const std::string& filename, bool initializing)
             for (std::vector<std::string>::iterator it = missing.begin(); 
                                                     it != missing.end(); ++it)
             {
-                _settingsDoc[SETTINGS_ROOT_KEY].AddMember(StringRef(it->c_str()), 
-                        defaultDoc[SETTINGS_ROOT_KEY][StringRef(it->c_str())], 
-                        _settingsDoc.GetAllocator());
+                // copy the name and the default value, since neither the 
+                // missing names nor the default document outlive this method
+                Value name(it->c_str(), _settingsDoc.GetAllocator());
+                Value value(defaultDoc[SETTINGS_ROOT_KEY][it->c_str()], 
+                            _settingsDoc.GetAllocator());
+                _settingsDoc[SETTINGS_ROOT_KEY].AddMember(name, value, 
+                                                _settingsDoc.GetAllocator());
             }
             Save();
         }              
@@ -340,6 +362,7 @@ bool Settings::SetFromJSONString(const std::string& str)
                 _settingsDoc[SETTINGS_ROOT_KEY][name] = 
                                                 doc[SETTINGS_ROOT_KEY][name];
         }
+        _revision++;
         Save();
         retVal = true;
     }
@@ -413,6 +436,7 @@ void Settings::RestoreAll()
     try
     {
         _settingsDoc.Parse(_defaultJSON.c_str()); 
+        _revision++;
 
         Save();     
     }
@@ -432,6 +456,7 @@ void Settings::Restore(const std::string key)
         
         _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())] = 
                          defaultsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())];
+        _revision++;
         Save();
     }
     else
@@ -460,6 +485,7 @@ bool Settings::RestoreAllPrintSettings()
             _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key)] = 
                          defaultsDoc[SETTINGS_ROOT_KEY][StringRef(key)];
         }
+        _revision++;
         Save();
         return true;
     }
@@ -487,7 +513,8 @@ void Settings::Set(const std::string key, const std::string value)
             Value s;
             s.SetString(value.c_str(), value.length(), 
                                                 _settingsDoc.GetAllocator());
-            _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())] =  s;           
+            _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())] =  s;
+            _revision++;
         }
         else
             HandleError(UnknownSetting, true, key.c_str());
@@ -503,7 +530,10 @@ void Settings::Set(const std::string key, int value)
     try
     {
         if (IsValidSettingName(key))
+        {
             _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())] =  value;
+            _revision++;
+        }
         else
             HandleError(UnknownSetting, true, key.c_str());
     }
@@ -518,7 +548,10 @@ void Settings::Set(const std::string key, double value)
     try
     {
         if (IsValidSettingName(key))
+        {
             _settingsDoc[SETTINGS_ROOT_KEY][StringRef(key.c_str())] =  value;
+            _revision++;
+        }
         else
             HandleError(UnknownSetting, true, key.c_str());
     }
@@ -72,17 +72,14 @@ int Signals::GetFileDescriptor() const
 
 // Read information about the signals triggering the event
 // Send out data as strings for consistency with other resource data
-EventDataVec Signals::Read()
+void Signals::Read(EventDataVec& eventData)
 {
     signalfd_siginfo fdsi;
-    EventDataVec eventData;
 
     if (read(_fd, &fdsi, _dataSize) == _dataSize)
     {
         eventData.push_back(EventData(fdsi.ssi_signo));
     }
-
-    return eventData;
 }
 
 bool Signals::QualifyEvents(uint32_t events) const
@@ -46,13 +46,10 @@ int StandardIn::GetFileDescriptor() const
 }
 
 // Reading from this resource returns a single line
-EventDataVec StandardIn::Read()
+void StandardIn::Read(EventDataVec& eventData)
 {
-    std::string line;
-    std::getline(std::cin, line);
-    EventDataVec eventData;
-    eventData.push_back(EventData(line));
-    return eventData;
+    std::getline(std::cin, _line);
+    eventData.push_back(EventData(_line));
 }
 
 bool StandardIn::QualifyEvents(uint32_t events) const
@@ -0,0 +1,188 @@
+//  File:   StatusPage.cpp
+//  Publishes printer status in a shared memory page that local clients can 
+//  poll without system calls or parsing
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include <StatusPage.h>
+#include <Logger.h>
+
+// number of times a reader will retry copying a page that's being written
+constexpr int MAX_STATUS_PAGE_READ_TRIES = 100;
+
+// Copy a string into a fixed length field, always null-terminating it.
+static void CopyField(char* field, const std::string& str, size_t fieldLen)
+{
+    size_t len = str.copy(field, fieldLen - 1);
+    field[len] = '\0';
+}
+
+// Constructor, creates the named shared memory status page, readable by other
+// processes.
+StatusPage::StatusPage(const char* name) :
+_name(name),
+_pPage(NULL)
+{
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        throw std::runtime_error(ErrorMessage::Format(StatusPageCreate, errno));
+
+    if (ftruncate(fd, sizeof(StatusPageData)) < 0)
+    {
+        close(fd);
+        throw std::runtime_error(ErrorMessage::Format(StatusPageCreate, errno));
+    }
+    
+    void* pMap = mmap(NULL, sizeof(StatusPageData), PROT_READ | PROT_WRITE, 
+                      MAP_SHARED, fd, 0);
+    // the mapping remains valid after the descriptor is closed
+    close(fd);
+    if (pMap == MAP_FAILED)
+        throw std::runtime_error(ErrorMessage::Format(StatusPageCreate, errno));
+    
+    _pPage = static_cast<StatusPageData*>(pMap);
+    
+    // start with an empty status, but keep the sequence number increasing 
+    // (and odd while the page is cleared), in case readers were already 
+    // polling a page from an earlier run
+    uint32_t sequence = _pPage->sequence & ~1u;
+    __atomic_store_n(&_pPage->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    char* pPage = reinterpret_cast<char*>(_pPage);
+    size_t afterSequence = offsetof(StatusPageData, sequence) + 
+                           sizeof(_pPage->sequence);
+    memset(pPage, 0, offsetof(StatusPageData, sequence));
+    memset(pPage + afterSequence, 0, sizeof(StatusPageData) - afterSequence);
+    _pPage->magic = STATUS_PAGE_MAGIC;
+    _pPage->version = STATUS_PAGE_VERSION;
+    
+    __atomic_store_n(&_pPage->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Destructor leaves the page in place, so readers still see the last status.
+StatusPage::~StatusPage()
+{
+    munmap(_pPage, sizeof(StatusPageData));
+}
+
+// Handle printer status updates
+void StatusPage::Callback(EventType eventType, const EventData& data)
+{
+    switch(eventType)
+    {
+        case PrinterStatusUpdate:
+            Write(data.Get<PrinterStatus>());
+            break;
+            
+        default:
+            Logger::LogError(LOG_WARNING, errno, UnexpectedEvent, eventType);
+            break;
+    }
+}
+
+// Copy the given status into the page, making the sequence number odd while 
+// the page is being changed.
+void StatusPage::Write(const PrinterStatus& status)
+{
+    uint32_t sequence = __atomic_load_n(&_pPage->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&_pPage->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    _pPage->state = status._state;
+    _pPage->change = status._change;
+    _pPage->UISubState = status._UISubState;
+    _pPage->isError = status._isError;
+    _pPage->errorCode = status._errorCode;
+    _pPage->errnum = status._errno;
+    _pPage->numLayers = status._numLayers;
+    _pPage->currentLayer = status._currentLayer;
+    _pPage->estimatedSecondsRemaining = status._estimatedSecondsRemaining;
+    _pPage->temperature = status._temperature;
+    _pPage->printRating = status._printRating;
+    _pPage->canLoadPrintData = status._canLoadPrintData;
+    _pPage->canUpgradeProjector = status._canUpgradeProjector;
+    memcpy(_pPage->localJobUniqueID, status._localJobUniqueID, UUID_LEN + 1);
+    CopyField(_pPage->jobID, status._jobID, STATUS_PAGE_JOB_ID_LEN);
+    CopyField(_pPage->usbDriveFileName, status._usbDriveFileName, 
+              STATUS_PAGE_FILENAME_LEN);
+    
+    __atomic_store_n(&_pPage->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Constructor, maps the named status page for reading.
+StatusPageReader::StatusPageReader(const char* name) :
+_pPage(NULL)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        throw std::runtime_error(ErrorMessage::Format(StatusPageOpen, errno));
+    
+    void* pMap = mmap(NULL, sizeof(StatusPageData), PROT_READ, MAP_SHARED, 
+                      fd, 0);
+    close(fd);
+    if (pMap == MAP_FAILED)
+        throw std::runtime_error(ErrorMessage::Format(StatusPageOpen, errno));
+    
+    _pPage = static_cast<const StatusPageData*>(pMap);
+}
+
+// Destructor
+StatusPageReader::~StatusPageReader()
+{
+    munmap(const_cast<StatusPageData*>(_pPage), sizeof(StatusPageData));
+}
+
+// Get the current sequence number, so that callers can tell whether the 
+// status has changed without copying the page.
+uint32_t StatusPageReader::GetSequence() const
+{
+    return __atomic_load_n(&_pPage->sequence, __ATOMIC_ACQUIRE);
+}
+
+// Copy a consistent snapshot of the status page.  Returns false if the page 
+// isn't a valid status page or couldn't be copied while unchanged.
+bool StatusPageReader::Read(StatusPageData& snapshot) const
+{
+    for (int i = 0; i < MAX_STATUS_PAGE_READ_TRIES; i++)
+    {
+        uint32_t before = __atomic_load_n(&_pPage->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1)
+            continue;   // being written
+        
+        memcpy(&snapshot, _pPage, sizeof(StatusPageData));
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&_pPage->sequence, __ATOMIC_RELAXED) == before)
+            return snapshot.magic == STATUS_PAGE_MAGIC && 
+                   snapshot.version == STATUS_PAGE_VERSION;
+    }
+    return false;
+}
@@ -21,17 +21,26 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
+#include <time.h>
 #include <sys/timerfd.h>
+#include <sys/eventfd.h>
 #include <sys/epoll.h> 
 #include <stdexcept>
 #include <cerrno>
+#include <cmath>
 
 #include "Timer.h"
 #include "ErrorMessage.h"
-
-Timer::Timer() :
-_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK)),
-_dataSize(sizeof(uint64_t))
+#include "VirtualClock.h"
+
+// A timer using a virtual clock is an event file descriptor written to by the
+// clock, which reads just like a timerfd.
+Timer::Timer(VirtualClock* pVirtualClock) :
+_fd(pVirtualClock ? eventfd(0, EFD_NONBLOCK) : 
+                    timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK)),
+_dataSize(sizeof(uint64_t)),
+_pVirtualClock(pVirtualClock)
 {
     if (_fd < 0)
         throw std::runtime_error(ErrorMessage::Format(TimerCreate, errno));
@@ -39,6 +48,9 @@ _dataSize(sizeof(uint64_t))
 
 Timer::~Timer()
 {
+    if (_pVirtualClock)
+        _pVirtualClock->ClearAlarm(_fd);
+    
     close(_fd);
 }
 
@@ -52,17 +64,14 @@ int Timer::GetFileDescriptor() const
     return _fd;
 }
 
-EventDataVec Timer::Read()
+void Timer::Read(EventDataVec& eventData)
 {
-    EventDataVec eventData;
     uint64_t data;
 
     lseek(_fd, 0, SEEK_SET);
     
     if (read(_fd, &data, _dataSize) == _dataSize)
         eventData.push_back(EventData(data));
-
-    return eventData;
 }
 
 // Clear the timer
@@ -75,6 +84,9 @@ void Timer::Clear() const
 // Return the time remaining until expiration in seconds
 double Timer::GetRemainingTimeSeconds() const
 {
+    if (_pVirtualClock)
+        return _pVirtualClock->GetRemainingSeconds(_fd);
+    
     itimerspec timerValue;
 
     if (timerfd_gettime(_fd, &timerValue) == -1)
@@ -83,11 +95,37 @@ double Timer::GetRemainingTimeSeconds() const
     return timerValue.it_value.tv_sec + timerValue.it_value.tv_nsec * 1e-9;
 }
 
+// Return the current time on the clock the timer runs on, in milliseconds
+long Timer::GetTimeMillis() const
+{
+    if (_pVirtualClock)
+        return std::lround(_pVirtualClock->GetSeconds() * 1000.0);
+    
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
 // Set the timer expiration in seconds and start the timer
 // This configures the timer to operate for a single cycle, not to
 // repeat periodically
 void Timer::Start(double expirationTimeSeconds) const
 {
+    if (_pVirtualClock)
+    {
+        // as with a timerfd, any expiration not yet read is discarded 
+        // (there being none to read isn't an error)
+        uint64_t data;
+        if (read(_fd, &data, _dataSize) < 0 && errno != EAGAIN)
+            throw std::runtime_error("unable to set timer");
+        
+        if (expirationTimeSeconds > 0.0)
+            _pVirtualClock->SetAlarm(_fd, expirationTimeSeconds);
+        else
+            _pVirtualClock->ClearAlarm(_fd);
+        return;
+    }
+    
     itimerspec timerValue;
   
     // Floor the setpoint to get the portion in whole seconds
@@ -98,10 +98,8 @@ bool UdevMonitor::QualifyEvents(uint32_t events) const
 // Read the path of the node corresponding to the activity.
 // Returns an empty list if the action reported by udev does not match
 // the action filter parameter specified at construction.
-EventDataVec UdevMonitor::Read()
+void UdevMonitor::Read(EventDataVec& eventData)
 {
-    EventDataVec eventData;
-
     // receive the device that triggered the activity
     udev_device* pDevice = udev_monitor_receive_device(_pMonitor);
 
@@ -116,13 +114,12 @@ EventDataVec UdevMonitor::Read()
         {
             // this resource encountered activity of interest
             // propagate the activity by returning the node path
-            eventData.push_back(EventData(std::string(node)));
+            _node = node;
+            eventData.push_back(EventData(_node));
         }
 
         udev_device_unref(pDevice);
     }
-
-    return eventData;
 }
 
 // Decrease the ref counts to release the resources.
@@ -0,0 +1,98 @@
+//  File:   VirtualClock.cpp
+//  Simulated time, for running prints without waiting for real timers
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <unistd.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <VirtualClock.h>
+
+// Constructs a clock that starts at time zero, with no alarms set.
+VirtualClock::VirtualClock() :
+_nowMicros(0)
+{
+}
+
+// Returns the time elapsed on this clock since it was constructed.
+double VirtualClock::GetSeconds() const
+{
+    return _nowMicros * 1e-6;
+}
+
+// Sets the alarm for the given event file descriptor to expire the given
+// number of seconds from now, replacing any alarm already set for it.
+void VirtualClock::SetAlarm(int fd, double seconds)
+{
+    uint64_t micros = seconds > 0.0 ? std::llround(seconds * 1e6) : 0;
+    _alarms[fd] = _nowMicros + micros;
+}
+
+// Clears any alarm set for the given event file descriptor.
+void VirtualClock::ClearAlarm(int fd)
+{
+    _alarms.erase(fd);
+}
+
+// Returns the time left until the alarm for the given event file descriptor
+// expires, or zero if it has no alarm set.
+double VirtualClock::GetRemainingSeconds(int fd) const
+{
+    std::map<int, uint64_t>::const_iterator it = _alarms.find(fd);
+    if (it == _alarms.end())
+        return 0.0;
+
+    return (it->second - _nowMicros) * 1e-6;
+}
+
+// Moves the time forward to that of the earliest alarm, and expires every
+// alarm set for that time.  Returns false, leaving the time unchanged, if
+// there are no alarms set.
+bool VirtualClock::AdvanceToNextAlarm()
+{
+    if (_alarms.empty())
+        return false;
+
+    std::map<int, uint64_t>::const_iterator it;
+    uint64_t next = _alarms.begin()->second;
+    for (it = _alarms.begin(); it != _alarms.end(); ++it)
+        next = std::min(next, it->second);
+
+    _nowMicros = next;
+
+    std::vector<int> expired;
+    for (it = _alarms.begin(); it != _alarms.end(); ++it)
+    {
+        if (it->second == next)
+            expired.push_back(it->first);
+    }
+
+    uint64_t count = 1;
+    for (size_t i = 0; i < expired.size(); i++)
+    {
+        _alarms.erase(expired[i]);
+        write(expired[i], &count, sizeof(count));
+    }
+
+    return true;
+}
@@ -115,6 +115,9 @@ enum Command
     // turn the projector full off
     ShowBlack,
     
+    // report event handler latency statistics
+    ShowEventStats,
+    
     // Quit this application
     Exit
 };
@@ -33,7 +33,7 @@ public:
     ~CommandPipe();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     bool QualifyEvents(uint32_t events) const;
 
 private:
@@ -45,6 +45,8 @@ private:
 private:
     int _readFd;
     int _writeFd;
+    // the last command read, which remains valid until the next read
+    std::string _command;
 };
 
 #endif    // COMMANDPIPE_H
@@ -0,0 +1,65 @@
+//  File:   CrossSection.h
+//  Measures the area cured by a layer, from its slice image
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CROSSSECTION_H
+#define	CROSSSECTION_H
+
+#include <vector>
+
+// The cured area of a layer, the number of separate islands it's made of, and 
+// how much of it is on an edge, as measured from the 8-bit grayscale slice 
+// image.  Smaller cross-sections stick less to the tray, so they can be 
+// separated and approached faster, and those made mostly of thin features 
+// (i.e. mostly edges) need less exposure than large solid areas.
+class CrossSection
+{
+public:
+    CrossSection();
+    void Measure(const unsigned char* pixels, int width, int height);
+    unsigned long GetCuredPixels() const { return _curedPixels; }
+    unsigned long GetTotalPixels() const { return _totalPixels; }
+    int GetIslands() const { return _islands; }
+    unsigned long GetEdgePixels() const { return _edgePixels; }
+    double GetEdgePercent() const;
+    double GetSpeedFactor(double smallAreaPercent, double largeAreaPercent,
+                          double maxSpeedFactor, int maxIslands) const;
+    double GetExposureFactor(double solidEdgePercent, double thinEdgePercent,
+                             double minFactor, double maxFactor) const;
+
+private:
+    int FindRoot(int run);
+    
+    unsigned long _curedPixels;
+    unsigned long _totalPixels;
+    int _islands;
+    unsigned long _edgePixels;
+    // the runs of cured pixels in the previous and current rows, as pairs of
+    // first and last column, and the union-find parent of each run
+    std::vector<int> _previousRuns;
+    std::vector<int> _currentRuns;
+    std::vector<int> _previousIDs;
+    std::vector<int> _currentIDs;
+    std::vector<int> _parents;
+};
+
+#endif    // CROSSSECTION_H
@@ -194,6 +194,21 @@ enum ErrorCode
     CantUnMapPriorityRegister = 156,
     BadPerLayerSettings = 157,
     GpioOutput = 158,
+    StatusPipeBackedUp = 159,
+    StatusPageCreate = 160,
+    StatusPageOpen = 161,
+    SlowEventCallback = 162,
+    StalledEventCallback = 163,
+    CantWriteEventStats = 164,
+    CantStartFrontPanelThread = 165,
+    CantStartI2cBusThread = 166,
+    CantReadProjectorFwFile = 167,
+    CantStartProjectorUpgradeThread = 168,
+    SimulationNotSupported = 169,
+    CantWriteSimulationReport = 170,
+    CantStartExposureThread = 171,
+    DrmScanoutFormatNotSupported = 172,
+    DrmPageFlipTimeout = 173,
 
     // Guardrail for valid error codes
     MaxErrorCode
@@ -359,6 +374,21 @@ public:
             messages[CantMapPriorityRegister] = "Could not map priority register to prevent video flicker";
             messages[CantUnMapPriorityRegister] = "Could not un-map priority register to prevent video flicker";
             messages[BadPerLayerSettings] = "Invalid per-layer settings file";
+            messages[StatusPipeBackedUp] = "Status pipe backed up, holding only the latest status for: %s";
+            messages[StatusPageCreate] = "Unable to create shared memory status page";
+            messages[StatusPageOpen] = "Unable to open shared memory status page";
+            messages[SlowEventCallback] = "Event callback exceeded its time budget: %s";
+            messages[StalledEventCallback] = "Event callback still running past its time budget: %s";
+            messages[CantWriteEventStats] = "Unable to write event handler statistics";
+            messages[CantStartFrontPanelThread] = "Unable to start the front panel writer thread";
+            messages[CantStartI2cBusThread] = "Unable to start the I2C bus thread";
+            messages[CantReadProjectorFwFile] = "Could not read projector firmware file: %s";
+            messages[CantStartProjectorUpgradeThread] = "Unable to start the projector upgrade thread";
+            messages[SimulationNotSupported] = "Simulation requires a build with mock hardware";
+            messages[CantWriteSimulationReport] = "Unable to write simulation report";
+            messages[CantStartExposureThread] = "Unable to start the projector exposure thread";
+            messages[DrmScanoutFormatNotSupported] = "DRM device cannot scan out the requested pixel format";
+            messages[DrmPageFlipTimeout] = "Timed out waiting for DRM page flip";
                     
             messages[UnknownErrorCode] = "Unknown error code: %d";
             initialized = true;
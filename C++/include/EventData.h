@@ -1,5 +1,6 @@
 //  File:   EventData.h
-//  Encapsulates event data using a discriminated type to store arbitrary data
+//  Encapsulates event data in a tagged union of the payload types used by 
+//  events
 //
 //  This file is part of the Ember firmware.
 //
@@ -24,19 +25,109 @@
 #ifndef EVENTDATA_H
 #define EVENTDATA_H
 
-#include <boost/any.hpp>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
 
+class PrinterStatus;
+
+// Holds the payload of a single event without allocating.  Scalars are stored 
+// in place, while strings and printer status are referenced rather than 
+// copied, so they must outlive the dispatch of the event.  Resources keep 
+// the strings and statuses they return alive until their next Read.
 class EventData
 {
 public:
-    EventData(const boost::any& data) : _data(data) {}
+    EventData(char data) : _type(CharData) { _data.c = data; }
+    EventData(unsigned char data) : _type(UnsignedCharData) { _data.uc = data; }
+    EventData(int data) : _type(IntData) { _data.i = data; }
+    EventData(uint32_t data) : _type(UInt32Data) { _data.u32 = data; }
+    EventData(uint64_t data) : _type(UInt64Data) { _data.u64 = data; }
+    EventData(const std::string& data) : _type(StringData) 
+                                                    { _data.pString = &data; }
+    EventData(const PrinterStatus& data) : _type(PrinterStatusData) 
+                                                    { _data.pStatus = &data; }
     ~EventData() {}
     
+    // Returns the payload, which must be of the type given when this was 
+    // constructed.  Throws std::bad_cast otherwise.
     template<typename T>
-    T Get() const { return boost::any_cast<T>(_data); }
+    const T& Get() const;
 
 private:
-    boost::any _data;
+    enum DataType
+    {
+        CharData,
+        UnsignedCharData,
+        IntData,
+        UInt32Data,
+        UInt64Data,
+        StringData,
+        PrinterStatusData
+    };
+    
+    void Expect(DataType type) const { if (type != _type) throw std::bad_cast(); }
+    
+    DataType _type;
+    union
+    {
+        char c;
+        unsigned char uc;
+        int i;
+        uint32_t u32;
+        uint64_t u64;
+        const std::string* pString;
+        const PrinterStatus* pStatus;
+    } _data;
 };
 
+template<>
+inline const char& EventData::Get<char>() const 
+{ 
+    Expect(CharData); 
+    return _data.c; 
+}
+
+template<>
+inline const unsigned char& EventData::Get<unsigned char>() const 
+{ 
+    Expect(UnsignedCharData); 
+    return _data.uc; 
+}
+
+template<>
+inline const int& EventData::Get<int>() const 
+{ 
+    Expect(IntData); 
+    return _data.i; 
+}
+
+template<>
+inline const uint32_t& EventData::Get<uint32_t>() const 
+{ 
+    Expect(UInt32Data); 
+    return _data.u32; 
+}
+
+template<>
+inline const uint64_t& EventData::Get<uint64_t>() const 
+{ 
+    Expect(UInt64Data); 
+    return _data.u64; 
+}
+
+template<>
+inline const std::string& EventData::Get<std::string>() const 
+{ 
+    Expect(StringData); 
+    return *_data.pString; 
+}
+
+template<>
+inline const PrinterStatus& EventData::Get<PrinterStatus>() const 
+{ 
+    Expect(PrinterStatusData); 
+    return *_data.pStatus; 
+}
+
 #endif    // EVENTDATA_H
@@ -25,17 +25,24 @@
 #ifndef EVENTHANDLER_H
 #define	EVENTHANDLER_H
 
-#include <map>
 #include <vector>
+#include <string>
+#include <atomic>
+#include <pthread.h>
 
 #include "IResource.h"
 #include "EventType.h"
 #include "ICallback.h"
 #include "Command.h"
+#include "LatencyHistogram.h"
+
+class VirtualClock;
 
 class EventHandler : public ICommandTarget, public ICallback
 {
 typedef std::vector<ICallback*> SubscriptionVec;
+typedef std::vector<LatencyHistogram> HistogramVec;
+typedef std::vector<std::string> NameVec;
 
 public:
     EventHandler();
@@ -47,18 +54,69 @@ public:
     void Begin(int numIterations);
 #endif    
     void AddEvent(EventType eventType, IResource* pResource);
+    void SetVirtualClock(VirtualClock* pVirtualClock) 
+                                        { _pVirtualClock = pVirtualClock; }
     void Handle(Command command);
     bool HandleError(ErrorCode code, bool fatal, const char* str, int value) 
                                                             { return false; }
     void Callback(EventType eventType, const EventData& data);
+    void WriteStats(const char* path);
+    const LatencyHistogram& GetDispatchStats(EventType eventType) const
+                                    { return _dispatchStats[eventType]; }
+    const LatencyHistogram& GetQueueingStats(EventType eventType) const
+                                    { return _queueingStats[eventType]; }
+    const LatencyHistogram& GetSubscriberStats(EventType eventType, 
+                                               int subscriber) const
+                        { return _subscriberStats[eventType][subscriber]; }
 
-
-private:    
+private:
+    // This class owns a thread and an epoll instance
+    // Disable copy construction and copy assignment
+    EventHandler(const EventHandler&);
+    EventHandler& operator=(const EventHandler&);
+    void StartWatchdog();
+    void StopWatchdog();
+    static void* WatchdogHelper(void* context);
+    void Watchdog();
+    void PublishCallback(uint64_t start, int eventType, int subscriber);
+    void ReportStall(int eventType, int subscriber, uint64_t elapsed);
+    void CheckBudget(int eventType, int subscriber, uint64_t elapsed);
+    
     SubscriptionVec _subscriptions[MaxEventTypes];
+    // demangled class name of each subscriber, for reporting
+    NameVec _subscriberNames[MaxEventTypes];
+    // time taken to read each event and call all of its subscribers
+    LatencyHistogram _dispatchStats[MaxEventTypes];
+    // time from the return of epoll_wait to the start of dispatching an event
+    LatencyHistogram _queueingStats[MaxEventTypes];
+    // time taken by each subscriber's callback
+    HistogramVec _subscriberStats[MaxEventTypes];
     int _epollFd;
-    std::map<int, std::pair<EventType, IResource*> > _resources;
+    // the event type and resource for each file descriptor, indexed by the 
+    // file descriptor itself
+    std::vector<std::pair<EventType, IResource*> > _resources;
+    // data read from resources, reused for each event to avoid reallocation
+    EventDataVec _eventData;
     // exit flag determines if event loop will return on next iteration
     bool _exit; 
+    // callbacks taking longer than this many microseconds are reported, 
+    // or zero to disable the watchdog
+    uint64_t _budget;
+    // state shared with the watchdog thread, describing the callback in 
+    // progress; the start time is zero when no callback is running, and the 
+    // sequence is odd while they're being changed
+    std::atomic<uint32_t> _callbackSequence;
+    std::atomic<uint64_t> _callbackStart;
+    std::atomic<int> _callbackEventType;
+    std::atomic<int> _callbackSubscriber;
+    std::atomic<bool> _stopWatchdog;
+    bool _watchdogRunning;
+    pthread_t _watchdogThread;
+    // kernel thread ID of the thread handling events, for sampling its state
+    int _eventThreadID;
+    // the clock advanced whenever no event is ready, when running in 
+    // simulated time
+    VirtualClock* _pVirtualClock;
 };
 
 
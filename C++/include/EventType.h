@@ -82,6 +82,10 @@ enum EventType
     // Fired when a user removes a usb drive
     USBDriveDisconnected,
     
+    // Expiration of the timer the network interface uses to publish status 
+    // updates that were coalesced, or to retry pipes that were backed up.
+    StatusPublishTimer,
+    
     // Guardrail for valid event types.
     MaxEventTypes,
 };
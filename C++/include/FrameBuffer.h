@@ -26,9 +26,11 @@
 #ifndef FRAMEBUFFER_H
 #define	FRAMEBUFFER_H
 
-#include <vector>
+#include <memory>
+#include <string>
 
-#include "IFrameBuffer.h"
+#include "ScanoutBuffers.h"
+#include "Filenames.h"
 #include "DRM_Device.h"
 #include "DRM_Resources.h"
 #include "DRM_Connector.h"
@@ -36,24 +38,38 @@
 #include "DRM_DumbBuffer.h"
 #include "DRM_FrameBuffer.h"
 
-class FrameBuffer : public IFrameBuffer
+class FrameBuffer : public ScanoutBuffers
 {
 public:
-    FrameBuffer(int width, int height);
+    FrameBuffer(int width, int height, 
+                const std::string& deviceNode = DRM_DEVICE_NODE,
+                const ScanoutFormat* pFormat = NULL);
     ~FrameBuffer();
-    void Blit(Magick::Image& image);
-    void Fill(uint8_t value);
-    void Swap();
 
 private:
+    const ScanoutFormat& SelectFormat(int width, int height,
+                                      const ScanoutFormat* pFormat);
+    bool CanDisplay(const ScanoutFormat& format, int width, int height);
+    bool SetGrayPalette();
+    uint8_t* Map(const DRM_DumbBuffer& drmDumbBuffer);
+    void Display(int buffer);
+    void AwaitPageFlip();
+    static void PageFlipHandler(int fd, unsigned int sequence, 
+                                unsigned int seconds, unsigned int micros, 
+                                void* context);
+    
     DRM_Device _drmDevice;
     DRM_Resources _drmResources;
     DRM_Connector _drmConnector;
     DRM_Encoder _drmEncoder;
-    DRM_DumbBuffer _drmDumbBuffer;
-    DRM_FrameBuffer _drmFrameBuffer;
-    uint8_t* _pFrameBufferMap;
-    std::vector<uint8_t> _image;
+    const ScanoutFormat& _format;
+    // black is displayed by flipping to the black buffer
+    std::unique_ptr<DRM_DumbBuffer> _pDrmDumbBuffers[NUM_SCANOUT_BUFFERS];
+    std::unique_ptr<DRM_FrameBuffer> _pDrmFrameBuffers[NUM_SCANOUT_BUFFERS];
+    uint8_t* _pFrameBufferMaps[NUM_SCANOUT_BUFFERS];
+    uint32_t _frameBufferIds[NUM_SCANOUT_BUFFERS];
+    // true while a requested page flip has yet to be completed
+    bool _flipPending;
 };
 
 
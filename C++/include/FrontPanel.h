@@ -26,6 +26,9 @@
 #define	FRONTPANEL_H
 
 #include <map>
+#include <deque>
+#include <vector>
+#include <pthread.h>
 
 #include <PrinterStatus.h>
 #include <Screen.h>
@@ -35,6 +38,7 @@
 #include "Settings.h"
 
 class I_I2C_Device;
+class FrontPanelScreen;
 
 class FrontPanel : public ICallback, public IDisplay
 {
@@ -49,6 +53,9 @@ protected:
     void ClearScreen();
     void ShowText(Alignment align, unsigned char x, unsigned char y, 
              unsigned char size, int color, std::string text);
+    void UpdateText(int lineID, Alignment align, unsigned char x, 
+             unsigned char y, unsigned char size, int color, 
+             std::string text);
     virtual void AnimateLEDs(int animationNum);
     void Reset();
 
@@ -57,29 +64,42 @@ private:
     void ShowStatus(const PrinterStatus& ps); 
     void BuildScreens();
     bool IsReady();
-    void* ShowScreen(Screen* pScreen, PrinterStatus* pPS);        
-    void AwaitThreadComplete();
-    void SendCommand(unsigned char* buf, int len, bool awaitReady = true);
+    void ShowScreen(Screen* pScreen, PrinterStatus* pPS);        
+    void QueueScreen(FrontPanelScreen* pFPS);
+    FrontPanelScreen* AwaitScreen();
+    void AwaitWriterExit();
+    void SendCommand(const unsigned char* buf, int len);
+    void Flush();
+    void WriteCommands();
+    void WriteBytes(const std::vector<unsigned char>& bytes);
     
-    static void* ThreadHelper(void *context);
+    static void* WriterThread(void *context);
 
     std::map<PrinterStatusKey, Screen*> _screens;
-    pthread_t _showScreenThread;
+    pthread_t _writerThread;
+    // screens waiting to be drawn by the writer thread, guarded by 
+    // _queueMutex
+    std::deque<FrontPanelScreen*> _screenQueue;
+    bool _exiting;
+    pthread_mutex_t _queueMutex;
+    pthread_cond_t _queueChanged;
+    // complete command frames not yet written to the front panel, guarded by 
+    // _commandsMutex
+    std::vector<std::vector<unsigned char> > _commands;
+    int _commandsLength;
+    pthread_mutex_t _commandsMutex;
     const I_I2C_Device& _i2cDevice;
     Settings& _settings;
     std::string _lastUserName;
     std::string _lastJobName;
 };
 
-// Aggregates a FrontPanel, a Screen, and PrinterStatus, 
-// for passing in to a thread that handles drawing the screen
+// Aggregates a Screen and the PrinterStatus to be shown on it, 
+// for queuing to the thread that handles drawing the screen
 class FrontPanelScreen
 {
 public:
-    FrontPanelScreen(FrontPanel* pFrontPanel, 
-                     const PrinterStatus& ps, 
-                     Screen* pScreen);
-    FrontPanel* _pFrontPanel;
+    FrontPanelScreen(const PrinterStatus& ps, Screen* pScreen);
     PrinterStatus _PS;
     Screen* _pScreen;
 };
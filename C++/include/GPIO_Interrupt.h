@@ -33,7 +33,7 @@ public:
     ~GPIO_Interrupt();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     void UnExport() const;
     bool QualifyEvents(uint32_t events) const;
 
@@ -70,17 +70,27 @@ constexpr int CMD_RING_OFF        = 0x01;  // Turn ring off
 constexpr int CMD_RING_SEQUENCE   = 0x02;  // Start a ring sequence (0 to stop)
 constexpr int CMD_RING_LED        = 0x03;  // Set a ring LED to given value
 constexpr int CMD_RING_LEDS       = 0x04;  // Set all ring LEDS to given value
+constexpr int CMD_RING_LED_VALUES = 0x05;  // Set ring LEDs to given values
 constexpr int CMD_OLED_SETTEXT    = 0x01;  // Set OLED display text flush left
 constexpr int CMD_OLED_CENTERTEXT = 0x06;  // Set OLED display text centered on x
 constexpr int CMD_OLED_RIGHTTEXT  = 0x07;  // Set OLED display text flush right
 constexpr int CMD_OLED_CLEAR      = 0x02;  // Clear OLED display
 constexpr int CMD_OLED_ON         = 0x03;  // Turn OLED display on
 constexpr int CMD_OLED_OFF        = 0x04;  // Turn OLED display off
+constexpr int CMD_OLED_LINE       = 0x09;  // Update OLED text line in place
 constexpr int CMD_SLEEP           = 0x03;  // Set screensaver awake time
 // maximum string length for front panel's I2C buffer
 constexpr int MAX_OLED_STRING_LEN = 20; 
+// maximum string length for a line updated in place, for which the command 
+// has two more bytes but must still fit in a single write
+constexpr int MAX_OLED_LINE_LEN   = 18; 
 // numbr of LEDs in the ring around the OLED display
 constexpr int NUM_LEDS_IN_RING    = 21;
+// size of the front panel's buffer for received command frames
+constexpr int FP_CMD_BUFFER_SIZE  = 300;
+// most command bytes the front panel can receive in one I2C write (its I2C
+// receive buffer holds 32 bytes, including the register address)
+constexpr int MAX_FP_WRITE_LEN    = 31;
 
 // inputs read directly 
 constexpr int DOOR_SENSOR_PIN      = 47; // GPIO1_15
@@ -189,6 +199,9 @@ constexpr int PROJECTOR_ERASE_SECTOR_REG       = 0x28;
 // the start address of the firmware application (past the bootloader))
 constexpr unsigned int APP_START_ADDR = 0x20000;
 constexpr unsigned char FLASH_BUSY_STATUS       = 0x08;
+// the most flash data sent in a single download command (the size used by
+// TI's example code, which the projector's boot-loader is known to accept)
+constexpr unsigned int PROJECTOR_FLASH_CHUNK_SIZE = 256;
 
 // video resolution for video mode
 constexpr unsigned int VIDEO_MODE_WIDTH  =  1280;
@@ -30,6 +30,7 @@
 
 class IResource;
 class I_I2C_Device;
+class VirtualClock;
 
 typedef std::unique_ptr<I_I2C_Device> I2C_DevicePtr;
 typedef std::unique_ptr<IResource> ResourcePtr;
@@ -37,6 +38,7 @@ typedef std::unique_ptr<IFrameBuffer> FrameBufferPtr;
 
 namespace HardwareFactory
 {
+bool           Simulate(VirtualClock& clock);
 I2C_DevicePtr  CreateMotorControllerI2cDevice();
 I2C_DevicePtr  CreateFrontPanelI2cDevice();
 I2C_DevicePtr  CreateProjectorI2cDevice();
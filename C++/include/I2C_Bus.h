@@ -0,0 +1,115 @@
+//  File:   I2C_Bus.h
+//  Serializes and prioritizes the transfers made by the devices on an I2C bus
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef I2C_BUS_H
+#define	I2C_BUS_H
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "LatencyHistogram.h"
+
+// Priorities of the devices sharing a bus, highest first.  Motor controller
+// commands should never wait behind front panel text.
+enum I2C_Priority
+{
+    HighI2cPriority = 0,
+    NormalI2cPriority,
+    LowI2cPriority
+};
+
+// Statistics for the transfers made by one device
+struct I2C_Stats
+{
+    I2C_Stats() : errors(0) {}
+
+    LatencyHistogram queueing;  // from submission until the transfer starts
+    LatencyHistogram transfer;  // time taken by the transfer itself
+    uint64_t errors;
+};
+
+class I2C_Bus;
+
+// A write and/or read on the device with the given file descriptor, in that 
+// order.  The caller's buffers must remain valid until Await() returns.
+class I2C_Transfer
+{
+public:
+    I2C_Transfer(int fd, I2C_Priority priority, I2C_Stats* pStats,
+                 const unsigned char* writeData, int writeLength,
+                 unsigned char* readData = NULL, int readLength = 0);
+    bool Await();
+    bool WriteFailed() const { return _writeFailed; }
+    int GetErrno() const { return _errno; }
+
+private:
+    friend class I2C_Bus;
+
+    int _fd;
+    I2C_Priority _priority;
+    I2C_Stats* _pStats;
+    const unsigned char* _writeData;
+    int _writeLength;
+    unsigned char* _readData;
+    int _readLength;
+    I2C_Bus* _pBus;
+    uint64_t _submitTime;
+    bool _done;
+    bool _succeeded;
+    bool _writeFailed;
+    int _errno;
+};
+
+// Performs the transfers submitted for all the devices on one bus from a 
+// single thread, highest priority first and in order of submission within 
+// each priority.  Devices on the same port share the same bus, which exists 
+// for as long as any of them do.
+class I2C_Bus
+{
+public:
+    static std::shared_ptr<I2C_Bus> Get(int port);
+    ~I2C_Bus();
+    void Submit(I2C_Transfer* pTransfer);
+    void Await(I2C_Transfer* pTransfer);
+
+private:
+    I2C_Bus();
+    I2C_Bus(const I2C_Bus&);
+    I2C_Bus& operator=(const I2C_Bus&);
+    static void* BusThread(void* context);
+    void Perform(I2C_Transfer* pTransfer);
+
+    pthread_t _thread;
+    // pending transfers, keyed by priority and then by order of submission
+    std::map<std::pair<int, uint64_t>, I2C_Transfer*> _queue;
+    uint64_t _submissions;
+    bool _exiting;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _queueChanged;
+    pthread_cond_t _transferDone;
+};
+
+#endif    // I2C_BUS_H
@@ -25,12 +25,16 @@
 #ifndef I2C_DEVICE_H
 #define	I2C_DEVICE_H
 
+#include <memory>
+
 #include "I_I2C_Device.h"
+#include "I2C_Bus.h"
 
 class I2C_Device : public I_I2C_Device
 {
 public:
-    I2C_Device(unsigned char slaveAddress, int port);
+    I2C_Device(unsigned char slaveAddress, int port, 
+               I2C_Priority priority = NormalI2cPriority);
     ~I2C_Device();
     bool Write(unsigned char data) const;
     bool Write(unsigned char registerAddress, unsigned char data) const;
@@ -44,12 +48,20 @@ public:
     bool ReadWhenReady(unsigned char registerAddress, 
                       unsigned char* data, int length,
                       unsigned char readyStatus) const;
+    const I2C_Stats& GetStats() const { return _stats; }
   
 private:
     I2C_Device(const I2C_Device&);
     I2C_Device& operator=(const I2C_Device&);
 
+    bool Perform(I2C_Transfer& transfer) const;
+
     int _fd;
+    unsigned char _slaveAddress;
+    int _port;
+    I2C_Priority _priority;
+    std::shared_ptr<I2C_Bus> _pBus;
+    mutable I2C_Stats _stats;
 };
 
 
@@ -37,7 +37,7 @@ public:
     ~I2C_Resource();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     bool QualifyEvents(uint32_t events) const;
 
 private:
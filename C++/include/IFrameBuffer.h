@@ -37,6 +37,7 @@ public:
     virtual ~IFrameBuffer() { }
     virtual void Blit(Magick::Image& image) = 0;
     virtual void Fill(uint8_t value) = 0;
+    virtual void Stage() = 0;
     virtual void Swap() = 0;
 };
 
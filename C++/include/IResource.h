@@ -38,13 +38,16 @@ public:
 
     virtual ~IResource() {}
 
-    // Returns one "event's" worth of data from the resource
-    // The return type is an array of buffers to accommodate the situation where
+    // Appends one "event's" worth of data from the resource to the given 
+    // vector, which the caller reuses so that reading doesn't allocate
+    // The data is an array of buffers to accommodate the situation where
     // the resource contains multiple messages that a client needs to handle
     // individually per event
     // In general, each data buffer does not contain a new-line or other
     // termination character
-    virtual EventDataVec Read() = 0;
+    // Any string or status referenced by the data must remain valid until the
+    // next call to Read
+    virtual void Read(EventDataVec& eventData) = 0;
 
     // Returns the epoll event types applicable to this resource
     virtual uint32_t GetEventTypes() const = 0;
@@ -24,19 +24,24 @@
 #ifndef IMAGEPROCESSOR_H
 #define	IMAGEPROCESSOR_H
 
+#include <vector>
 #include <Magick++.h>
 
+#include <CrossSection.h>
+
 class ImageProcessor {
 public:
     ImageProcessor();
     ~ImageProcessor();
     void Scale(Magick::Image* pImage, double scale);
     Magick::Image* MapForPatternMode(Magick::Image& imageIn);
+    void Measure(Magick::Image& image, CrossSection& crossSection);
     
 private:
     Magick::Image _patternModeImage;
     Magick::Pixels* _pPatternModeView;
     Magick::PixelPacket* _pPatternModeCache; 
+    std::vector<unsigned char> _pixels;
 };
 
 
@@ -0,0 +1,55 @@
+//  File:   LatencyHistogram.h
+//  Accumulates a histogram of latencies in power-of-two microsecond buckets
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LATENCYHISTOGRAM_H
+#define	LATENCYHISTOGRAM_H
+
+#include <stdint.h>
+
+// number of buckets, enough to cover latencies of over an hour
+constexpr int NUM_LATENCY_BUCKETS = 33;
+
+// Records latencies in fixed-size buckets, so that recording never allocates.
+// Bucket 0 holds latencies under 1 us, and bucket n holds latencies from 
+// 2^(n-1) up to (but not including) 2^n microseconds.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+    void Record(uint64_t microseconds);
+    void Reset();
+    uint64_t GetCount() const { return _count; }
+    uint64_t GetMax() const { return _max; }
+    uint64_t GetMean() const;
+    uint64_t GetPercentile(double percentile) const;
+    uint64_t GetBucketCount(int bucket) const { return _buckets[bucket]; }
+    static uint64_t GetBucketLimit(int bucket);
+
+private:
+    uint64_t _buckets[NUM_LATENCY_BUCKETS];
+    uint64_t _count;
+    uint64_t _total;
+    uint64_t _max;
+};
+
+#endif    // LATENCYHISTOGRAM_H
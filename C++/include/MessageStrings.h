@@ -44,9 +44,14 @@ constexpr const char*  LOG_KEYBOARD_INPUT        = "keyboard input: %s";
 constexpr const char*  LOG_UI_COMMAND            = "UI command: %s";
 constexpr const char*  LOG_TEMPERATURE_PRINTING  = "printing layer #%d of %d: temperature = %g";
 constexpr const char*  LOG_TEMPERATURE           = "temperature = %g";
+constexpr const char*  LOG_EXPOSURE_START       = "exposure start latency for %llu exposures: mean %llu us, 99th percentile %llu us, max %llu us";
+constexpr const char*  LOG_ADAPTED_EXPOSURE      = "layer %d exposure: %g s (%.2f times normal, with %.1f%% of cured pixels on an edge)";
 constexpr const char*  LOG_JAM_DETECTED          = "jam detected at layer %d: temperature = %g";
 constexpr const char*  LOG_NO_PROJECTOR_I2C      = "no I2C connection to projector";
 constexpr const char*  LOG_INVALID_MOTOR_COMMAND = "register: 0x%x, command: 0x%x";
+constexpr const char*  LOG_I2C_TRANSFER_SUMMARY  = "I2C device 0x%02x on port %d: %llu transfers, %llu errors, queueing p99 %llu us, transfer p99 %llu us, max %llu us";
+constexpr const char*  LOG_STATUS_COALESCING     = "Status updates coalesced: %lu, dropped: %lu";
+constexpr const char*  LOG_SIMULATION_SUMMARY    = "simulated print %s after %d of %d layers: %.1f s (%d s estimated), per-layer timing in %s";
 
 constexpr const char*  UNKNOWN_REGISTRATION_CODE = "unknown code";
 constexpr const char*  UNKNOWN_REGISTRATION_URL  = "unknown URL";
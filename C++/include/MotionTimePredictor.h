@@ -0,0 +1,62 @@
+//  File:   MotionTimePredictor.h
+//  Predicts how long the motor controller takes to perform motor commands
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MOTIONTIMEPREDICTOR_H
+#define	MOTIONTIMEPREDICTOR_H
+
+#include <vector>
+
+#include <MotorCommand.h>
+
+// Follows a sequence of motor commands the way the motor controller handles
+// them, keeping track of the speed, jerk, and linked distance settings for
+// each axis, and adds up the time taken by each move.  Move times use the same
+// jerk-limited acceleration planning as the motor controller firmware
+// (AVR/MotorController/Planner.cpp), which plans every move to start and end
+// at rest.  Homing moves are assumed to go the full distance allowed, so their
+// times are upper limits.
+class MotionTimePredictor
+{
+public:
+    MotionTimePredictor();
+    void Add(const MotorCommand& command);
+    void Add(const std::vector<MotorCommand>& commands);
+    double GetSeconds() const { return _seconds; }
+    static double GetMoveSeconds(double length, double speed, double jerk);
+
+private:
+    // the settings the motor controller holds for each axis, in its units
+    struct AxisSettings
+    {
+        double speed;           // units/minute
+        double jerk;            // units/minute^3
+        double linkedDistance;  // units
+    };
+
+    void AddMove(int axis, double distance);
+
+    AxisSettings _axes[2];
+    double _seconds;
+};
+
+#endif    // MOTIONTIMEPREDICTOR_H
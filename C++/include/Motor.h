@@ -25,6 +25,8 @@
 #define	MOTOR_H
 
 #include <vector>
+#include <map>
+#include <array>
 
 #include <MotorCommand.h>
 #include <PrinterStatus.h>
@@ -44,6 +46,29 @@ constexpr int UNITS_PER_REVOLUTION = 360 * 10; // deci-degrees in a full circle
 constexpr int R_SPEED_FACTOR = UNITS_PER_REVOLUTION;
 constexpr int Z_SPEED_FACTOR = 60;
 
+// maximum number of distinct sets of layer motion settings for which 
+// motions will be pre-encoded
+constexpr int MAX_PREPARED_LAYER_MOTIONS = 1024;
+
+// The motions sent for every layer, which may be pre-encoded
+enum LayerMotion
+{
+    SeparateMotion = 0,
+    ApproachMotion,
+    PressMotion,
+    UnpressMotion,
+    
+    NumLayerMotions // must be last
+};
+
+// The values of the layer settings that determine its motions
+typedef std::array<int, 14> LayerMotionKey;
+
+// A layer's motions, each encoded as a single batch (or empty if it couldn't
+// be encoded)
+typedef std::array<std::vector<unsigned char>, NumLayerMotions> 
+                                                        EncodedLayerMotions;
+
 class I_I2C_Device;
 
 class Motor
@@ -67,12 +92,29 @@ public:
     bool UnJam(const CurrentLayerSettings& cls, bool withInterrupt = true);
     bool Press(const CurrentLayerSettings& cls);
     bool Unpress(const CurrentLayerSettings& cls);
+    bool HoldSeparation(const CurrentLayerSettings& cls);
+    bool ReleaseHeldMotion();
+    int GetCommandSpace();
+    void PrepareLayer(const CurrentLayerSettings& cls);
+    void ClearPreparedLayers();
+    unsigned long GetPreparedSendCount() { return _preparedSendCount; }
+    double GetLayerMotionSec(LayerMotion motion, 
+                             const CurrentLayerSettings& cls);
     
 private:
-    bool SendCommands(std::vector<MotorCommand> commands);
+    bool SendCommands(const std::vector<MotorCommand>& commands);
+    bool SendLayerMotion(LayerMotion motion, const CurrentLayerSettings& cls);
+    void GetLayerMotionCommands(LayerMotion motion, 
+                                const CurrentLayerSettings& cls, 
+                                std::vector<MotorCommand>& commands);
+    LayerMotionKey GetLayerMotionKey(const CurrentLayerSettings& cls);
 
     const I_I2C_Device& _i2cDevice;
     Settings& _settings;
+    std::map<LayerMotionKey, EncodedLayerMotions> _preparedMotions;
+    unsigned long _preparedRevision;
+    // the number of motions sent in their pre-encoded form
+    unsigned long _preparedSendCount;
 };
 
 #endif    // MOTOR_H
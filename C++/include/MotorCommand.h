@@ -27,17 +27,38 @@
 
 #include <sys/types.h>
 
+#include <MotorController.h>
+
 class I_I2C_Device;
 
+// number of bytes in a command sent as part of a batch
+constexpr int MOTOR_COMMAND_SIZE = 6;
+// maximum number of bytes in an encoded batch (the command count, the 
+// commands, and the checksum)
+constexpr int MAX_BATCH_FRAME_SIZE = 
+                            MC_MAX_BATCH_COMMANDS * MOTOR_COMMAND_SIZE + 2;
+
 // A motor controller command that takes optional arguments.
 class MotorCommand
 {
 public:
     MotorCommand(unsigned char cmdRegister, unsigned char cmd, 
                  int32_t value = 0);
-    virtual bool Send(const I_I2C_Device& i2cDevice);
+    virtual bool Send(const I_I2C_Device& i2cDevice) const;
+    static bool SendBatch(const I_I2C_Device& i2cDevice, 
+                          const MotorCommand* commands, int count);
+    static int EncodeBatch(const MotorCommand* commands, int count, 
+                           unsigned char* buffer, bool reportErrors = true);
+    static bool SendEncodedBatch(const I_I2C_Device& i2cDevice, 
+                                 const unsigned char* buffer, int length);
+    unsigned char GetRegister() const { return _cmdRegister; }
+    unsigned char GetCommand() const { return _cmd; }
+    int32_t GetValue() const { return _value; }
 
 protected:  
+    bool IsValid(bool reportErrors = true) const;
+    void Encode(unsigned char* buffer) const;
+    
     unsigned char _cmdRegister;
     unsigned char _cmd;
     int32_t _value;
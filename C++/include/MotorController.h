@@ -58,6 +58,24 @@ constexpr uint8_t MC_COMMAND_REG_HIGH_FENCEPOST = 0xA6;
 // gives motor controller status
 constexpr uint8_t MC_STATUS_REG             = 0x30;
 
+// queue (read-only) register address 
+// gives the number of commands the motor controller can currently accept, so
+// that a sequence may be sent ahead of time without overflowing its buffer
+constexpr uint8_t MC_QUEUE_REG              = 0x31;
+
+// batch (write-only) register address, for sending a sequence of commands in 
+// a single I2C write.  A batch is framed as MC_BATCH_REG, the number of 
+// commands, the commands themselves (each as its register, action, and 32-bit
+// parameter, least significant byte first, with general commands sent as 
+// MC_GENERAL_REG, the command, and a zero parameter), and finally a checksum 
+// of the count and command bytes.  The motor controller accepts none of the
+// commands until it has verified the checksum.
+constexpr uint8_t MC_BATCH_REG              = 0xB0;
+// maximum number of commands in a single batch
+constexpr uint8_t MC_MAX_BATCH_COMMANDS     = 16;
+// polynomial for the CRC-8 batch checksum (x^8 + x^2 + x + 1)
+constexpr uint8_t MC_BATCH_CRC_POLYNOMIAL   = 0x07;
+
 // general motor controller commands (with no argument)
 constexpr uint8_t MC_GENERAL_LOW_FENCEPOST = 0;
 constexpr uint8_t MC_INTERRUPT        = 1; // generate an interrupt
@@ -81,7 +99,11 @@ constexpr uint8_t MC_MICROSTEPPING    = 3;
 // set maximum jerk for move command in units/minute^3/1E6
 constexpr uint8_t MC_JERK             = 4; 
 constexpr uint8_t MC_SPEED            = 5; // set speed for move (units/minute)
-constexpr uint8_t MC_SETTINGS_HIGH_FENCEPOST = 6;
+// set distance (units, either sign) for this axis to move together with the
+// next move of the other axis, as a single coordinated move limited by the 
+// speed and jerk settings of both axes 
+constexpr uint8_t MC_LINKED_MOVE      = 6;
+constexpr uint8_t MC_SETTINGS_HIGH_FENCEPOST = 7;
 
 
 // action command, for either rotation or Z axis (with int argument, x)
@@ -133,5 +155,18 @@ constexpr uint8_t MC_STATUS_MOVE_TIME_TOO_SMALL                  = 17;
 constexpr uint8_t MC_STATUS_BLOCK_SKIPPED                        = 18; 
 // unrecoverable internal error
 constexpr uint8_t MC_STATUS_INTERNAL_ERROR                       = 19; 
+// batch of commands had an invalid count or checksum
+constexpr uint8_t MC_STATUS_BATCH_INVALID                        = 20; 
+
+// Update a batch checksum with the next byte of the batch.  The checksum 
+// starts at zero.
+inline uint8_t MC_UpdateBatchChecksum(uint8_t checksum, uint8_t data)
+{
+    checksum ^= data;
+    for (uint8_t bit = 0; bit < 8; bit++)
+        checksum = (checksum & 0x80) ? 
+                   (checksum << 1) ^ MC_BATCH_CRC_POLYNOMIAL : checksum << 1;
+    return checksum;
+}
 
 #endif    // MOTORCONTROLLER_H
@@ -25,26 +25,71 @@
 #define	NETWORKINTERFACE_H
 
 #include <string>
+#include <vector>
 
 #include <PrinterStatus.h>
 #include <ICallback.h>
+#include <Timer.h>
+
+// A named pipe to which status is pushed.  A partially written status is 
+// completed before anything else is written to the pipe, and while the pipe 
+// is backed up only the most recent status is held for it.
+class StatusPipe
+{
+public:
+    StatusPipe(const std::string& path);
+    ~StatusPipe();
+    void Send(const std::string& str, unsigned long& dropped);
+    bool Flush();
+    void Discard(unsigned long& dropped);
+    bool IsBackedUp() { return !_unsent.empty() || !_queued.empty(); }
+    
+private:
+    bool Open();
+    bool TryWrite(const std::string& str);
+    
+    std::string _path;
+    int _readFd;
+    int _writeFd;
+    // remainder of a status only partially written to the pipe
+    std::string _unsent;
+    // the latest status that couldn't yet be started
+    std::string _queued;
+    bool _loggedBackup;
+};
 
 // Defines the interface to networks
 class NetworkInterface: public ICallback
 {
 public:   
-    NetworkInterface();
+    NetworkInterface(const Timer* pPublishTimer = NULL);
     ~NetworkInterface();
+    void AddStatusPipe(const std::string& path);
+    unsigned long GetCoalescedCount() { return _coalescedCount; }
+    unsigned long GetDroppedCount() { return _droppedCount; }
         
 private:
-    int _statusPushFd;
     std::string _statusJSON;
+    std::vector<StatusPipe*> _statusPipes;
+    const Timer* _pPublishTimer;
+    // when status was last published, or -1 if it hasn't been
+    long _lastPublishMillis;
+    bool _publishPending;
+    unsigned long _coalescedCount;
+    unsigned long _droppedCount;
+    // the delay before backed up pipes are next retried
+    long _retryMillis;
+    // when the pipes became backed up, or -1 if they aren't
+    long _backedUpSinceMillis;
     
     void Callback(EventType eventType, const EventData& data);
-    void SaveCurrentStatus(const PrinterStatus& status);
-    void SendStringToPipe(std::string str, int fileDescriptor);
+    void Publish();
+    void SaveCurrentStatus();
+    long GetTimeMillis();
+    long GetMillisSincePublish();
+    void ScheduleRetry(long delayMillis);
+    void RetryBackedUpPipes(bool backedUp);
 };
 
 
 #endif    // NETWORKINTERFACE_H
-
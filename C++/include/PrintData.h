@@ -26,6 +26,7 @@
 #define	PRINTDATA_H
 
 #include <string>
+#include <stdint.h>
 #include <Magick++.h>
 
 class PrintFileStorage;
@@ -41,10 +42,16 @@ public:
     virtual bool Move(const std::string& destination) = 0;
     virtual bool GetImageForLayer(int layer, Magick::Image* pImage) = 0;
     virtual int GetLayerCount() = 0;
+    bool GetLayerData(int layer, std::string& data, uint64_t& fingerprint);
+    bool DecodeLayerImage(int layer, const std::string& data, 
+                          Magick::Image* pImage);
     
     static PrintData* CreateFromNewData(const PrintFileStorage& storage,
         const std::string& dataParentDirectory, const std::string& newName);
     static PrintData* CreateFromExistingData(const std::string& printDataPath);
+
+private:
+    std::string GetSliceFileName(int layer);
 };
 
 #endif    // PRINTDATA_H
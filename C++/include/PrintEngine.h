@@ -26,6 +26,7 @@
 #define	PRINTENGINE_H
 
 #include <map>
+#include <vector>
 
 #include <boost/scoped_ptr.hpp>
 #include <Magick++.h>
@@ -39,6 +40,7 @@
 #include <LayerSettings.h>
 #include <ImageProcessor.h>
 #include <Settings.h>
+#include <LatencyHistogram.h>
 
 // high-level motor commands, that may result in multiple low-level commands
 enum HighLevelMotorCommand
@@ -57,6 +59,12 @@ enum HighLevelMotorCommand
 };
 
 constexpr double TEMPERATURE_MEASUREMENT_INTERVAL_SEC = 20.0;
+// how often to report the progress of a projector firmware upgrade
+constexpr double UPGRADE_PROGRESS_INTERVAL_SEC = 0.5;
+// margin allowed over the predicted time of a layer motion before it's 
+// considered to have timed out (e.g. due to a jam)
+constexpr double PREDICTED_MOTION_TIMEOUT_FACTOR = 1.05;
+constexpr double PREDICTED_MOTION_TIMEOUT_SEC = 1.0;
 
 class PrinterStateMachine;
 class PrintData;
@@ -75,6 +83,9 @@ struct ThreadData
     Projector*  pProjector;
     double      scaleFactor;
     bool        usePatternMode;
+    bool        measureCrossSection;
+    CrossSection crossSection;
+    uint64_t    measuredImageID;
 };
 
 
@@ -119,6 +130,7 @@ public:
     bool NeedsPreExposureDelay();
     double GetRemainingExposureTimeSec();
     bool DoorIsOpen();
+    void PrepareExposure();
     void ShowImage();
     void TurnProjectorOff();
     bool TryStartPrint();
@@ -142,11 +154,19 @@ public:
     void PauseMovement();
     void ResumeMovement();
     void ClearPendingMovement(bool withInterrupt = false);
+    void HoldSeparation();
+    void DiscardHeldSeparation();
     int  PadTimeout(double rawTime);
+    int  PadPredictedTimeout(double predictedTime);
     int GetTrayDeflection();
     double GetTrayDeflectionPauseTimeSec();
     bool NeedsTrayDeflectionPause();
     void GetCurrentLayerSettings();
+    void GetLayerSettings(int n, CurrentLayerSettings& cls);
+    void AdaptLayerSettings(const CrossSection& crossSection, 
+                            CurrentLayerSettings& cls);
+    void PrepareLayerMotions();
+    void EstimateLayerTimes();
     void DisableMotors() { _motor.DisableMotors(); }
     void SetPrintFeedback(PrintRating rating);
     bool PrintIsInProgress() { return _printerStatus._numLayers != 0; }
@@ -184,16 +204,23 @@ private:
     bool _alreadyOverheated;
     bool _inspectionRequested;
     bool _skipCalibration;
+    bool _separationHeld;
     double _remainingMotorTimeoutSec;
     LayerSettings _perLayer;
     int _currentZPosition;
     CurrentLayerSettings _cls;
+    // speed factor applied to the last layer's approach, by which to shorten 
+    // the wait that follows it (the next layer's pre-exposure delay)
+    double _approachWaitFactor;
+    std::vector<double> _remainingLayerTimesSec;
     boost::scoped_ptr<PrintData> _pPrintData;
     bool _demoModeRequested;
     ImageProcessor _imageProcessor;
     pthread_t _bgndThread;
     ThreadData _threadData;
     Magick::Image _image;
+    // time taken to start showing each layer's image during the current print
+    LatencyHistogram _exposureStartLatency;
     static ErrorCode _threadError;
     static const char* _threadErrorMsg;
 
@@ -217,10 +244,11 @@ private:
     void DoorCallback(char data);
     bool IsFirstLayer();
     bool IsBurnInLayer();
+    LayerType GetLayerType(int n);
     void HandleProcessDataFailed(ErrorCode errorCode, 
                                  const std::string& jobName);
     void ProcessData();
-    double GetLayerTimeSec(LayerType type);
+    double GetLayerTimeSec(const CurrentLayerSettings& cls);
     bool IsPrinterTooHot();
     void LogStatusAndSettings();
     int GetHomingTimeoutSec();
@@ -234,6 +262,8 @@ private:
     void USBDriveConnectedCallback(const std::string& deviceNode);
     void USBDriveDisconnectedCallback();
     static void* InBackground(void* context);
+    static uint64_t GetPreparedImageID(uint64_t fingerprint, 
+                                       double scaleFactor, bool usePatternMode);
 }; 
 
 #endif    // PRINTENGINE_H
@@ -0,0 +1,76 @@
+//  File:   PrintSimulator.h
+//  Runs a print in simulated time and reports how long each layer took
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PRINTSIMULATOR_H
+#define	PRINTSIMULATOR_H
+
+#include <vector>
+#include <array>
+#include <string>
+
+#include <ICallback.h>
+#include <Command.h>
+#include <PrinterStatus.h>
+
+class VirtualClock;
+
+// the time spent in each state during a layer
+typedef std::array<double, MaxPrintEngineState> StateTimes;
+
+// Subscribed to printer status updates, starts a print of the loaded print
+// data as soon as the printer is home, and follows its states in the virtual
+// clock's time, adding up the time spent in each state for each layer.  Once
+// the print ends (or fails), it writes the per-layer times to a CSV file,
+// logs a summary, and tells the event handler to exit.
+class PrintSimulator : public ICallback
+{
+public:
+    PrintSimulator(const VirtualClock& clock, ICommandTarget& printEngine,
+                   ICommandTarget& eventHandler, const char* reportPath);
+    void Callback(EventType eventType, const EventData& data);
+
+private:
+    void Follow(const PrinterStatus& status);
+    void Finish(const char* outcome);
+    bool WriteReport();
+
+    const VirtualClock& _clock;
+    ICommandTarget& _printEngine;
+    ICommandTarget& _eventHandler;
+    std::string _reportPath;
+    bool _started;
+    bool _finished;
+    double _startSec;
+    double _lastSec;
+    // the layer being printed as of the last status
+    int _layer;
+    int _numLayers;
+    int _estimatedSec;
+    // the states entered and not yet left, innermost last
+    std::vector<PrintEngineState> _states;
+    // the time spent in each state for each layer, with that before the
+    // first layer and after the last one kept for layer 0
+    std::vector<StateTimes> _layerTimes;
+};
+
+#endif    // PRINTSIMULATOR_H
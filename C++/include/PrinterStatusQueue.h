@@ -26,6 +26,7 @@
 #define PRINTERSTATUSQUEUE_H
 
 #include <queue>
+#include <vector>
 
 #include "IResource.h"
 #include "PrinterStatus.h"
@@ -37,7 +38,7 @@ public:
     ~PrinterStatusQueue();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     void Push(const PrinterStatus& printerStatus);
     bool QualifyEvents(uint32_t events) const;
 
@@ -50,6 +51,8 @@ private:
 private:
     int _fd;
     std::queue<PrinterStatus> _queue;
+    // statuses returned by the last read, reused to avoid reallocating them
+    std::vector<PrinterStatus> _delivered;
 };
 
 #endif    // PRINTERSTATUSQUEUE_H
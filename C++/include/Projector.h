@@ -26,6 +26,12 @@
 #define PROJECTOR_H
 
 #include <memory>
+#include <atomic>
+#include <pthread.h>
+#include <stdint.h>
+
+// identifies an image whose contents aren't known
+constexpr uint64_t NO_IMAGE_ID = 0;
 
 class I_I2C_Device;
 class IFrameBuffer;
@@ -39,8 +45,12 @@ class Projector
 public:
     Projector(const I_I2C_Device& i2cDevice);
     virtual ~Projector();
-    void SetImage(Magick::Image& image);
+    void SetImage(Magick::Image& image, uint64_t imageID = NO_IMAGE_ID);
+    uint64_t GetImageID() { return _imageID; }
+    void StageCurrentImage();
+    void PrepareLEDs();
     void ShowCurrentImage();
+    void TurnLEDsOffAfter(double seconds);
     void ShowBlack();
     void ShowWhite();
     bool DisableGamma();
@@ -54,19 +64,41 @@ public:
     bool SetVideoResolution(int width, int height);
 
 private:
+    void SetLEDCurrent();
+    void ForgetLEDCurrent();
     void TurnLEDOn();
     void TurnLEDOff();
+    void CancelLEDsOff();
+    void StopExposureThread();
+    static void* ExposureThread(void* context);
     bool PollStatus();
     
     bool _canControlViaI2C;
     bool _supportsPatternMode;
     const I_I2C_Device& _i2cDevice;
     unsigned long int _totalProgramBytes; 
-    unsigned long int _programBytesWritten;
-    unsigned long int _runningChecksum;
-    bool _programmingComplete;
+    std::atomic<unsigned long int> _programBytesWritten;
+    std::atomic<bool> _programmingComplete;
     FILE* _pFirmwareFile;
+    pthread_t _upgradeThread;
+    bool _upgradeThreadStarted;
+    std::atomic<bool> _upgradeFailed;
+    std::atomic<bool> _cancelUpgrade;
     std::unique_ptr<IFrameBuffer> _pFrameBuffer;
+    uint64_t _imageID;
+    // the LED current last written to the projector (or 0 if not known), and 
+    // the settings revision it was read from, so that it's only written when
+    // the setting changes
+    int _ledCurrent;
+    unsigned long _ledCurrentRevision;
+    // the thread that ends exposures by turning off the LEDs at the time set 
+    // in _ledsOffMicros (from GetMicros), if that's not 0 
+    pthread_t _exposureThread;
+    bool _exposureThreadStarted;
+    bool _exitExposureThread;
+    uint64_t _ledsOffMicros;
+    pthread_mutex_t _exposureMutex;
+    pthread_cond_t _exposureChanged;
     
     bool I2CWrite(unsigned char registerAddress, unsigned char data);
     bool I2CWrite(unsigned char registerAddress, const unsigned char* data, 
@@ -77,8 +109,15 @@ private:
                          unsigned numBytesToRead);
     unsigned long int ReadChecksum(unsigned long int startAddress, 
                                    unsigned long int numBytes);
-    void ProgramFlash(unsigned char *buf, unsigned int numBytes);
+    bool ProgramFlash(const unsigned char *buf, unsigned int numBytes);
     bool EraseSector(unsigned long sector_address);
+    bool PrepareUpgrade();
+    static void* UpgradeThread(void* context);
+    bool ProgramFirmware();
+    void StopUpgrade();
+    void SetFlashRange(unsigned long int startAddress, 
+                       unsigned long int numBytes);
+    bool AwaitFlashReady(unsigned int settleTime, unsigned int timeout);
 };
 
 #endif  // PROJECTOR_H
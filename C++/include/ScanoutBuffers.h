@@ -0,0 +1,72 @@
+//  File:   ScanoutBuffers.h
+//  Stages, swaps, and fills layer images in a set of scan-out buffers
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCANOUTBUFFERS_H
+#define	SCANOUTBUFFERS_H
+
+#include <vector>
+
+#include "IFrameBuffer.h"
+#include "ScanoutFormat.h"
+
+// the number of scan-out buffers, the last of which is always black
+constexpr int NUM_SCANOUT_BUFFERS = 3;
+constexpr int BLACK_BUFFER = 2;
+
+// Copies each image into a scan-out buffer ahead of showing it, alternating 
+// between two image buffers so that the next image is staged in one while the
+// other may be displayed, and shows black by displaying the third buffer.  
+// Scanning out the buffer to be displayed is left to the derived class.
+class ScanoutBuffers : public IFrameBuffer
+{
+public:
+    virtual ~ScanoutBuffers() {}
+    void Blit(Magick::Image& image);
+    void Fill(uint8_t value);
+    void Stage();
+    void Swap();
+
+protected:
+    ScanoutBuffers(int width, int height);
+    void SetBuffers(const ScanoutFormat& format, int pitch,
+                    uint8_t* const pBuffers[NUM_SCANOUT_BUFFERS]);
+    int GetDisplayed() const { return _displayed; }
+    virtual void Display(int buffer) = 0;
+
+private:
+    void Show(int buffer);
+    
+    int _width;
+    int _height;
+    const ScanoutFormat* _pFormat;
+    int _pitch;
+    uint8_t* _pBuffers[NUM_SCANOUT_BUFFERS];
+    int _displayed;
+    // the image buffer in which the next image is staged
+    int _staging;
+    // true if the image has been copied into the staging buffer
+    bool _staged;
+    std::vector<uint8_t> _image;
+};
+
+#endif    // SCANOUTBUFFERS_H
@@ -0,0 +1,55 @@
+//  File:   ScanoutFormat.h
+//  Pixel formats in which layer images can be scanned out to the projector
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCANOUTFORMAT_H
+#define	SCANOUTFORMAT_H
+
+#include <stdint.h>
+
+// a pixel format in which the display pipeline may scan out images
+struct ScanoutFormat
+{
+    int bitsPerPixel;
+    int depth;
+    const char* name;
+};
+
+// the scan-out formats that can show the 8-bit gray layer images.  RGB565 
+// keeps only the top 5 or 6 bits of each gray, so it's only used when asked 
+// for (as by the frame buffer benchmark), never chosen automatically.
+constexpr int NUM_SCANOUT_FORMATS = 3;
+constexpr ScanoutFormat SCANOUT_FORMATS[NUM_SCANOUT_FORMATS] =
+{
+    {8,  8,  "8-bit indexed gray"},
+    {16, 16, "RGB565"},
+    {32, 24, "XRGB8888"}
+};
+constexpr int INDEXED_GRAY_FORMAT = 0;
+constexpr int XRGB8888_FORMAT     = 2;
+
+void WriteGrayImage(const ScanoutFormat& format, const uint8_t* pImage,
+                    int width, int height, uint8_t* pBuffer, int pitch);
+void FillGray(const ScanoutFormat& format, uint8_t value, int width, 
+              int height, uint8_t* pBuffer, int pitch);
+
+#endif    // SCANOUTFORMAT_H
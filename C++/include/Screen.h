@@ -53,6 +53,9 @@ class IDisplay
 public: 
     virtual void ShowText(Alignment align, unsigned char x, unsigned char y, 
              unsigned char size, int color, std::string text) = 0;
+    virtual void UpdateText(int lineID, Alignment align, unsigned char x, 
+             unsigned char y, unsigned char size, int color, 
+             std::string text) = 0;
     virtual void AnimateLEDs(int animationNum) = 0;
     virtual void ShowLEDs(int numLEDs) = 0;
     bool _forceDisplay;
@@ -84,16 +87,21 @@ private:
     ScreenLine() {} // don't allow default construction  
 };
 
+// identifies a line that isn't updated in place
+constexpr int NO_LINE_ID = -1;
+
 class ReplaceableLine : public ScreenLine
 {
 public:
     ReplaceableLine(Alignment align, unsigned char x, unsigned char y, 
-                    unsigned char size, int color, std::string text);
+                    unsigned char size, int color, std::string text,
+                    int lineID = NO_LINE_ID);
     void ReplaceWith(std::string replacement);
     void Draw(IDisplay* pDisplay);
     
 protected:
     std::string _replacedText;
+    int _lineID;
 };
 
 class ScreenText : public IDrawable
@@ -58,8 +58,8 @@
 
 #define PRINTING_LINE1              Center,     64,     8,      1,  0xFFFF,     "Printing"
 #define PRINTING_LINE2              Center,     64,     24,     1,  0xFFFF,     "%s" // job name
-#define PRINTING_CLEAR_LINE3        Center,     64,     42,     2,  0x0000,     "%s" // clears previous time
 #define PRINTING_LINE3              Center,     64,     42,     2,  0xFFFF,     "%s" // shows new time
+#define PRINTING_TIME_LINE_ID   0 // the time is updated in place
 #define PRINTING_LINE4              Center,     64,     80,     1,  0xFFFF,     "remaining."
 #define PRINTING_LINE5              Center,     64,     96,     1,  0xFFFF,     "%s" // user name
 #define PRINTING_BTN1_LINE2         Left,       0,      112,    1,  0xFFFF,     "Cancel"
@@ -59,6 +59,8 @@ constexpr const char* IMAGE_SCALE_FACTOR     = "ImageScaleFactor";
 constexpr const char* PAT_MODE_SCALE_FACTOR  = "PatternModeImageScaleFactor";
 constexpr const char* USB_DRIVE_DATA_DIR     = "USBDriveDataDir";
 constexpr const char* FW_VERSION             = "FirmwareVersion";
+constexpr const char* STATUS_COALESCE_MS     = "StatusCoalesceMS";
+constexpr const char* EVENT_CALLBACK_BUDGET  = "EventCallbackBudgetMS";
 
 // motor control settings for moving between layers
 // FL = first layer, BI = burn-in layer, ML = model Layer
@@ -145,8 +147,25 @@ constexpr const char* R_START_PRINT_SPEED    = "RStartPrintSpeedRPM";
 constexpr const char* R_START_PRINT_ANGLE    = "RStartPrintPositionMillidegrees";
 
 constexpr const char* HOME_ON_APPROACH       = "RotateHomeOnApproach";
+constexpr const char* COORDINATED_MOTION     = "CoordinatedRotateAndZ";
 constexpr const char* USE_PATTERN_MODE       = "UsePatternMode";
 
+// settings for adapting model layers' separation and approach to the area 
+// they cure
+constexpr const char* ADAPTIVE_MOTION        = "AdaptiveMotion";
+constexpr const char* ADAPTIVE_SMALL_AREA    = "AdaptiveSmallAreaPercent";
+constexpr const char* ADAPTIVE_LARGE_AREA    = "AdaptiveLargeAreaPercent";
+constexpr const char* ADAPTIVE_SPEED_FACTOR  = "AdaptiveMaxSpeedFactor";
+constexpr const char* ADAPTIVE_MAX_ISLANDS   = "AdaptiveMaxIslands";
+
+// settings for adapting model layers' exposure to how much of the area they
+// cure is made of thin features
+constexpr const char* ADAPTIVE_EXPOSURE      = "AdaptiveExposure";
+constexpr const char* ADAPTIVE_SOLID_EDGE    = "AdaptiveSolidEdgePercent";
+constexpr const char* ADAPTIVE_THIN_EDGE     = "AdaptiveThinEdgePercent";
+constexpr const char* ADAPTIVE_MIN_EXPOSURE  = "AdaptiveMinExposureFactor";
+constexpr const char* ADAPTIVE_MAX_EXPOSURE  = "AdaptiveMaxExposureFactor";
+
 // The class that handles configuration and print options
 class Settings 
 {
@@ -170,6 +189,7 @@ public:
     std::string GetAllSettingsAsJSONString();
     bool SetFromJSONString(const std::string& str);
     bool SetFromFile(const std::string& filename);
+    unsigned long GetRevision() { return _revision; }
     
 protected:
     std::string _settingsPath;
@@ -184,6 +204,9 @@ protected:
     Document _settingsDoc;
     std::string _defaultJSON;
     std::string _defaultPrintSpecificJSON;
+    // incremented whenever any setting may have changed, so that clients can 
+    // cache values derived from settings 
+    unsigned long _revision;
 };
 
 // Singleton for sharing settings among all components
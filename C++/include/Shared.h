@@ -46,6 +46,13 @@ constexpr const char* PRIMARY_REGISTRATION_INFO_FILE = "/tmp/printer_registratio
 
 // path to file with latest printer status
 constexpr const char* PRINTER_STATUS_FILE            = "/run/printer_status";
+constexpr const char* PRINTER_STATUS_TEMP_FILE       = "/run/printer_status.tmp";
+// name of shared memory status page (appears as /dev/shm/printer_status)
+constexpr const char* PRINTER_STATUS_PAGE            = "/printer_status";
+// path to file with event handler latency statistics
+constexpr const char* EVENT_STATS_FILE               = "/run/event_stats";
+// path to file with the per-layer timing of a simulated print
+constexpr const char* SIMULATION_REPORT_FILE         = "/run/simulation_report.csv";
 
 // path to file written by smith-client, indicating Internet connection status
 constexpr const char* SMITH_STATE_FILE               = "/var/local/smith_state";
@@ -84,6 +91,7 @@ constexpr const char* CMD_BTNS_1_AND_2                    = "BUTTONS1AND2";
 constexpr const char* CMD_BTNS_1_AND_2_HOLD               = "BUTTONS1AND2HOLD";
 constexpr const char* CMD_SHOW_WHITE                      = "SHOWWHITE";
 constexpr const char* CMD_SHOW_BLACK                      = "SHOWBLACK";
+constexpr const char* CMD_EVENT_STATS                     = "EVENTSTATS";
 
 // JSON keys for PrinterStatus sent to web
 constexpr const char* STATE_PS_KEY                  = "state";
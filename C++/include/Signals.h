@@ -35,7 +35,7 @@ public:
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
     bool QualifyEvents(uint32_t events) const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
  
 private:
     // This class owns a file based resource
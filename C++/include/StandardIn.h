@@ -24,6 +24,8 @@
 #ifndef STANDARDIN_H
 #define	STANDARDIN_H
 
+#include <string>
+
 #include "IResource.h"
 
 class StandardIn : public IResource
@@ -33,8 +35,12 @@ public:
     ~StandardIn();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     bool QualifyEvents(uint32_t events) const;
+    
+private:
+    // the last line read, which remains valid until the next read
+    std::string _line;
 };
 
 #endif    // STANDARDIN_H
@@ -0,0 +1,103 @@
+//  File:   StatusPage.h
+//  Publishes printer status in a shared memory page that local clients can 
+//  poll without system calls or parsing
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STATUSPAGE_H
+#define	STATUSPAGE_H
+
+#include <stdint.h>
+
+#include <PrinterStatus.h>
+#include <ICallback.h>
+
+constexpr uint32_t STATUS_PAGE_MAGIC         = 0x52424D45; // "EMBR"
+constexpr uint32_t STATUS_PAGE_VERSION       = 1;
+constexpr int      STATUS_PAGE_JOB_ID_LEN    = 64;
+constexpr int      STATUS_PAGE_FILENAME_LEN  = 256;
+
+// The fixed layout of the status page.  All fields are naturally aligned so 
+// that readers in other languages can use the offsets directly.
+// The sequence number is odd while the page is being written, and is 
+// increased by two for each complete update, so readers copy the page and 
+// then check that the sequence number is even and unchanged.
+struct StatusPageData
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sequence;
+    int32_t  state;
+    int32_t  change;
+    int32_t  UISubState;
+    int32_t  isError;
+    int32_t  errorCode;
+    int32_t  errnum;
+    int32_t  numLayers;
+    int32_t  currentLayer;
+    int32_t  estimatedSecondsRemaining;
+    double   temperature;
+    int32_t  printRating;
+    int32_t  canLoadPrintData;
+    int32_t  canUpgradeProjector;
+    char     localJobUniqueID[UUID_LEN + 1];
+    char     jobID[STATUS_PAGE_JOB_ID_LEN];
+    char     usbDriveFileName[STATUS_PAGE_FILENAME_LEN];
+};
+
+// Writes each printer status update into the shared memory status page.
+class StatusPage : public ICallback
+{
+public:
+    StatusPage(const char* name);
+    ~StatusPage();
+    void Write(const PrinterStatus& status);
+    
+private:
+    // This class owns a shared memory resource
+    // Disable copy construction and copy assignment
+    StatusPage(const StatusPage&);
+    StatusPage& operator=(const StatusPage&);
+    void Callback(EventType eventType, const EventData& data);
+
+    std::string _name;
+    StatusPageData* _pPage;
+};
+
+// Gives local clients read-only access to the status page.
+class StatusPageReader
+{
+public:
+    StatusPageReader(const char* name);
+    ~StatusPageReader();
+    uint32_t GetSequence() const;
+    bool Read(StatusPageData& snapshot) const;
+    
+private:
+    // This class owns a shared memory resource
+    // Disable copy construction and copy assignment
+    StatusPageReader(const StatusPageReader&);
+    StatusPageReader& operator=(const StatusPageReader&);
+
+    const StatusPageData* _pPage;
+};
+
+#endif    // STATUSPAGE_H
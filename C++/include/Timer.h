@@ -26,16 +26,21 @@
 
 #include "IResource.h"
 
+class VirtualClock;
+
+// When given a virtual clock, a timer expires in that clock's simulated time
+// rather than in real time.
 class Timer : public IResource
 {
 public:
-    Timer();
+    Timer(VirtualClock* pVirtualClock = NULL);
     ~Timer();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     void Start(double expirationTimeSeconds) const;
     double GetRemainingTimeSeconds() const;
+    long GetTimeMillis() const;
     void Clear() const;
     bool QualifyEvents(uint32_t events) const;
 
@@ -48,6 +53,7 @@ private:
 private:
     int _fd;
     size_t _dataSize;
+    VirtualClock* _pVirtualClock;
 };
 
 #endif    // TIMER_H
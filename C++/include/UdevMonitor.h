@@ -40,7 +40,7 @@ public:
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
     bool QualifyEvents(uint32_t events) const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
 
 private:
     // this class owns a file based resource
@@ -54,6 +54,8 @@ private:
     udev_monitor* _pMonitor;
     int _fd;
     const std::string _action;
+    // the last device node read, which remains valid until the next read
+    std::string _node;
 };
 
 #endif    // UDEVMONITOR_H
@@ -0,0 +1,54 @@
+//  File:   VirtualClock.h
+//  Simulated time, for running prints without waiting for real timers
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef VIRTUALCLOCK_H
+#define	VIRTUALCLOCK_H
+
+#include <stdint.h>
+#include <map>
+
+// A clock whose time only moves when it's told to, by jumping straight to the
+// next alarm set on it.  Each alarm belongs to an event file descriptor
+// (eventfd), to which the clock writes an expiration count when its time is
+// reached, so that it can be polled by the event handler just like a timer.
+class VirtualClock
+{
+public:
+    VirtualClock();
+    double GetSeconds() const;
+    void SetAlarm(int fd, double seconds);
+    void ClearAlarm(int fd);
+    double GetRemainingSeconds(int fd) const;
+    bool AdvanceToNextAlarm();
+
+private:
+    // Disable copy construction and copy assignment
+    VirtualClock(const VirtualClock&);
+    VirtualClock& operator=(const VirtualClock&);
+
+    uint64_t _nowMicros;
+    // the time at which each alarm expires, by its file descriptor
+    std::map<int, uint64_t> _alarms;
+};
+
+#endif    // VIRTUALCLOCK_H
@@ -37,6 +37,7 @@ public:
     ~ImageWritingFrameBuffer();
     void Blit(Magick::Image& image);
     void Fill(uint8_t value);
+    void Stage();
     void Swap();
     
 private:
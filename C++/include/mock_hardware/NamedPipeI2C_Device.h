@@ -40,13 +40,13 @@ public:
     bool Write(unsigned char registerAddress, const unsigned char* data, 
                int length) const;
     unsigned char Read(unsigned char registerAddress) const;
-    int Read(unsigned char registerAddress, unsigned char* data, 
-             int length) const;
+    bool Read(unsigned char registerAddress, unsigned char* data, 
+              int length) const;
     unsigned char ReadWhenReady(unsigned char registerAddress, 
                                 unsigned char readyStatus) const;
-    int ReadWhenReady(unsigned char registerAddress, 
-                      const unsigned char* data, int length,
-                      unsigned char readyStatus) const;
+    bool ReadWhenReady(unsigned char registerAddress, 
+                       unsigned char* data, int length,
+                       unsigned char readyStatus) const;
 
 private:
     NamedPipeI2C_Device(const NamedPipeI2C_Device&);
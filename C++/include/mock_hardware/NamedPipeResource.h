@@ -33,7 +33,7 @@ public:
     ~NamedPipeResource();
     uint32_t GetEventTypes() const;
     int GetFileDescriptor() const;
-    EventDataVec Read();
+    void Read(EventDataVec& eventData);
     bool QualifyEvents(uint32_t events) const;
 
 private:
@@ -0,0 +1,65 @@
+//  File:   SimulatedFrontPanel.h
+//  Front panel that's always ready and never pressed (for dry runs of prints)
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MOCKHARDWARE_SIMULATEDFRONTPANEL_H
+#define MOCKHARDWARE_SIMULATEDFRONTPANEL_H
+
+#include "I_I2C_Device.h"
+
+// Accepts and discards everything written to it, and reads as not busy with 
+// no buttons pressed, so that a simulated print needn't wait on anything
+// reading the front panel's named pipes.
+class SimulatedFrontPanel : public I_I2C_Device
+{
+public:
+    SimulatedFrontPanel() {}
+    ~SimulatedFrontPanel() {}
+
+    bool Write(unsigned char /*data*/) const { return true; }
+    bool Write(unsigned char /*registerAddress*/, unsigned char /*data*/) const
+        { return true; }
+    bool Write(unsigned char /*registerAddress*/, 
+               const unsigned char* /*data*/, int /*length*/) const 
+        { return true; }
+    unsigned char Read(unsigned char /*registerAddress*/) const { return 0x00; }
+    bool Read(unsigned char /*registerAddress*/, unsigned char* data,
+              int length) const
+    {
+        for (int i = 0; i < length; i++)
+            data[i] = 0x00;
+        return true;
+    }
+    unsigned char ReadWhenReady(unsigned char /*registerAddress*/,
+                                unsigned char /*readyStatus*/) const
+        { return 0x00; }
+    bool ReadWhenReady(unsigned char registerAddress,
+                       unsigned char* data, int length,
+                       unsigned char /*readyStatus*/) const
+        { return Read(registerAddress, data, length); }
+
+private:
+    SimulatedFrontPanel(const SimulatedFrontPanel&);
+    SimulatedFrontPanel& operator=(const SimulatedFrontPanel&);
+};
+
+#endif  // MOCKHARDWARE_SIMULATEDFRONTPANEL_H
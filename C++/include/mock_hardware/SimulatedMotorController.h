@@ -0,0 +1,90 @@
+//  File:   SimulatedMotorController.h
+//  Motor controller that completes motions after their predicted times, in
+//  simulated time (for dry runs of prints)
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MOCKHARDWARE_SIMULATEDMOTORCONTROLLER_H
+#define MOCKHARDWARE_SIMULATEDMOTORCONTROLLER_H
+
+#include <vector>
+
+#include "I_I2C_Device.h"
+#include "MotorCommand.h"
+#include "MotionTimePredictor.h"
+
+class VirtualClock;
+class Timer;
+
+// Accepts motor commands the way the motor controller firmware does: settings
+// take effect as they arrive, while actions are held until an interrupt is
+// requested, and then performed in turn.  Rather than moving anything, it
+// predicts how long the actions take and signals the interrupt (a timer on
+// the same virtual clock) when that time has passed.
+class SimulatedMotorController : public I_I2C_Device
+{
+public:
+    SimulatedMotorController(const VirtualClock& clock, const Timer& interrupt);
+    ~SimulatedMotorController();
+
+    bool Write(unsigned char data) const;
+    bool Write(unsigned char registerAddress, unsigned char data) const;
+    bool Write(unsigned char registerAddress, const unsigned char* data,
+               int length) const;
+    unsigned char Read(unsigned char registerAddress) const;
+    bool Read(unsigned char registerAddress, unsigned char* data,
+              int length) const;
+    unsigned char ReadWhenReady(unsigned char registerAddress,
+                                unsigned char readyStatus) const;
+    bool ReadWhenReady(unsigned char registerAddress,
+                       unsigned char* data, int length,
+                       unsigned char readyStatus) const;
+
+private:
+    SimulatedMotorController(const SimulatedMotorController&);
+    SimulatedMotorController& operator=(const SimulatedMotorController&);
+
+    void Handle(const MotorCommand& command) const;
+    void Release() const;
+    void Perform(const MotorCommand& command) const;
+
+    const VirtualClock& _clock;
+    const Timer& _interrupt;
+    // the I2C interface is const, but writes change the controller's state
+    mutable MotionTimePredictor _predictor;
+    // actions (and the settings following them) waiting for an interrupt
+    // request
+    mutable std::vector<MotorCommand> _pending;
+    // when the actions in progress (if any) will be completed
+    mutable double _busyUntilSec;
+    // the time left for actions that were paused
+    mutable double _pausedSec;
+    // where each axis is, relative to its home position (in the units of its 
+    // moves), so that homing takes only as long as getting there, and any 
+    // distance linked to the next move of the other axis
+    mutable int _zPosition;
+    mutable int _rotPosition;
+    mutable int _linkedZ;
+    mutable int _linkedRot;
+    mutable unsigned char _status;
+};
+
+#endif  // MOCKHARDWARE_SIMULATEDMOTORCONTROLLER_H
@@ -25,9 +25,12 @@
 #ifndef UTILS_H
 #define	UTILS_H
 
+#include <stdint.h>
+
 constexpr int UUID_LEN = 36;  // characters in hex ASCII string for a UUID
 
 long GetMillis();
+uint64_t GetMicros();
 void StartStopwatch();
 long StopStopwatch();
 std::string GetFirmwareVersion();
@@ -36,6 +36,7 @@
 #include <TerminalUI.h>
 #include <Logger.h>
 #include <NetworkInterface.h>
+#include <StatusPage.h>
 #include <CommandInterpreter.h>
 #include <Settings.h>
 #include <MessageStrings.h>
@@ -55,11 +56,16 @@
 #include "I2C_Device.h"
 #include "Projector.h"
 #include "HardwareFactory.h"
+#include "VirtualClock.h"
+#include "PrintSimulator.h"
 
 using namespace std;
 
 // command line argument to suppress use of stdin & stdout
 constexpr const char* NO_STDIO = "--nostdio";
+// command line argument to print the loaded print data in simulated time, 
+// with simulated hardware, and report the time taken by each layer
+constexpr const char* SIMULATE = "--simulate";
 
 // for setting DMA priority to avoid video flicker
 constexpr unsigned long MAP_SIZE = 4096UL;
@@ -76,11 +82,30 @@ int main(int argc, char** argv)
         
         Magick::InitializeMagick("");
         
-        // see if we should support keyboard input and TerminalUI output
+        // see if we should support keyboard input and TerminalUI output,
+        // and if we should simulate a print
         bool useStdio = true;
-        if (argc > 1) 
+        bool simulate = false;
+        for (int i = 1; i < argc; i++) 
         {
-            useStdio = strcmp(argv[1], NO_STDIO) != 0;
+            if (strcmp(argv[i], NO_STDIO) == 0)
+                useStdio = false;
+            else if (strcmp(argv[i], SIMULATE) == 0)
+                simulate = true;
+        }
+        
+        // when simulating, timers and hardware work in simulated time, so 
+        // that a print runs as fast as its events can be handled
+        VirtualClock virtualClock;
+        VirtualClock* pVirtualClock = NULL;
+        if (simulate)
+        {
+            if (!HardwareFactory::Simulate(virtualClock))
+            {
+                Logger::LogError(LOG_ERR, errno, SimulationNotSupported);
+                return 1;
+            }
+            pVirtualClock = &virtualClock;
         }
         
         // report the firmware version, board serial number, and startup message
@@ -113,33 +138,37 @@ int main(int argc, char** argv)
         // prevent video flickering by tweaking the value of REG_PR_OLD_COUNT
         // see https://groups.google.com/forum/#!msg/beagleboard/GjxRGeLdmRw/dx-bOXBPBgAJ
         // and http://www.lartmaker.nl/lartware/port/devmem2.c 
-        int fd = open(MEMORY_DEVICE, O_RDWR | O_SYNC);
-        if(fd < 0)
+        // (there's no video to flicker when simulating)
+        if (!simulate)
         {
-            Logger::LogError(LOG_ERR, errno, CantOpenMemoryDevice);
-            return 1;
-        }
+            int fd = open(MEMORY_DEVICE, O_RDWR | O_SYNC);
+            if(fd < 0)
+            {
+                Logger::LogError(LOG_ERR, errno, CantOpenMemoryDevice);
+                return 1;
+            }
 
-        // map one page 
-        void* mapBase = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, 
-                             fd, REG_PR_OLD_COUNT & ~MAP_MASK);
-        if(mapBase == MAP_FAILED)
-        {
-            Logger::LogError(LOG_ERR, errno,CantMapPriorityRegister);
-            return 1;
-        }
+            // map one page 
+            void* mapBase = mmap(0, MAP_SIZE, PROT_READ | PROT_WRITE, 
+                                 MAP_SHARED, fd, REG_PR_OLD_COUNT & ~MAP_MASK);
+            if(mapBase == MAP_FAILED)
+            {
+                Logger::LogError(LOG_ERR, errno,CantMapPriorityRegister);
+                return 1;
+            }
 
-        void* addr = ((char*)mapBase) + (REG_PR_OLD_COUNT & MAP_MASK);
+            void* addr = ((char*)mapBase) + (REG_PR_OLD_COUNT & MAP_MASK);
 
-        *((unsigned long *) addr) = PR_OLD_COUNT_VALUE;
+            *((unsigned long *) addr) = PR_OLD_COUNT_VALUE;
 
-        if(munmap(mapBase, MAP_SIZE) < 0)
-        {
-            Logger::LogError(LOG_ERR, errno, CantUnMapPriorityRegister);
-            return 1;
-        }
+            if(munmap(mapBase, MAP_SIZE) < 0)
+            {
+                Logger::LogError(LOG_ERR, errno, CantUnMapPriorityRegister);
+                return 1;
+            }
 
-        close(fd);        
+            close(fd);        
+        }
         
         Settings& settings = PrinterSettings::Instance();
         
@@ -170,6 +199,11 @@ int main(int argc, char** argv)
             }
         }
              
+        // there's no rotation sensor to detect jams with when simulating 
+        // (this isn't saved, so it only lasts for the simulation)
+        if (simulate)
+            settings.Set(DETECT_JAMS, 0);
+        
         // ensure directories exist
         MakePath(settings.GetString(PRINT_DATA_DIR));
         MakePath(settings.GetString(DOWNLOAD_DIR));
@@ -187,17 +221,19 @@ int main(int argc, char** argv)
 
         // create the projector
         I2C_Device projectorI2cDevice(PROJECTOR_SLAVE_ADDRESS,
-                I2C0_PORT);
+                I2C0_PORT, NormalI2cPriority);
         Projector projector(projectorI2cDevice);
 
         EventHandler eh;
+        eh.SetVirtualClock(pVirtualClock);
 
         StandardIn standardIn;
         CommandPipe commandPipe;
         PrinterStatusQueue printerStatusQueue;
-        Timer exposureTimer;
-        Timer temperatureTimer;
-        Timer delayTimer;
+        Timer exposureTimer(pVirtualClock);
+        Timer temperatureTimer(pVirtualClock);
+        Timer delayTimer(pVirtualClock);
+        Timer statusPublishTimer(pVirtualClock);
         GPIO_Interrupt doorSensorGPIOInterrupt(DOOR_SENSOR_PIN,
                 GPIO_INTERRUPT_EDGE_BOTH);
         GPIO_Interrupt rotationSensorGPIOInterrupt(ROTATION_SENSOR_PIN,
@@ -207,7 +243,7 @@ int main(int argc, char** argv)
         UdevMonitor usbDriveDisconnectionMonitor(UDEV_SUBSYSTEM_BLOCK,
                 UDEV_DEVTYPE_PARTITION, UDEV_ACTION_REMOVE);
         
-        Timer motorTimeoutTimer;
+        Timer motorTimeoutTimer(pVirtualClock);
         I2C_Resource motorControllerTimeout(motorTimeoutTimer,
                 *pMotorControllerI2cDevice, MC_STATUS_REG);
         
@@ -227,6 +263,7 @@ int main(int argc, char** argv)
         eh.AddEvent(ExposureEnd, &exposureTimer);
         eh.AddEvent(TemperatureTimer, &temperatureTimer);
         eh.AddEvent(DelayEnd, &delayTimer);
+        eh.AddEvent(StatusPublishTimer, &statusPublishTimer);
         eh.AddEvent(DoorInterrupt, &doorSensorGPIOInterrupt);
         eh.AddEvent(RotationInterrupt, &rotationSensorGPIOInterrupt);
         eh.AddEvent(Signal, &signals);
@@ -295,8 +332,23 @@ int main(int argc, char** argv)
         eh.Subscribe(Signal, &eh);
         
         // also connect a network interface, subscribed to printer status events
-        NetworkInterface networkIF;
+        // and to the timer it uses to publish coalesced status updates
+        NetworkInterface networkIF(&statusPublishTimer);
         eh.Subscribe(PrinterStatusUpdate, &networkIF);
+        eh.Subscribe(StatusPublishTimer, &networkIF);
+        
+        // and a shared memory status page for local clients, which the 
+        // printer can do without if it can't be created
+        std::unique_ptr<StatusPage> pStatusPage;
+        try
+        {
+            pStatusPage.reset(new StatusPage(PRINTER_STATUS_PAGE));
+            eh.Subscribe(PrinterStatusUpdate, pStatusPage.get());
+        }
+        catch (const std::exception& e)
+        {
+            Logger::LogMessage(LOG_WARNING, e.what());
+        }
         
         if (useStdio)
         {
@@ -305,6 +357,16 @@ int main(int argc, char** argv)
             eh.Subscribe(PrinterStatusUpdate, &terminal);
         }
         
+        // when simulating, print the loaded print data as soon as the 
+        // printer is ready, and exit once it's done
+        std::unique_ptr<PrintSimulator> pPrintSimulator;
+        if (simulate)
+        {
+            pPrintSimulator.reset(new PrintSimulator(virtualClock, pe, eh, 
+                                                     SIMULATION_REPORT_FILE));
+            eh.Subscribe(PrinterStatusUpdate, pPrintSimulator.get());
+        }
+        
         // start the print engine's state machine
         pe.Begin();
 
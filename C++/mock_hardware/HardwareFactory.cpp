@@ -28,15 +28,43 @@
 #include "mock_hardware/NamedPipeResource.h"
 #include "mock_hardware/NamedPipeI2C_Device.h"
 #include "mock_hardware/ImageWritingFrameBuffer.h"
+#include "mock_hardware/SimulatedMotorController.h"
+#include "mock_hardware/SimulatedFrontPanel.h"
+#include "Timer.h"
+
+// the clock for simulated hardware, or NULL when using the named pipes
+static VirtualClock* pVirtualClock = NULL;
+
+// the simulated motor controller's interrupt, created along with it and 
+// handed out when its interrupt resource is created
+static std::unique_ptr<Timer> pMotorControllerInterrupt;
+
+// Creates simulated hardware from here on, working in the given clock's 
+// simulated time rather than communicating over the named pipes.
+bool HardwareFactory::Simulate(VirtualClock& clock)
+{
+    pVirtualClock = &clock;
+    return true;
+}
 
 I2C_DevicePtr HardwareFactory::CreateMotorControllerI2cDevice()
 {
+    if (pVirtualClock)
+    {
+        pMotorControllerInterrupt.reset(new Timer(pVirtualClock));
+        return I2C_DevicePtr(new SimulatedMotorController(*pVirtualClock,
+                                                *pMotorControllerInterrupt));
+    }
+    
     return I2C_DevicePtr(new NamedPipeI2C_Device(
             MOTOR_CONTROLLER_I2C_READ_PIPE, MOTOR_CONTROLLER_I2C_WRITE_PIPE));
 }
 
 I2C_DevicePtr HardwareFactory::CreateFrontPanelI2cDevice()
 {
+    if (pVirtualClock)
+        return I2C_DevicePtr(new SimulatedFrontPanel());
+    
     return I2C_DevicePtr(new NamedPipeI2C_Device(
             FRONT_PANEL_I2C_READ_PIPE, FRONT_PANEL_I2C_WRITE_PIPE));
 }
@@ -49,12 +77,20 @@ I2C_DevicePtr HardwareFactory::CreateFrontPanelI2cDevice()
 
 ResourcePtr HardwareFactory::CreateMotorControllerInterruptResource()
 {
+    if (pVirtualClock)
+        return ResourcePtr(pMotorControllerInterrupt.release());
+    
     return ResourcePtr(new NamedPipeResource(
             MOTOR_CONTROLLER_INTERRUPT_READ_PIPE, 1));
 }
 
 ResourcePtr HardwareFactory::CreateFrontPanelInterruptResource() 
 {
+    // the simulated front panel's buttons are never pressed, so its 
+    // interrupt is a timer that's never started
+    if (pVirtualClock)
+        return ResourcePtr(new Timer(pVirtualClock));
+    
     return ResourcePtr(new NamedPipeResource(
             FRONT_PANEL_INTERRUPT_READ_PIPE, 1));
 }
@@ -56,6 +56,11 @@ void ImageWritingFrameBuffer::Fill(uint8_t value)
 
 // Write in image to the output path containing pixel values from the pixel
 // member vector.
+// Nothing to prepare, since the image is only written out when swapped.
+void ImageWritingFrameBuffer::Stage()
+{
+}
+
 void ImageWritingFrameBuffer::Swap()
 {
     Magick::Image image(_width, _height, "I", Magick::IntegerPixel, _pixels.data());
@@ -110,3 +110,34 @@ unsigned char NamedPipeI2C_Device::Read(unsigned char registerAddress) const
 
     return buffer;
 }
+
+bool NamedPipeI2C_Device::Read(unsigned char registerAddress, 
+                               unsigned char* data, int length) const
+{
+    if (write(_writeFd, &registerAddress, 1) != 1) 
+    {
+        return false;
+    }
+
+    if (read(_readFd, data, length) != length)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// The device at the other end of the pipe is always ready, so these just 
+// read the data
+unsigned char NamedPipeI2C_Device::ReadWhenReady(unsigned char registerAddress, 
+                                        unsigned char /*readyStatus*/) const
+{
+    return Read(registerAddress);
+}
+
+bool NamedPipeI2C_Device::ReadWhenReady(unsigned char registerAddress, 
+                                        unsigned char* data, int length,
+                                        unsigned char /*readyStatus*/) const
+{
+    return Read(registerAddress, data, length);
+}
@@ -23,6 +23,7 @@
 
 #include "mock_hardware/NamedPipeResource.h"
 
+#include <unistd.h>
 #include <sys/fcntl.h>
 #include <sys/epoll.h>
 #include <stdexcept>
@@ -59,15 +60,12 @@ bool NamedPipeResource::QualifyEvents(uint32_t events) const
     return EPOLLIN & events;
 }
 
-EventDataVec NamedPipeResource::Read()
+void NamedPipeResource::Read(EventDataVec& eventData)
 {
     unsigned char buffer;
-    EventDataVec eventData;
 
     if (read(_fd, &buffer, _dataSize) == _dataSize)
     {
         eventData.push_back(EventData(buffer));
     }
-
-    return eventData;
 }
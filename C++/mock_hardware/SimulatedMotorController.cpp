@@ -0,0 +1,303 @@
+//  File:   SimulatedMotorController.cpp
+//  Motor controller that completes motions after their predicted times, in
+//  simulated time (for dry runs of prints)
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include "mock_hardware/SimulatedMotorController.h"
+
+#include <algorithm>
+
+#include "MotorController.h"
+#include "Motor.h"
+#include "Timer.h"
+#include "VirtualClock.h"
+
+// number of commands the motor controller firmware's command buffer holds
+// (256 bytes of 6-byte commands)
+constexpr int COMMAND_CAPACITY = 42;
+
+// time taken to respond to an interrupt request, beyond that of any actions
+constexpr double RESPONSE_SEC = 0.001;
+
+SimulatedMotorController::SimulatedMotorController(const VirtualClock& clock,
+                                                   const Timer& interrupt) :
+_clock(clock),
+_interrupt(interrupt),
+_busyUntilSec(0.0),
+_pausedSec(0.0),
+_zPosition(0),
+_rotPosition(0),
+_linkedZ(0),
+_linkedRot(0),
+_status(MC_STATUS_SUCCESS)
+{
+}
+
+SimulatedMotorController::~SimulatedMotorController()
+{
+}
+
+// Handles a general command, sent as a single byte.
+bool SimulatedMotorController::Write(unsigned char data) const
+{
+    Handle(MotorCommand(MC_GENERAL_REG, data));
+    return true;
+}
+
+bool SimulatedMotorController::Write(unsigned char /*registerAddress*/,
+                                     unsigned char /*data*/) const
+{
+    return true;
+}
+
+// Handles a single command (its action and value following its register), or
+// a batch of them, which is discarded unless its count and checksum are valid.
+bool SimulatedMotorController::Write(unsigned char registerAddress,
+                                     const unsigned char* data,
+                                     int length) const
+{
+    const unsigned char* pCommand = data;
+    int count = 1;
+
+    if (registerAddress == MC_BATCH_REG)
+    {
+        count = length > 0 ? data[0] : 0;
+        unsigned char checksum = 0;
+        for (int i = 0; i < length - 1; i++)
+            checksum = MC_UpdateBatchChecksum(checksum, data[i]);
+
+        if (count < 1 || count > MC_MAX_BATCH_COMMANDS ||
+            length != count * MOTOR_COMMAND_SIZE + 2 ||
+            checksum != data[length - 1])
+        {
+            _status = MC_STATUS_BATCH_INVALID;
+            return true;
+        }
+        pCommand = &data[1];
+    }
+    else if (length != MOTOR_COMMAND_SIZE - 1)
+        return true;
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char cmdRegister = registerAddress;
+        if (registerAddress == MC_BATCH_REG)
+            cmdRegister = *pCommand++;
+
+        int32_t value = pCommand[1] | (pCommand[2] << 8) |
+                        (pCommand[3] << 16) | (pCommand[4] << 24);
+        Handle(MotorCommand(cmdRegister, pCommand[0], value));
+        pCommand += MOTOR_COMMAND_SIZE - 1;
+    }
+
+    _status = MC_STATUS_SUCCESS;
+    return true;
+}
+
+// Returns the status, or the number of commands that can currently be
+// accepted.
+unsigned char SimulatedMotorController::Read(unsigned char registerAddress) const
+{
+    if (registerAddress == MC_QUEUE_REG)
+        return std::max(COMMAND_CAPACITY - static_cast<int>(_pending.size()),
+                        0);
+
+    return _status;
+}
+
+bool SimulatedMotorController::Read(unsigned char registerAddress,
+                                    unsigned char* data, int length) const
+{
+    for (int i = 0; i < length; i++)
+        data[i] = Read(registerAddress);
+    return true;
+}
+
+unsigned char SimulatedMotorController::ReadWhenReady(
+                                        unsigned char registerAddress,
+                                        unsigned char /*readyStatus*/) const
+{
+    return Read(registerAddress);
+}
+
+bool SimulatedMotorController::ReadWhenReady(unsigned char registerAddress,
+                                             unsigned char* data, int length,
+                                             unsigned char /*readyStatus*/) const
+{
+    return Read(registerAddress, data, length);
+}
+
+// Follows a single command as the motor controller firmware would.
+void SimulatedMotorController::Handle(const MotorCommand& command) const
+{
+    double now = _clock.GetSeconds();
+
+    if (command.GetRegister() != MC_GENERAL_REG)
+    {
+        // settings take effect right away, unless they follow actions that
+        // are waiting for an interrupt request
+        bool isAction = command.GetRegister() == MC_ROT_ACTION_REG ||
+                        command.GetRegister() == MC_Z_ACTION_REG;
+        if (isAction || !_pending.empty())
+            _pending.push_back(command);
+        else
+            Perform(command);
+        return;
+    }
+
+    switch (command.GetCommand())
+    {
+        case MC_INTERRUPT:
+            Release();
+            break;
+
+        case MC_PAUSE:
+            // stop the actions in progress, keeping the time they have left
+            if (_busyUntilSec > now)
+            {
+                _pausedSec = _busyUntilSec - now;
+                _busyUntilSec = now;
+                _interrupt.Clear();
+            }
+            break;
+
+        case MC_RESUME:
+            if (_pausedSec > 0.0)
+            {
+                _busyUntilSec = now + _pausedSec;
+                _pausedSec = 0.0;
+                _interrupt.Start(_busyUntilSec - now);
+            }
+            break;
+
+        case MC_CLEAR:
+            // discard held and paused actions (though any settings already
+            // in effect remain so)
+            _pending.clear();
+            _pausedSec = 0.0;
+            Perform(command);
+            break;
+
+        case MC_RESET:
+            _pending.clear();
+            _pausedSec = 0.0;
+            _busyUntilSec = now;
+            _predictor = MotionTimePredictor();
+            _linkedZ = 0;
+            _linkedRot = 0;
+            _interrupt.Clear();
+            _status = MC_STATUS_SUCCESS;
+            break;
+
+        default:
+            // enabling and disabling the motors take no time
+            break;
+    }
+}
+
+// Performs the held actions, after any already in progress, and arranges for
+// the interrupt to be generated once they're all completed.  If an interrupt
+// is already due, it's generated only once, when these actions are completed.
+void SimulatedMotorController::Release() const
+{
+    double now = _clock.GetSeconds();
+
+    double before = _predictor.GetSeconds();
+    for (size_t i = 0; i < _pending.size(); i++)
+        Perform(_pending[i]);
+    _pending.clear();
+
+    _busyUntilSec = std::max(_busyUntilSec, now) + RESPONSE_SEC +
+                    (_predictor.GetSeconds() - before);
+    _interrupt.Start(_busyUntilSec - now);
+}
+
+// Adds the time taken by the given action (or setting) to that predicted, 
+// keeping track of where each axis is.  A homing move stops at the home 
+// position (where the real one is stopped by the limit switch or rotation 
+// sensor), so only the distance to there is predicted for it.
+void SimulatedMotorController::Perform(const MotorCommand& command) const
+{
+    int value = command.GetValue();
+    
+    switch (command.GetRegister())
+    {
+        case MC_Z_SETTINGS_REG:
+            if (command.GetCommand() == MC_LINKED_MOVE)
+                _linkedZ = value;
+            break;
+            
+        case MC_ROT_SETTINGS_REG:
+            if (command.GetCommand() == MC_LINKED_MOVE)
+                _linkedRot = value;
+            break;
+            
+        case MC_Z_ACTION_REG:
+            if (command.GetCommand() == MC_MOVE)
+            {
+                _zPosition += value;
+                _rotPosition = (_rotPosition + _linkedRot) % 
+                                                        UNITS_PER_REVOLUTION;
+                _linkedRot = 0;
+            }
+            else if (command.GetCommand() == MC_HOME)
+            {
+                int distance = std::min(std::abs(_zPosition), 
+                                        std::abs(value));
+                _zPosition = 0;
+                _predictor.Add(MotorCommand(MC_Z_ACTION_REG, MC_HOME, 
+                                            distance));
+                return;
+            }
+            break;
+            
+        case MC_ROT_ACTION_REG:
+            if (command.GetCommand() == MC_MOVE)
+            {
+                _rotPosition = (_rotPosition + value) % UNITS_PER_REVOLUTION;
+                _zPosition += _linkedZ;
+                _linkedZ = 0;
+            }
+            else if (command.GetCommand() == MC_HOME)
+            {
+                // the tray turns forward until it gets home
+                int distance = (UNITS_PER_REVOLUTION - _rotPosition) % 
+                                                        UNITS_PER_REVOLUTION;
+                distance = std::min(distance, std::abs(value));
+                _rotPosition = 0;
+                _predictor.Add(MotorCommand(MC_ROT_ACTION_REG, MC_HOME, 
+                                            distance));
+                return;
+            }
+            break;
+            
+        case MC_GENERAL_REG:
+            if (command.GetCommand() == MC_CLEAR)
+            {
+                _linkedZ = 0;
+                _linkedRot = 0;
+            }
+            break;
+    }
+    
+    _predictor.Add(command);
+}
@@ -0,0 +1,268 @@
+//  File:   CrossSectionUT.cpp
+//  Tests the measurement of the cured cross-section of a layer
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <CrossSection.h>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+constexpr int WIDTH = 40;
+constexpr int HEIGHT = 20;
+
+// Sets the pixels in the given rectangle to the given value.
+void Fill(std::vector<unsigned char>& image, int x, int y, int width, 
+          int height, unsigned char value)
+{
+    for (int row = y; row < y + height; row++)
+        for (int column = x; column < x + width; column++)
+            image[row * WIDTH + column] = value;
+}
+
+void MeasureTest()
+{
+    std::vector<unsigned char> image(WIDTH * HEIGHT, 0);
+    CrossSection crossSection;
+    
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetCuredPixels() != 0 || crossSection.GetIslands() != 0 ||
+        crossSection.GetTotalPixels() != WIDTH * HEIGHT)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MeasureTest (CrossSectionUT) " <<
+                "message=Expected nothing cured in black image" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // two separate squares, and one touching the second only diagonally, 
+    // plus pixels too dark to cure
+    Fill(image, 2, 2, 5, 5, 255);
+    Fill(image, 20, 2, 4, 4, 200);
+    Fill(image, 24, 6, 3, 3, 128);
+    Fill(image, 30, 10, 5, 5, 127);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetCuredPixels() != 25 + 16 + 9 || 
+        crossSection.GetIslands() != 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MeasureTest (CrossSectionUT) " <<
+                "message=Expected 50 cured pixels in 2 islands, got " <<
+                crossSection.GetCuredPixels() << " in " << 
+                crossSection.GetIslands() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // a U shape is one island, even though its arms only join lower down
+    image.assign(WIDTH * HEIGHT, 0);
+    Fill(image, 5, 5, 2, 10, 255);
+    Fill(image, 15, 5, 2, 10, 255);
+    Fill(image, 5, 14, 12, 1, 255);
+    // and a comb whose teeth join at the bottom
+    for (int x = 20; x < 40; x += 2)
+        Fill(image, x, 0, 1, 19, 255);
+    Fill(image, 20, 19, 20, 1, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetIslands() != 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MeasureTest (CrossSectionUT) " <<
+                "message=Expected 2 islands for U and comb, got " <<
+                crossSection.GetIslands() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void SpeedFactorTest()
+{
+    std::vector<unsigned char> image(WIDTH * HEIGHT, 0);
+    CrossSection crossSection;
+    
+    // 2% of the image is cured
+    Fill(image, 0, 0, 4, 4, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetSpeedFactor(5.0, 25.0, 2.0, 50) != 2.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=SpeedFactorTest (CrossSectionUT) " <<
+                "message=Expected maximum speed factor for small area" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // too many islands to speed up
+    if (crossSection.GetSpeedFactor(5.0, 25.0, 2.0, 0) != 1.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=SpeedFactorTest (CrossSectionUT) " <<
+                "message=Expected normal speed with too many islands" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // 15% of the image is cured, half way between the small and large areas
+    Fill(image, 0, 0, 20, 6, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    double factor = crossSection.GetSpeedFactor(5.0, 25.0, 2.0, 50);
+    if (std::abs(factor - 1.5) > 0.0001)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=SpeedFactorTest (CrossSectionUT) " <<
+                "message=Expected speed factor of 1.5, got " << factor << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // 30% of the image is cured
+    Fill(image, 0, 0, 40, 6, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetSpeedFactor(5.0, 25.0, 2.0, 50) != 1.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=SpeedFactorTest (CrossSectionUT) " <<
+                "message=Expected normal speed for large area" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void EdgeTest()
+{
+    std::vector<unsigned char> image(WIDTH * HEIGHT, 0);
+    CrossSection crossSection;
+    
+    // all of a solid square's cured pixels but its inner 8 x 8 are on an edge
+    Fill(image, 5, 5, 10, 10, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetEdgePixels() != 36)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=EdgeTest (CrossSectionUT) " <<
+                "message=Expected 36 edge pixels for square, got " << 
+                crossSection.GetEdgePixels() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // all of a thin line's pixels are on an edge
+    image.assign(WIDTH * HEIGHT, 0);
+    Fill(image, 10, 3, 20, 1, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetEdgePixels() != 20 || 
+        crossSection.GetEdgePercent() != 100.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=EdgeTest (CrossSectionUT) " <<
+                "message=Expected all 20 pixels of line on an edge, got " << 
+                crossSection.GetEdgePixels() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // pixels on the border of the image are on an edge
+    image.assign(WIDTH * HEIGHT, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetEdgePixels() != 2 * WIDTH + 2 * HEIGHT - 4)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=EdgeTest (CrossSectionUT) " <<
+                "message=Expected only border pixels on an edge, got " << 
+                crossSection.GetEdgePixels() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void ExposureFactorTest()
+{
+    std::vector<unsigned char> image(WIDTH * HEIGHT, 0);
+    CrossSection crossSection;
+    
+    // nothing cured
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetExposureFactor(15.0, 50.0, 0.8, 1.2) != 1.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=ExposureFactorTest (CrossSectionUT) " <<
+                "message=Expected normal exposure with nothing cured" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // a thin line gets the minimum exposure
+    Fill(image, 10, 3, 20, 1, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetExposureFactor(15.0, 50.0, 0.8, 1.2) != 0.8)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=ExposureFactorTest (CrossSectionUT) " <<
+                "message=Expected minimum exposure for thin line" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // a square with 36% of its pixels on an edge, 60% of the way from solid 
+    // to thin
+    image.assign(WIDTH * HEIGHT, 0);
+    Fill(image, 5, 5, 10, 10, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    double factor = crossSection.GetExposureFactor(15.0, 50.0, 0.8, 1.2);
+    if (std::abs(factor - 0.96) > 0.0001)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=ExposureFactorTest (CrossSectionUT) " <<
+                "message=Expected exposure factor of 0.96, got " << factor << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // a large solid area gets the maximum exposure
+    image.assign(WIDTH * HEIGHT, 255);
+    crossSection.Measure(image.data(), WIDTH, HEIGHT);
+    if (crossSection.GetExposureFactor(15.0, 50.0, 0.8, 1.2) != 1.2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=ExposureFactorTest (CrossSectionUT) " <<
+                "message=Expected maximum exposure for solid area" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% CrossSectionUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% MeasureTest (CrossSectionUT)" << std::endl;
+    MeasureTest();
+    std::cout << "%TEST_FINISHED% time=0 MeasureTest (CrossSectionUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% SpeedFactorTest (CrossSectionUT)" << std::endl;
+    SpeedFactorTest();
+    std::cout << "%TEST_FINISHED% time=0 SpeedFactorTest (CrossSectionUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% EdgeTest (CrossSectionUT)" << std::endl;
+    EdgeTest();
+    std::cout << "%TEST_FINISHED% time=0 EdgeTest (CrossSectionUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% ExposureFactorTest (CrossSectionUT)" << std::endl;
+    ExposureFactorTest();
+    std::cout << "%TEST_FINISHED% time=0 ExposureFactorTest (CrossSectionUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
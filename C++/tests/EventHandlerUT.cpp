@@ -22,12 +22,14 @@
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <unistd.h>
 
 #include "ICallback.h"
 #include "EventType.h"
 #include "PrinterStatusQueue.h"
 #include "PrinterStatus.h"
 #include "EventHandler.h"
+#include "Settings.h"
 
 // Simple C++ Test Suite
 int mainReturnValue = EXIT_SUCCESS;
@@ -102,6 +104,86 @@ void test1() {
     }
 }
 
+// Subscriber whose callback takes longer than the event handler's budget
+class SlowProxy : public ICallback
+{
+public:    
+    int _numCallbacks;
+    
+    SlowProxy() : _numCallbacks(0) {}
+    
+private:    
+    void Callback(EventType eventType, const EventData& data)
+    {
+        _numCallbacks++;
+        usleep(30000);
+    }   
+};
+
+void test2() {
+    std::cout << "EventHandlerUT test 2" << std::endl;
+    
+    PrinterSettings::Instance().Set(EVENT_CALLBACK_BUDGET, 10);
+    
+    EventHandler eh;
+    PrinterStatusQueue statusQueue;
+    UIProxy fast;
+    SlowProxy slow;
+    
+    eh.AddEvent(PrinterStatusUpdate, &statusQueue);
+    eh.Subscribe(PrinterStatusUpdate, &fast);
+    eh.Subscribe(PrinterStatusUpdate, &slow);
+
+    statusQueue.Push(PrinterStatus());
+    statusQueue.Push(PrinterStatus());
+    eh.Begin(100);
+    
+    PrinterSettings::Instance().Restore(EVENT_CALLBACK_BUDGET);
+    
+    const LatencyHistogram& dispatch = eh.GetDispatchStats(PrinterStatusUpdate);
+    const LatencyHistogram& fastStats = 
+                                eh.GetSubscriberStats(PrinterStatusUpdate, 0);
+    const LatencyHistogram& slowStats = 
+                                eh.GetSubscriberStats(PrinterStatusUpdate, 1);
+    
+    // both statuses are read in one dispatch, with each subscriber called for
+    // each of them
+    if (dispatch.GetCount() != 1 || 
+        eh.GetQueueingStats(PrinterStatusUpdate).GetCount() != 1)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (EventHandlerUT) message=expected one dispatch, got " << dispatch.GetCount() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    if (fastStats.GetCount() != 2 || slowStats.GetCount() != 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (EventHandlerUT) message=expected two callbacks per subscriber, got " << fastStats.GetCount() << " and " << slowStats.GetCount() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    if (slowStats.GetMax() < 30000 || dispatch.GetMax() < 60000 ||
+        fastStats.GetMax() >= slowStats.GetMax())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (EventHandlerUT) message=unexpected callback times, slow max: " << slowStats.GetMax() << " us, dispatch max: " << dispatch.GetMax() << " us" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // percentiles report the upper limit of their bucket, but never more than
+    // the maximum
+    if (slowStats.GetPercentile(50.0) > slowStats.GetMax() || 
+        slowStats.GetPercentile(50.0) < 16384)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (EventHandlerUT) message=unexpected median: " << slowStats.GetPercentile(50.0) << " us" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    std::cout << "%TEST_PASSED% time=0 testname=test2 (EventHandlerUT) message=got expected latency statistics" << std::endl;
+}
+
 int main(int argc, char** argv) {
     std::cout << "%SUITE_STARTING% EventHandlerUT" << std::endl;
     std::cout << "%SUITE_STARTED%" << std::endl;
@@ -110,6 +192,10 @@ int main(int argc, char** argv) {
     test1();
     std::cout << "%TEST_FINISHED% time=0 test1 (EventHandlerUT)" << std::endl;
 
+    std::cout << "%TEST_STARTED% test2 (EventHandlerUT)" << std::endl;
+    test2();
+    std::cout << "%TEST_FINISHED% time=0 test2 (EventHandlerUT)" << std::endl;
+
     std::cout << "%SUITE_FINISHED% time=0" << std::endl;
 
     return (mainReturnValue);
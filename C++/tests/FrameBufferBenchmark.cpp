@@ -0,0 +1,116 @@
+//  File:   FrameBufferBenchmark.cpp
+//  Measures how quickly layer images can be written to the frame buffer in
+//  each scan-out format and resolution
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <time.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <vector>
+#include <Magick++.h>
+
+#include <FrameBuffer.h>
+#include <support/MemoryFrameBuffer.hpp>
+
+// the number of layers shown for each measurement
+constexpr int NUM_LAYERS = 100;
+
+// resolutions to measure: the projector's, and larger ones
+constexpr int NUM_RESOLUTIONS = 3;
+constexpr int RESOLUTIONS[NUM_RESOLUTIONS][2] =
+{
+    {1280, 800},
+    {1920, 1080},
+    {2560, 1600}
+};
+
+// Returns the time from the monotonic clock, in seconds.
+double Now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Shows the given number of layers as a print does (blitting, staging and 
+// swapping in the image, then filling with black) and prints the time taken.
+// FrameBuffer waits for each swap and fill to be scanned out, as in a print, 
+// so its times include waiting for two vertical blanks per layer.
+void Measure(IFrameBuffer& frameBuffer, const char* target,
+             const ScanoutFormat& format, int width, int height)
+{
+    std::vector<uint8_t> pixels(width * height);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = i % 251;
+    Magick::Image image(width, height, "I", Magick::CharPixel, pixels.data());
+    
+    double start = Now();
+    for (int i = 0; i < NUM_LAYERS; i++)
+    {
+        frameBuffer.Blit(image);
+        frameBuffer.Stage();
+        frameBuffer.Swap();
+        frameBuffer.Fill(0x00);
+    }
+    double perLayerSec = (Now() - start) / NUM_LAYERS;
+    
+    printf("%-8s %-20s %4d x %-4d %8.3f ms/layer %8.1f Mpixel/s\n", target,
+           format.name, width, height, perLayerSec * 1000.0,
+           width * height / perLayerSec / 1e6);
+}
+
+// Measures the in-memory frame buffer in each format and resolution, and if a 
+// DRM device node is given (such as that of vkms, in a virtual machine without
+// projector hardware), also the frame buffer scanning out through it, in each 
+// format and resolution it supports.
+int main(int argc, char** argv)
+{
+    Magick::InitializeMagick("");
+    
+    for (int r = 0; r < NUM_RESOLUTIONS; r++)
+    {
+        for (int f = 0; f < NUM_SCANOUT_FORMATS; f++)
+        {
+            int width = RESOLUTIONS[r][0];
+            int height = RESOLUTIONS[r][1];
+            
+            MemoryFrameBuffer memory(width, height, SCANOUT_FORMATS[f]);
+            Measure(memory, "memory", SCANOUT_FORMATS[f], width, height);
+            
+            if (argc < 2)
+                continue;
+
+            try
+            {
+                FrameBuffer drm(width, height, argv[1], &SCANOUT_FORMATS[f]);
+                Measure(drm, "drm", SCANOUT_FORMATS[f], width, height);
+            }
+            catch (const std::exception& e)
+            {
+                printf("%-8s %-20s %4d x %-4d not supported: %s\n", "drm",
+                       SCANOUT_FORMATS[f].name, width, height, e.what());
+            }
+        }
+    }
+    
+    return 0;
+}
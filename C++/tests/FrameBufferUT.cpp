@@ -0,0 +1,190 @@
+//  File:   FrameBufferUT.cpp
+//  Tests the writing of layer images in each scan-out format
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <Magick++.h>
+
+#include <ScanoutFormat.h>
+#include <support/MemoryFrameBuffer.hpp>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+constexpr int WIDTH = 256;
+constexpr int HEIGHT = 4;
+
+// Returns the pixel expected in the given format for the given gray.
+uint32_t ExpectedPixel(const ScanoutFormat& format, uint8_t value)
+{
+    switch (format.bitsPerPixel)
+    {
+        case 8:
+            return value;
+            
+        case 16:
+            return ((value >> 3) << 11) | ((value >> 2) << 5) | (value >> 3);
+            
+        default:
+            return (value << 16) | (value << 8) | value;
+    }
+}
+
+// Returns the pixel at the given position in the displayed buffer.
+uint32_t DisplayedPixel(const MemoryFrameBuffer& frameBuffer,
+                        const ScanoutFormat& format, int x, int y)
+{
+    const uint8_t* pLine = frameBuffer.GetDisplayed() + 
+                           frameBuffer.GetPitch() * y;
+    
+    switch (format.bitsPerPixel)
+    {
+        case 8:
+            return pLine[x];
+            
+        case 16:
+            return ((const uint16_t*)pLine)[x];
+            
+        default:
+            // ignore the unused byte
+            return ((const uint32_t*)pLine)[x] & 0xFFFFFF;
+    }
+}
+
+// Returns true if every displayed pixel has the gray given by the function of
+// its position.
+template <typename Gray>
+bool Displays(const MemoryFrameBuffer& frameBuffer, 
+              const ScanoutFormat& format, Gray gray)
+{
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            if (DisplayedPixel(frameBuffer, format, x, y) != 
+                ExpectedPixel(format, gray(x, y)))
+                return false;
+    return true;
+}
+
+// Returns the gray of the test image at the given position.
+uint8_t Gradient(int x, int y)
+{
+    return (x + y * 37) % 256;
+}
+
+void SwapTest()
+{
+    std::vector<uint8_t> pixels(WIDTH * HEIGHT);
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            pixels[WIDTH * y + x] = Gradient(x, y);
+    Magick::Image image(WIDTH, HEIGHT, "I", Magick::CharPixel, pixels.data());
+    
+    for (int i = 0; i < NUM_SCANOUT_FORMATS; i++)
+    {
+        const ScanoutFormat& format = SCANOUT_FORMATS[i];
+        MemoryFrameBuffer frameBuffer(WIDTH, HEIGHT, format);
+        
+        frameBuffer.Blit(image);
+        frameBuffer.Stage();
+        if (!Displays(frameBuffer, format, [](int, int) { return 0; }))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=SwapTest (FrameBufferUT) " <<
+                    "message=Expected black until swapped, in " << 
+                    format.name << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+        
+        frameBuffer.Swap();
+        if (!Displays(frameBuffer, format, Gradient))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=SwapTest (FrameBufferUT) " <<
+                    "message=Expected image once swapped, in " << 
+                    format.name << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+    }
+}
+
+void FillTest()
+{
+    std::vector<uint8_t> pixels(WIDTH * HEIGHT, 0x80);
+    Magick::Image image(WIDTH, HEIGHT, "I", Magick::CharPixel, pixels.data());
+    
+    for (int i = 0; i < NUM_SCANOUT_FORMATS; i++)
+    {
+        const ScanoutFormat& format = SCANOUT_FORMATS[i];
+        MemoryFrameBuffer frameBuffer(WIDTH, HEIGHT, format);
+        
+        frameBuffer.Fill(0xFF);
+        if (!Displays(frameBuffer, format, [](int, int) { return 0xFF; }))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=FillTest (FrameBufferUT) " <<
+                    "message=Expected white after fill, in " << 
+                    format.name << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+        
+        // filling with black shows the black buffer, leaving the staged image
+        frameBuffer.Blit(image);
+        frameBuffer.Stage();
+        frameBuffer.Fill(0x00);
+        if (!Displays(frameBuffer, format, [](int, int) { return 0; }))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=FillTest (FrameBufferUT) " <<
+                    "message=Expected black after fill, in " << 
+                    format.name << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+        
+        frameBuffer.Swap();
+        if (!Displays(frameBuffer, format, [](int, int) { return 0x80; }))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=FillTest (FrameBufferUT) " <<
+                    "message=Expected staged image after black, in " << 
+                    format.name << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% FrameBufferUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% SwapTest (FrameBufferUT)" << std::endl;
+    SwapTest();
+    std::cout << "%TEST_FINISHED% time=0 SwapTest (FrameBufferUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% FillTest (FrameBufferUT)" << std::endl;
+    FillTest();
+    std::cout << "%TEST_FINISHED% time=0 FillTest (FrameBufferUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
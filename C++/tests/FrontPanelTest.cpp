@@ -22,6 +22,7 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <stdlib.h>
 #include <iostream>
 #include <stdlib.h>
@@ -0,0 +1,164 @@
+//  File:   I2C_BusUT.cpp
+//  Tests the ordering and statistics of transfers on an I2C bus
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <iostream>
+
+#include <I2C_Bus.h>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+// ports that aren't used by the printer
+constexpr int TEST_PORT = 100;
+constexpr int OTHER_TEST_PORT = 101;
+
+void PriorityTest()
+{
+    // a socket pair stands in for a device, with the bus writing to and 
+    // reading from one end, and the test the other
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) < 0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=PriorityTest (I2C_BusUT) " <<
+                "message=Unable to create socket pair" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    std::shared_ptr<I2C_Bus> pBus = I2C_Bus::Get(TEST_PORT);
+    I2C_Stats stats;
+
+    // keep the bus busy reading until the test writes, so that the other 
+    // transfers are all queued before any is performed
+    unsigned char readData = 0;
+    I2C_Transfer blockingRead(sockets[0], HighI2cPriority, &stats, NULL, 0, 
+                      &readData, 1);
+    pBus->Submit(&blockingRead);
+    
+    unsigned char low = 'L';
+    unsigned char normal = 'N';
+    unsigned char high = 'H';
+    unsigned char laterLow = 'l';
+    I2C_Transfer lowWrite(sockets[0], LowI2cPriority, &stats, &low, 1);
+    I2C_Transfer normalWrite(sockets[0], NormalI2cPriority, &stats, &normal, 1);
+    I2C_Transfer highWrite(sockets[0], HighI2cPriority, &stats, &high, 1);
+    I2C_Transfer laterLowWrite(sockets[0], LowI2cPriority, &stats, &laterLow, 
+                               1);
+    pBus->Submit(&lowWrite);
+    pBus->Submit(&normalWrite);
+    pBus->Submit(&highWrite);
+    pBus->Submit(&laterLowWrite);
+    
+    unsigned char unblock = 'U';
+    write(sockets[1], &unblock, 1);
+    
+    if (!blockingRead.Await() || readData != 'U' || !lowWrite.Await() || 
+        !normalWrite.Await() || !highWrite.Await() || !laterLowWrite.Await())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=PriorityTest (I2C_BusUT) " <<
+                "message=Expected all transfers to succeed" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    else
+    {
+        // higher priorities first, and in order of submission for the same
+        // priority
+        char written[5] = "";
+        read(sockets[1], written, 4);
+        if (std::string(written) != "HNLl")
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=PriorityTest (I2C_BusUT) " <<
+                    "message=Expected writes in order HNLl, got " << written << 
+                    std::endl;
+            mainReturnValue = EXIT_FAILURE;
+        }
+        else if (stats.transfer.GetCount() != 5 || 
+                 stats.queueing.GetCount() != 5 || stats.errors != 0)
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=PriorityTest (I2C_BusUT) " <<
+                    "message=Expected 5 transfers recorded without errors, got " <<
+                    stats.transfer.GetCount() << " with " << stats.errors << 
+                    " errors" << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+        }
+    }
+    
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+void ErrorTest()
+{
+    std::shared_ptr<I2C_Bus> pBus = I2C_Bus::Get(TEST_PORT);
+    I2C_Stats stats;
+    
+    unsigned char data = 0;
+    I2C_Transfer transfer(-1, NormalI2cPriority, &stats, &data, 1);
+    pBus->Submit(&transfer);
+    
+    if (transfer.Await() || !transfer.WriteFailed() || 
+        transfer.GetErrno() != EBADF || stats.errors != 1)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=ErrorTest (I2C_BusUT) " <<
+                "message=Expected a failed write to be reported and counted" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void SharedBusTest()
+{
+    std::shared_ptr<I2C_Bus> pBus = I2C_Bus::Get(TEST_PORT);
+    
+    if (I2C_Bus::Get(TEST_PORT) != pBus || 
+        I2C_Bus::Get(OTHER_TEST_PORT) == pBus)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=SharedBusTest (I2C_BusUT) " <<
+                "message=Expected one bus per port" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% I2C_BusUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% PriorityTest (I2C_BusUT)" << std::endl;
+    PriorityTest();
+    std::cout << "%TEST_FINISHED% time=0 PriorityTest (I2C_BusUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% ErrorTest (I2C_BusUT)" << std::endl;
+    ErrorTest();
+    std::cout << "%TEST_FINISHED% time=0 ErrorTest (I2C_BusUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% SharedBusTest (I2C_BusUT)" << std::endl;
+    SharedBusTest();
+    std::cout << "%TEST_FINISHED% time=0 SharedBusTest (I2C_BusUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
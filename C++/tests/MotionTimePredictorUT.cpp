@@ -0,0 +1,193 @@
+//  File:   MotionTimePredictorUT.cpp
+//  Tests the prediction of the time taken by motor controller moves
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <MotionTimePredictor.h>
+#include <MotorController.h>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+// typical Z settings, in motor controller units (microns/minute and
+// microns/minute^3/1E6)
+constexpr int Z_SPEED = 3000 * 60;
+constexpr int Z_JERK = 100000;
+
+bool IsNear(double actual, double expected, double tolerance = 0.001)
+{
+    return std::abs(actual - expected) <= tolerance;
+}
+
+void MoveTimeTest()
+{
+    // long enough to reach the speed: the head and tail each take
+    // 2 * sqrt(speed/jerk) minutes, and cover speed * sqrt(speed/jerk)
+    // microns, with the rest of the move at full speed, as measured on the
+    // motor controller firmware
+    double seconds = MotionTimePredictor::GetMoveSeconds(1000, Z_SPEED,
+                                                         Z_JERK * 1e6);
+    if (!IsNear(seconds, 0.4943))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MoveTimeTest (MotionTimePredictorUT) " <<
+                "message=Expected 1 mm move to take 0.4943 s, got " << seconds << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // acceleration makes it take longer than moving at full speed throughout
+    if (seconds <= 1000.0 / (Z_SPEED / 60.0))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MoveTimeTest (MotionTimePredictorUT) " <<
+                "message=Expected move to take longer than at constant speed" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // too short to reach the speed, so it accelerates for half the move and
+    // decelerates for the other half
+    seconds = MotionTimePredictor::GetMoveSeconds(100, Z_SPEED, Z_JERK * 1e6);
+    double peakSpeed = std::pow(50.0, 2.0 / 3.0) * std::cbrt(Z_JERK * 1e6);
+    if (!IsNear(seconds, 60.0 * 200.0 / peakSpeed))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MoveTimeTest (MotionTimePredictorUT) " <<
+                "message=Unexpected time for short move: " << seconds << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (MotionTimePredictor::GetMoveSeconds(0, Z_SPEED, Z_JERK * 1e6) != 0.0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=MoveTimeTest (MotionTimePredictorUT) " <<
+                "message=Expected no time for no move" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void CommandSequenceTest()
+{
+    MotionTimePredictor predictor;
+    std::vector<MotorCommand> commands;
+
+    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, Z_JERK));
+    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, Z_SPEED));
+    commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 1000));
+    commands.push_back(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, -1000));
+    commands.push_back(MotorCommand(MC_GENERAL_REG, MC_INTERRUPT));
+    predictor.Add(commands);
+
+    // moves in either direction take the same time
+    double expected = 2.0 * MotionTimePredictor::GetMoveSeconds(1000, Z_SPEED,
+                                                                Z_JERK * 1e6);
+    if (!IsNear(predictor.GetSeconds(), expected))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=CommandSequenceTest (MotionTimePredictorUT) " <<
+                "message=Expected " << expected << " s, got " <<
+                predictor.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // settings are kept for later commands, and homing is assumed to take
+    // the full distance allowed
+    predictor.Add(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, Z_SPEED / 2));
+    predictor.Add(MotorCommand(MC_Z_ACTION_REG, MC_HOME, 2000));
+    expected += MotionTimePredictor::GetMoveSeconds(2000, Z_SPEED / 2,
+                                                    Z_JERK * 1e6);
+    if (!IsNear(predictor.GetSeconds(), expected))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=CommandSequenceTest (MotionTimePredictorUT) " <<
+                "message=Expected " << expected << " s after homing, got " <<
+                predictor.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void LinkedMoveTest()
+{
+    std::vector<MotorCommand> commands;
+    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_JERK, Z_JERK));
+    commands.push_back(MotorCommand(MC_ROT_SETTINGS_REG, MC_SPEED, Z_SPEED));
+    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_JERK, Z_JERK));
+    commands.push_back(MotorCommand(MC_Z_SETTINGS_REG, MC_SPEED, Z_SPEED));
+
+    MotionTimePredictor separate;
+    separate.Add(commands);
+    separate.Add(MotorCommand(MC_ROT_ACTION_REG, MC_MOVE, -3000));
+    separate.Add(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 4000));
+
+    MotionTimePredictor linked;
+    linked.Add(commands);
+    linked.Add(MotorCommand(MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, -3000));
+    linked.Add(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, 4000));
+
+    // with equal settings, the linked move is planned along the diagonal,
+    // with speed and jerk scaled so that neither axis exceeds its own
+    // settings
+    double expected = MotionTimePredictor::GetMoveSeconds(5000,
+                                    Z_SPEED * 5.0 / 4.0, Z_JERK * 1e6 * 5.0 / 4.0);
+    if (!IsNear(linked.GetSeconds(), expected) ||
+        linked.GetSeconds() >= separate.GetSeconds())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=LinkedMoveTest (MotionTimePredictorUT) " <<
+                "message=Expected linked move to take " << expected <<
+                " s, less than separate moves' " << separate.GetSeconds() <<
+                " s, got " << linked.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // the linked distance only applies to one move
+    double before = linked.GetSeconds();
+    linked.Add(MotorCommand(MC_Z_ACTION_REG, MC_MOVE, -4000));
+    expected = MotionTimePredictor::GetMoveSeconds(4000, Z_SPEED, Z_JERK * 1e6);
+    if (!IsNear(linked.GetSeconds() - before, expected))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=LinkedMoveTest (MotionTimePredictorUT) " <<
+                "message=Expected linked distance to apply to one move only" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% MotionTimePredictorUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% MoveTimeTest (MotionTimePredictorUT)" << std::endl;
+    MoveTimeTest();
+    std::cout << "%TEST_FINISHED% time=0 MoveTimeTest (MotionTimePredictorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% CommandSequenceTest (MotionTimePredictorUT)" << std::endl;
+    CommandSequenceTest();
+    std::cout << "%TEST_FINISHED% time=0 CommandSequenceTest (MotionTimePredictorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% LinkedMoveTest (MotionTimePredictorUT)" << std::endl;
+    LinkedMoveTest();
+    std::cout << "%TEST_FINISHED% time=0 LinkedMoveTest (MotionTimePredictorUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
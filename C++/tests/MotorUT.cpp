@@ -0,0 +1,499 @@
+//  File:   MotorUT.cpp
+//  Tests the layer motions sent to the motor controller
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+#include <Motor.h>
+#include <Settings.h>
+#include <MotorController.h>
+#include "I_I2C_Device.h"
+
+#define SETTINGS (PrinterSettings::Instance())
+
+int mainReturnValue = EXIT_SUCCESS;
+
+typedef std::vector<std::vector<unsigned char> > WriteLog;
+
+// I2C device that records every write made to it
+class RecordingI2C_Device : public I_I2C_Device
+{
+public:
+    RecordingI2C_Device() : _commandSpace(0) {}
+    ~RecordingI2C_Device() {}
+
+    bool Write(unsigned char data) const
+    {
+        _writes.push_back(std::vector<unsigned char>(1, data));
+        return true;
+    }
+    bool Write(unsigned char registerAddress, unsigned char data) const
+    {
+        return Write(registerAddress, &data, 1);
+    }
+    bool Write(unsigned char registerAddress, const unsigned char* data,
+               int length) const
+    {
+        std::vector<unsigned char> write(1, registerAddress);
+        write.insert(write.end(), data, data + length);
+        _writes.push_back(write);
+        return true;
+    }
+    unsigned char Read(unsigned char registerAddress) const
+    {
+        return registerAddress == MC_QUEUE_REG ? _commandSpace : 0x00;
+    }
+    bool Read(unsigned char registerAddress, unsigned char* data,
+             int length) const { return true; };
+    unsigned char ReadWhenReady(unsigned char registerAddress,
+           unsigned char readyStatus) const { return 0x01; }
+    bool ReadWhenReady(unsigned char registerAddress,
+                       unsigned char* data, int length,
+                       unsigned char readyStatus) const { return true; }
+
+    mutable WriteLog _writes;
+    unsigned char _commandSpace;
+
+private:
+    RecordingI2C_Device(const RecordingI2C_Device&);
+    RecordingI2C_Device& operator=(const RecordingI2C_Device&);
+};
+
+// Get layer settings with typical values.
+CurrentLayerSettings GetTypicalSettings()
+{
+    CurrentLayerSettings cls = CurrentLayerSettings();
+
+    cls.PressMicrons = 500;
+    cls.PressMicronsPerSec = 1000;
+    cls.UnpressMicronsPerSec = 2000;
+    cls.SeparationRotJerk = 100000;
+    cls.SeparationRPM = 6;
+    cls.RotationMilliDegrees = 60000;
+    cls.SeparationZJerk = 100000;
+    cls.SeparationMicronsPerSec = 5000;
+    cls.ZLiftMicrons = 2000;
+    cls.ApproachRotJerk = 100000;
+    cls.ApproachRPM = 12;
+    cls.ApproachZJerk = 100000;
+    cls.ApproachMicronsPerSec = 5000;
+    cls.LayerThicknessMicrons = 25;
+
+    return cls;
+}
+
+// Send all of the per-layer motions for each of the given layers.
+void SendLayerMotions(Motor& motor,
+                      const std::vector<CurrentLayerSettings>& layers)
+{
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        motor.Separate(layers[i]);
+        motor.Approach(layers[i]);
+        motor.Approach(layers[i], true);
+        motor.Press(layers[i]);
+        motor.Unpress(layers[i]);
+    }
+}
+
+// Compare the writes made with pre-encoded motions to those made with motions
+// built for each layer.
+bool CompareWrites(const WriteLog& expected, const WriteLog& actual,
+                   const char* testName)
+{
+    if (expected.size() != actual.size())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=" << testName <<
+                " (MotorUT) message=Expected " << expected.size() <<
+                " writes, got " << actual.size() << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        if (expected[i] != actual[i])
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=" << testName <<
+                    " (MotorUT) message=Write " << i <<
+                    " differs from the expected bytes" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void PreparedMotionsMatchTest()
+{
+    std::vector<CurrentLayerSettings> layers;
+
+    CurrentLayerSettings cls = GetTypicalSettings();
+    layers.push_back(cls);
+
+    // a layer identical to the first should share its encoded motions
+    layers.push_back(cls);
+
+    // no rotation
+    cls.RotationMilliDegrees = 0;
+    layers.push_back(cls);
+
+    // no net Z motion on approach, and no press
+    cls = GetTypicalSettings();
+    cls.ZLiftMicrons = cls.LayerThicknessMicrons;
+    cls.PressMicrons = 0;
+    layers.push_back(cls);
+
+    // thicker layers
+    cls = GetTypicalSettings();
+    cls.LayerThicknessMicrons = 100;
+    layers.push_back(cls);
+
+    SETTINGS.Set(HOME_ON_APPROACH, 1);
+
+    RecordingI2C_Device builtI2C;
+    RecordingI2C_Device preparedI2C;
+    Motor builtMotor(builtI2C);
+    Motor preparedMotor(preparedI2C);
+
+    for (size_t i = 0; i < layers.size(); i++)
+        preparedMotor.PrepareLayer(layers[i]);
+
+    SendLayerMotions(builtMotor, layers);
+    SendLayerMotions(preparedMotor, layers);
+
+    if (!CompareWrites(builtI2C._writes, preparedI2C._writes,
+                       "PreparedMotionsMatchTest"))
+    {
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // the matching writes must have come from the pre-encoded motions (every
+    // one of those sent for these layers has more than one command)
+    unsigned long preparedSends = preparedMotor.GetPreparedSendCount();
+    if (builtMotor.GetPreparedSendCount() != 0 || 
+        preparedSends != layers.size() * 5)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=PreparedMotionsMatchTest (MotorUT) " <<
+                "message=Expected " << layers.size() * 5 << 
+                " motions sent pre-encoded, got " << preparedSends << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // after a settings change, motions should no longer come from the
+    // (now stale) pre-encoded ones
+    SETTINGS.Set(HOME_ON_APPROACH, 0);
+    builtI2C._writes.clear();
+    preparedI2C._writes.clear();
+
+    SendLayerMotions(builtMotor, layers);
+    SendLayerMotions(preparedMotor, layers);
+
+    if (!CompareWrites(builtI2C._writes, preparedI2C._writes,
+                       "PreparedMotionsMatchTest"))
+    {
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (preparedMotor.GetPreparedSendCount() != preparedSends)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=PreparedMotionsMatchTest (MotorUT) " <<
+                "message=Expected stale pre-encoded motions not to be sent" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // once prepared again, the motions should be sent pre-encoded with the 
+    // new setting
+    for (size_t i = 0; i < layers.size(); i++)
+        preparedMotor.PrepareLayer(layers[i]);
+    preparedI2C._writes.clear();
+
+    SendLayerMotions(preparedMotor, layers);
+
+    if (!CompareWrites(builtI2C._writes, preparedI2C._writes,
+                       "PreparedMotionsMatchTest"))
+    {
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (preparedMotor.GetPreparedSendCount() != preparedSends * 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=PreparedMotionsMatchTest (MotorUT) " <<
+                "message=Expected motions prepared again to be sent pre-encoded" << 
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    SETTINGS.Restore(HOME_ON_APPROACH);
+}
+
+void InvalidMotionsNotPreparedTest()
+{
+    // a zero speed can't be sent, so separation shouldn't be pre-encoded,
+    // but should still fail when it's sent
+    std::vector<CurrentLayerSettings> layers;
+    CurrentLayerSettings cls = GetTypicalSettings();
+    cls.SeparationRPM = 0;
+    layers.push_back(cls);
+
+    RecordingI2C_Device builtI2C;
+    RecordingI2C_Device preparedI2C;
+    Motor builtMotor(builtI2C);
+    Motor preparedMotor(preparedI2C);
+
+    preparedMotor.PrepareLayer(cls);
+
+    if (preparedMotor.Separate(cls))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=InvalidMotionsNotPreparedTest (MotorUT) " <<
+                "message=Expected Separate to fail with a zero speed" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    preparedI2C._writes.clear();
+
+    SendLayerMotions(builtMotor, layers);
+    SendLayerMotions(preparedMotor, layers);
+
+    if (!CompareWrites(builtI2C._writes, preparedI2C._writes,
+                       "InvalidMotionsNotPreparedTest"))
+        mainReturnValue = EXIT_FAILURE;
+}
+
+void HeldSeparationTest()
+{
+    CurrentLayerSettings cls = GetTypicalSettings();
+
+    RecordingI2C_Device builtI2C;
+    RecordingI2C_Device heldI2C;
+    Motor builtMotor(builtI2C);
+    Motor heldMotor(heldI2C);
+
+    // nothing should be sent if the motor controller doesn't have room
+    if (heldMotor.HoldSeparation(cls) || !heldI2C._writes.empty())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=HeldSeparationTest (MotorUT) " <<
+                "message=Expected HoldSeparation to fail without room for the commands" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    heldI2C._commandSpace = MC_MAX_BATCH_COMMANDS;
+    if (!heldMotor.HoldSeparation(cls) || !heldMotor.ReleaseHeldMotion())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=HeldSeparationTest (MotorUT) " <<
+                "message=Expected HoldSeparation and ReleaseHeldMotion to succeed" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // the held separation should be sent as a batch of the same commands as 
+    // a separation, without the interrupt request, which is sent on release
+    builtMotor.Separate(cls);
+    const std::vector<unsigned char>& built = builtI2C._writes[0];
+    int count = built[1];
+    std::vector<MotorCommand> commands;
+    for (int i = 0; i < count - 1; i++)
+    {
+        const unsigned char* cmd = &built[2 + i * MOTOR_COMMAND_SIZE];
+        int32_t value = cmd[2] | (cmd[3] << 8) | (cmd[4] << 16) | (cmd[5] << 24);
+        commands.push_back(MotorCommand(cmd[0], cmd[1], value));
+    }
+    unsigned char frame[MAX_BATCH_FRAME_SIZE];
+    int length = MotorCommand::EncodeBatch(&commands[0], commands.size(), 
+                                           frame);
+
+    WriteLog expected;
+    expected.push_back(std::vector<unsigned char>(1, MC_BATCH_REG));
+    expected[0].insert(expected[0].end(), frame, frame + length);
+    expected.push_back(std::vector<unsigned char>(1, MC_INTERRUPT));
+
+    if (!CompareWrites(expected, heldI2C._writes, "HeldSeparationTest"))
+        mainReturnValue = EXIT_FAILURE;
+}
+
+// Find the value of the given command in a batch written to the motor 
+// controller, returning false if it's not there.
+bool FindCommand(const std::vector<unsigned char>& write, unsigned char reg,
+                 unsigned char cmd, int32_t& value)
+{
+    int count = write[1];
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char* c = &write[2 + i * MOTOR_COMMAND_SIZE];
+        if (c[0] == reg && c[1] == cmd)
+        {
+            value = c[2] | (c[3] << 8) | (c[4] << 16) | (c[5] << 24);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CoordinatedMotionTest()
+{
+    CurrentLayerSettings cls = GetTypicalSettings();
+    int rotation = cls.RotationMilliDegrees / R_SCALE_FACTOR;
+    int32_t value;
+
+    SETTINGS.Set(COORDINATED_MOTION, 1);
+
+    RecordingI2C_Device i2c;
+    Motor motor(i2c);
+    
+    // separation and approach should link their rotations to their Z moves, 
+    // rather than moving the tray on its own (and the negative linked 
+    // distance for separation must be accepted as valid)
+    if (!motor.Separate(cls) || !motor.Approach(cls) || i2c._writes.size() != 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=CoordinatedMotionTest (MotorUT) " <<
+                "message=Expected coordinated separation and approach to be sent" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    if (!FindCommand(i2c._writes[0], MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, 
+                     value) || value != -rotation ||
+        FindCommand(i2c._writes[0], MC_ROT_ACTION_REG, MC_MOVE, value) ||
+        !FindCommand(i2c._writes[1], MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, 
+                     value) || value != rotation ||
+        FindCommand(i2c._writes[1], MC_ROT_ACTION_REG, MC_MOVE, value))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=CoordinatedMotionTest (MotorUT) " <<
+                "message=Expected rotations to be linked to the Z moves" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // without a Z move to link to, and when homing on approach, the tray 
+    // should still be rotated on its own
+    i2c._writes.clear();
+    cls.ZLiftMicrons = 0;
+    motor.Separate(cls);
+    cls.ZLiftMicrons = cls.LayerThicknessMicrons;
+    motor.Approach(cls);
+    cls = GetTypicalSettings();
+    SETTINGS.Set(HOME_ON_APPROACH, 1);
+    motor.Approach(cls);
+    SETTINGS.Restore(HOME_ON_APPROACH);
+    
+    if (i2c._writes.size() != 3 ||
+        !FindCommand(i2c._writes[0], MC_ROT_ACTION_REG, MC_MOVE, value) ||
+        !FindCommand(i2c._writes[1], MC_ROT_ACTION_REG, MC_MOVE, value) ||
+        !FindCommand(i2c._writes[2], MC_ROT_ACTION_REG, MC_HOME, value) ||
+        FindCommand(i2c._writes[0], MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, 
+                    value) ||
+        FindCommand(i2c._writes[1], MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, 
+                    value) ||
+        FindCommand(i2c._writes[2], MC_ROT_SETTINGS_REG, MC_LINKED_MOVE, 
+                    value))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=CoordinatedMotionTest (MotorUT) " <<
+                "message=Expected rotations without a linkable Z move to be sent on their own" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+
+    SETTINGS.Restore(COORDINATED_MOTION);
+}
+
+void LayerMotionTimeTest()
+{
+    RecordingI2C_Device i2c;
+    Motor motor(i2c);
+    CurrentLayerSettings cls = GetTypicalSettings();
+    
+    // each motion takes at least as long as at its full speed throughout
+    double separationSec = motor.GetLayerMotionSec(SeparateMotion, cls);
+    double pressSec = motor.GetLayerMotionSec(PressMotion, cls);
+    double fullSpeedSeparationSec = 
+                    cls.RotationMilliDegrees / 360000.0 / cls.SeparationRPM * 60.0 +
+                    cls.ZLiftMicrons / (double) cls.SeparationMicronsPerSec;
+    double fullSpeedPressSec = 
+                    cls.PressMicrons / (double) cls.PressMicronsPerSec;
+    if (separationSec < fullSpeedSeparationSec || pressSec < fullSpeedPressSec)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=LayerMotionTimeTest (MotorUT) " <<
+                "message=Expected motions to take longer than at full speed, got " <<
+                separationSec << " s and " << pressSec << " s" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // nothing is sent in making the predictions
+    if (!i2c._writes.empty())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=LayerMotionTimeTest (MotorUT) " <<
+                "message=Expected no writes to the motor controller" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    // rotating while lifting saves time
+    SETTINGS.Set(COORDINATED_MOTION, 1);
+    double coordinatedSec = motor.GetLayerMotionSec(SeparateMotion, cls);
+    SETTINGS.Restore(COORDINATED_MOTION);
+    
+    if (coordinatedSec >= separationSec)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=LayerMotionTimeTest (MotorUT) " <<
+                "message=Expected coordinated separation to take less than " <<
+                separationSec << " s, got " << coordinatedSec << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% MotorUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% PreparedMotionsMatchTest (MotorUT)" << std::endl;
+    PreparedMotionsMatchTest();
+    std::cout << "%TEST_FINISHED% time=0 PreparedMotionsMatchTest (MotorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% InvalidMotionsNotPreparedTest (MotorUT)" << std::endl;
+    InvalidMotionsNotPreparedTest();
+    std::cout << "%TEST_FINISHED% time=0 InvalidMotionsNotPreparedTest (MotorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% HeldSeparationTest (MotorUT)" << std::endl;
+    HeldSeparationTest();
+    std::cout << "%TEST_FINISHED% time=0 HeldSeparationTest (MotorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% CoordinatedMotionTest (MotorUT)" << std::endl;
+    CoordinatedMotionTest();
+    std::cout << "%TEST_FINISHED% time=0 CoordinatedMotionTest (MotorUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% LayerMotionTimeTest (MotorUT)" << std::endl;
+    LayerMotionTimeTest();
+    std::cout << "%TEST_FINISHED% time=0 LayerMotionTimeTest (MotorUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
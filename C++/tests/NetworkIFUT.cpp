@@ -21,7 +21,10 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <unistd.h>
 #include <stdlib.h>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <sys/stat.h>
 
@@ -29,13 +32,15 @@
 #include <Filenames.h>
 #include <Shared.h>
 #include <CommandInterpreter.h>
+#include <Settings.h>
+#include <Timer.h>
+#include <VirtualClock.h>
 
 int mainReturnValue = EXIT_SUCCESS;
 
 #define STATE_NAME  PrinterStatus::GetStateName
 
 FILE* _pPushedStatusPipe;
-FILE* _pPrinterStatusFile;
 
 bool ExpectedStatus(const char* state, const char* temp, FILE* file)
 {
@@ -58,6 +63,19 @@ bool ExpectedStatus(const char* state, const char* temp, FILE* file)
     return foundState  && foundTemp;
 }
 
+// The status file is replaced rather than rewritten, so it must be reopened
+// each time it's checked.
+bool ExpectedStatusInFile(const char* state, const char* temp)
+{
+    FILE* pPrinterStatusFile = fopen(PRINTER_STATUS_FILE, "r");
+    if (pPrinterStatusFile == NULL)
+        return false;
+    
+    bool retVal = ExpectedStatus(state, temp, pPrinterStatusFile);
+    fclose(pPrinterStatusFile);
+    return retVal;
+}
+
 
 void test1() {
     std::cout << "NetworkIFUT test 1" << std::endl;
@@ -74,8 +92,6 @@ void test1() {
     
     // open the named pipes used for pushed status 
     _pPushedStatusPipe = fopen(STATUS_TO_WEB_PIPE, "r+");
-    // open the file used to pull printer status
-    _pPrinterStatusFile = fopen(PRINTER_STATUS_FILE, "w+");
     
     // set some printer status
     PrinterStatus ps;
@@ -93,7 +109,7 @@ void test1() {
     }
        
     // and the pullable status
-    if (!ExpectedStatus(STATE_NAME(PrintingLayerState), "3.14159", _pPrinterStatusFile))
+    if (!ExpectedStatusInFile(STATE_NAME(PrintingLayerState), "3.14159"))
     {
         std::cout << "%TEST_FAILED% time=0 testname=test1 (NetworkIFUT) message=failed to find first expected printer state and temperature again" << std::endl;
         mainReturnValue = EXIT_FAILURE;
@@ -103,7 +119,7 @@ void test1() {
     ps._temperature = 42;
     
     // check status again (should not have changed)
-    if (!ExpectedStatus(STATE_NAME(PrintingLayerState), "3.14159", _pPrinterStatusFile))
+    if (!ExpectedStatusInFile(STATE_NAME(PrintingLayerState), "3.14159"))
     {
         std::cout << "%TEST_FAILED% time=0 testname=test1 (NetworkIFUT) message=failed to find unchanged printer state and temperature" << std::endl;
         mainReturnValue = EXIT_FAILURE;
@@ -120,13 +136,144 @@ void test1() {
     }
     
     // and the pullable status
-    if (!ExpectedStatus(STATE_NAME(HomingState), "42", _pPrinterStatusFile))
+    if (!ExpectedStatusInFile(STATE_NAME(HomingState), "42"))
     {
         std::cout << "%TEST_FAILED% time=0 testname=test1 (NetworkIFUT) message=failed to find new printer state and temperature again" << std::endl;
         mainReturnValue = EXIT_FAILURE;
     }
 }
 
+void test2() {
+    std::cout << "NetworkIFUT test 2" << std::endl;
+    
+    VirtualClock clock;
+    Timer publishTimer(&clock);
+    NetworkInterface net(&publishTimer);
+    PrinterSettings::Instance().Set(STATUS_COALESCE_MS, 200);
+    
+    _pPushedStatusPipe = fopen(STATUS_TO_WEB_PIPE, "r+");
+    
+    PrinterStatus ps;
+    ps._state  = HomingState;
+    ps._temperature = 1;
+
+    // the first update is published right away
+    ((ICallback*)&net)->Callback(PrinterStatusUpdate, EventData(ps));
+    if (!ExpectedStatusInFile(STATE_NAME(HomingState), "1"))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (NetworkIFUT) message=first status not published immediately" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    // a burst of updates within the window is coalesced
+    ps._state  = MovingToStartPositionState;
+    ps._temperature = 2;
+    ((ICallback*)&net)->Callback(PrinterStatusUpdate, EventData(ps));
+    ps._state  = InitializingLayerState;
+    ps._temperature = 3;
+    ((ICallback*)&net)->Callback(PrinterStatusUpdate, EventData(ps));
+    
+    if (!ExpectedStatusInFile(STATE_NAME(HomingState), "1"))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (NetworkIFUT) message=coalesced status published too soon" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    if (net.GetCoalescedCount() != 1)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (NetworkIFUT) message=expected 1 coalesced update, got " << net.GetCoalescedCount() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    // when the publish timer expires, only the latest status is published
+    clock.AdvanceToNextAlarm();
+    EventDataVec timerData;
+    publishTimer.Read(timerData);
+    ((ICallback*)&net)->Callback(StatusPublishTimer, timerData[0]);
+    
+    if (!ExpectedStatusInFile(STATE_NAME(InitializingLayerState), "3"))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (NetworkIFUT) message=latest coalesced status not published" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    // the pipe sees the first status followed by the latest one
+    if (!ExpectedStatus(STATE_NAME(HomingState), "1", _pPushedStatusPipe) ||
+        !ExpectedStatus(STATE_NAME(InitializingLayerState), "3", 
+                                                        _pPushedStatusPipe))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (NetworkIFUT) message=unexpected status pushed to pipe" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    PrinterSettings::Instance().Restore(STATUS_COALESCE_MS);
+}
+
+void test3() {
+    std::cout << "NetworkIFUT test 3" << std::endl;
+    
+    // only a pipe that's never read is open
+    if (access(STATUS_TO_WEB_PIPE, F_OK) != -1)
+        remove(STATUS_TO_WEB_PIPE);
+    const char* unreadPipe = "/tmp/NetworkIFUT_unread";
+    remove(unreadPipe);
+    mkfifo(unreadPipe, 0666);
+    
+    VirtualClock clock;
+    Timer publishTimer(&clock);
+    NetworkInterface net(&publishTimer);
+    net.AddStatusPipe(unreadPipe);
+    PrinterSettings::Instance().Set(STATUS_COALESCE_MS, 0);
+    
+    PrinterStatus ps;
+    ps._state  = PrintingLayerState;
+    
+    // publish until the pipe backs up and a retry is scheduled, then once 
+    // more so that a status is held for the pipe
+    for (int i = 0; i < 10000 && publishTimer.GetRemainingTimeSeconds() <= 0.0;
+         i++)
+    {
+        ps._temperature = i;
+        ((ICallback*)&net)->Callback(PrinterStatusUpdate, EventData(ps));
+    }
+    ((ICallback*)&net)->Callback(PrinterStatusUpdate, EventData(ps));
+    unsigned long droppedCount = net.GetDroppedCount();
+    
+    // each retry that fails waits twice as long as the last, up to a limit,
+    // until the pipe has been backed up for a minute
+    double expectedDelaySec = 0.25;
+    double backedUpSec = 0.0;
+    while (backedUpSec < 60.0)
+    {
+        double delaySec = publishTimer.GetRemainingTimeSeconds();
+        if (std::abs(delaySec - expectedDelaySec) > 1e-6)
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=test3 (NetworkIFUT) message=expected retry after " << expectedDelaySec << " s, got " << delaySec << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            break;
+        }
+        
+        clock.AdvanceToNextAlarm();
+        backedUpSec += delaySec;
+        expectedDelaySec = std::min(expectedDelaySec * 2, 8.0);
+        
+        EventDataVec timerData;
+        publishTimer.Read(timerData);
+        ((ICallback*)&net)->Callback(StatusPublishTimer, timerData[0]);
+    }
+    
+    // then the held status is dropped, and no more retries are scheduled
+    if (publishTimer.GetRemainingTimeSeconds() > 0.0 || 
+        net.GetDroppedCount() != droppedCount + 1)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test3 (NetworkIFUT) message=expected retries to stop with held update dropped, got " << net.GetDroppedCount() - droppedCount << " dropped" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    PrinterSettings::Instance().Restore(STATUS_COALESCE_MS);
+    remove(unreadPipe);
+}
+
 int main(int argc, char** argv) {
     std::cout << "%SUITE_STARTING% NetworkIFUT" << std::endl;
     std::cout << "%SUITE_STARTED%" << std::endl;
@@ -135,6 +282,14 @@ int main(int argc, char** argv) {
     test1();
     std::cout << "%TEST_FINISHED% time=0 test1 (NetworkIFUT)" << std::endl;
 
+    std::cout << "%TEST_STARTED% test2 (NetworkIFUT)" << std::endl;
+    test2();
+    std::cout << "%TEST_FINISHED% time=0 test2 (NetworkIFUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% test3 (NetworkIFUT)" << std::endl;
+    test3();
+    std::cout << "%TEST_FINISHED% time=0 test3 (NetworkIFUT)" << std::endl;
+
     std::cout << "%SUITE_FINISHED% time=0" << std::endl;
 
     if (access(STATUS_TO_WEB_PIPE, F_OK) != -1)
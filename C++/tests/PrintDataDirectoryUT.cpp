@@ -23,6 +23,7 @@
 
 #include <sys/stat.h>
 #include <sstream>
+#include <fstream>
 #include <iostream>
 #include <stdlib.h>
 
@@ -292,6 +293,67 @@ void TestRemoveWhenUnderlyingDataDoesNotExist()
     }
 }
 
+void TestLayerData()
+{
+    std::cout << "PrintDataDirectoryUT TestLayerData" << std::endl;
+
+    // the first two slices are identical, and the third differs from them
+    std::ofstream(testDataDir + "/slice_1.png") << "same layer";
+    std::ofstream(testDataDir + "/slice_2.png") << "same layer";
+    std::ofstream(testDataDir + "/slice_3.png") << "other layer";
+
+    PrintDataDirectory printData(testDataDir);
+    std::string data[4];
+    uint64_t fingerprints[4];
+    for (int layer = 1; layer <= 3; layer++)
+    {
+        if (!printData.GetLayerData(layer, data[layer], fingerprints[layer]))
+        {
+            std::cout << "%TEST_FAILED% time=0 testname=TestLayerData (PrintDataDirectoryUT) "
+                    << "message=Expected GetLayerData to return true for layer " 
+                    << layer << ", got false" << std::endl;
+            mainReturnValue = EXIT_FAILURE;
+            return;
+        }
+    }
+
+    if (data[3] != "other layer")
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=TestLayerData (PrintDataDirectoryUT) "
+                << "message=Expected GetLayerData to read \"other layer\", got \"" 
+                << data[3] << "\"" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (fingerprints[1] != fingerprints[2])
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=TestLayerData (PrintDataDirectoryUT) "
+                << "message=Expected identical slices to have the same fingerprint" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (fingerprints[1] == fingerprints[3])
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=TestLayerData (PrintDataDirectoryUT) "
+                << "message=Expected different slices to have different fingerprints" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    std::string missingData;
+    uint64_t fingerprint;
+    if (printData.GetLayerData(4, missingData, fingerprint))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=TestLayerData (PrintDataDirectoryUT) "
+                << "message=Expected GetLayerData to return false for a missing slice, got true" 
+                << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+}
+
 int main(int argc, char** argv) {
     std::cout << "%SUITE_STARTING% PrintDataDirectoryUT" << std::endl;
     std::cout << "%SUITE_STARTED%" << std::endl;
@@ -350,6 +412,12 @@ int main(int argc, char** argv) {
     TearDown();
     std::cout << "%TEST_FINISHED% time=0 TestRemoveWhenUnderlyingDataDoesNotExist (PrintDataDirectoryUT)" << std::endl;
 
+    std::cout << "%TEST_STARTED% TestLayerData (PrintDataDirectoryUT)" << std::endl;
+    Setup();
+    TestLayerData();
+    TearDown();
+    std::cout << "%TEST_FINISHED% time=0 TestLayerData (PrintDataDirectoryUT)" << std::endl;
+
     std::cout << "%SUITE_FINISHED% time=0" << std::endl;
 
     return (mainReturnValue);
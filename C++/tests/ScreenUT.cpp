@@ -68,6 +68,31 @@ public:
     { return TrimToFit(text, numLines); }
 };
 
+// records the text shown on it
+class TestDisplay : public IDisplay
+{
+public:
+    TestDisplay() : _lastLineID(NO_LINE_ID) {}
+    virtual void ShowText(Alignment align, unsigned char x, unsigned char y, 
+             unsigned char size, int color, std::string text)
+    {
+        _lastLineID = NO_LINE_ID;
+        _lastText = text;
+    }
+    virtual void UpdateText(int lineID, Alignment align, unsigned char x, 
+             unsigned char y, unsigned char size, int color, 
+             std::string text)
+    {
+        _lastLineID = lineID;
+        _lastText = text;
+    }
+    virtual void AnimateLEDs(int animationNum) {}
+    virtual void ShowLEDs(int numLEDs) {}
+    
+    int _lastLineID;
+    std::string _lastText;
+};
+
 void test1() {
     std::cout << "ScreenUT test 1" << std::endl;
     
@@ -235,6 +260,34 @@ void test1() {
     delete repLine1;   
 }
 
+void test2() {
+    std::cout << "ScreenUT test 2" << std::endl;
+    
+    TestDisplay display;
+    
+    // replaceable lines without a line ID are shown as ordinary text
+    ReplaceableLine line(REP_LINE5);
+    line.ReplaceWith("1:23");
+    line.Draw(&display);
+    if (display._lastLineID != NO_LINE_ID || display._lastText != "1:23 = value")
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (ScreenUT) message=expected text shown without line ID, got line ID " << 
+                display._lastLineID << " text: " << display._lastText << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    // those with one are updated in place
+    ReplaceableLine idLine(REP_LINE5, 2);
+    idLine.ReplaceWith("1:22");
+    idLine.Draw(&display);
+    if (display._lastLineID != 2 || display._lastText != "1:22 = value")
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test2 (ScreenUT) message=expected text updated as line 2, got line ID " << 
+                display._lastLineID << " text: " << display._lastText << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
 int main(int argc, char** argv) {
     std::cout << "%SUITE_STARTING% ScreenUT" << std::endl;
     std::cout << "%SUITE_STARTED%" << std::endl;
@@ -243,6 +296,10 @@ int main(int argc, char** argv) {
     test1();
     std::cout << "%TEST_FINISHED% time=0 test1 (ScreenUT)" << std::endl;
 
+    std::cout << "%TEST_STARTED% test2 (ScreenUT)" << std::endl;
+    test2();
+    std::cout << "%TEST_FINISHED% time=0 test2 (ScreenUT)" << std::endl;
+
     std::cout << "%SUITE_FINISHED% time=0" << std::endl;
 
     return (mainReturnValue);
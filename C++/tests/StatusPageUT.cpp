@@ -0,0 +1,109 @@
+//  File:   StatusPageUT.cpp
+//  Tests StatusPage
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//    
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <iostream>
+#include <cstring>
+#include <sys/mman.h>
+
+#include <StatusPage.h>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+constexpr const char* TEST_STATUS_PAGE = "/StatusPageUT";
+
+void test1() {
+    std::cout << "StatusPageUT test 1" << std::endl;
+    
+    StatusPage page(TEST_STATUS_PAGE);
+    StatusPageReader reader(TEST_STATUS_PAGE);
+    
+    uint32_t initialSequence = reader.GetSequence();
+    
+    PrinterStatus ps;
+    ps._state = ExposingState;
+    ps._change = Entering;
+    ps._currentLayer = 42;
+    ps._numLayers = 100;
+    ps._temperature = 3.14159;
+    ps._jobID = "some job ID";
+    ps._canLoadPrintData = true;
+    
+    ((ICallback*)&page)->Callback(PrinterStatusUpdate, EventData(ps));
+    
+    if (reader.GetSequence() != initialSequence + 2)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test1 (StatusPageUT) message=sequence number not advanced by an update, was " << initialSequence << " now " << reader.GetSequence() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    StatusPageData snapshot;
+    if (!reader.Read(snapshot))
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test1 (StatusPageUT) message=couldn't read status page" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+    
+    if (snapshot.state != ExposingState || snapshot.change != Entering ||
+        snapshot.currentLayer != 42 || snapshot.numLayers != 100 ||
+        snapshot.temperature != 3.14159 || !snapshot.canLoadPrintData ||
+        strcmp(snapshot.jobID, "some job ID") != 0 ||
+        strcmp(snapshot.localJobUniqueID, ps._localJobUniqueID) != 0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test1 (StatusPageUT) message=unexpected status in page" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    // strings too long for their fields are truncated
+    ps._jobID = std::string(STATUS_PAGE_JOB_ID_LEN * 2, 'x');
+    page.Write(ps);
+    
+    if (!reader.Read(snapshot) || 
+        strlen(snapshot.jobID) != STATUS_PAGE_JOB_ID_LEN - 1)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test1 (StatusPageUT) message=long job ID not truncated" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+    
+    if (reader.GetSequence() != initialSequence + 4)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=test1 (StatusPageUT) message=sequence number not advanced by second update" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% StatusPageUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% test1 (StatusPageUT)" << std::endl;
+    test1();
+    std::cout << "%TEST_FINISHED% time=0 test1 (StatusPageUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    shm_unlink(TEST_STATUS_PAGE);
+    
+    return (mainReturnValue);
+}
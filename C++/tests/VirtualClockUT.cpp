@@ -0,0 +1,160 @@
+//  File:   VirtualClockUT.cpp
+//  Tests the simulated time used by timers when simulating a print
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+
+#include <VirtualClock.h>
+#include <Timer.h>
+
+int mainReturnValue = EXIT_SUCCESS;
+
+// Returns the number of expirations read from the given timer.
+int Expirations(Timer& timer)
+{
+    EventDataVec eventData;
+    timer.Read(eventData);
+    return eventData.size();
+}
+
+void AlarmOrderTest()
+{
+    VirtualClock clock;
+    Timer first(&clock);
+    Timer second(&clock);
+
+    second.Start(2.5);
+    first.Start(1.0);
+
+    if (std::abs(second.GetRemainingTimeSeconds() - 2.5) > 1e-6)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=AlarmOrderTest (VirtualClockUT) " <<
+                "message=Expected 2.5 s remaining, got " <<
+                second.GetRemainingTimeSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (!clock.AdvanceToNextAlarm() || std::abs(clock.GetSeconds() - 1.0) > 1e-6 ||
+        Expirations(first) != 1 || Expirations(second) != 0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=AlarmOrderTest (VirtualClockUT) " <<
+                "message=Expected only first timer to expire at 1 s, now at " <<
+                clock.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (std::abs(second.GetRemainingTimeSeconds() - 1.5) > 1e-6)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=AlarmOrderTest (VirtualClockUT) " <<
+                "message=Expected 1.5 s remaining, got " <<
+                second.GetRemainingTimeSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (!clock.AdvanceToNextAlarm() || std::abs(clock.GetSeconds() - 2.5) > 1e-6 ||
+        Expirations(second) != 1 || Expirations(first) != 0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=AlarmOrderTest (VirtualClockUT) " <<
+                "message=Expected second timer to expire at 2.5 s, now at " <<
+                clock.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    if (clock.AdvanceToNextAlarm())
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=AlarmOrderTest (VirtualClockUT) " <<
+                "message=Expected no more alarms" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+void RestartAndClearTest()
+{
+    VirtualClock clock;
+    Timer timer(&clock);
+    Timer other(&clock);
+
+    // restarting replaces the alarm, and clearing removes it
+    timer.Start(1.0);
+    timer.Start(3.0);
+    other.Start(2.0);
+    other.Clear();
+    if (!clock.AdvanceToNextAlarm() || std::abs(clock.GetSeconds() - 3.0) > 1e-6 ||
+        Expirations(timer) != 1 || Expirations(other) != 0)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=RestartAndClearTest (VirtualClockUT) " <<
+                "message=Expected only restarted timer to expire at 3 s, now at " <<
+                clock.GetSeconds() << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // an expiration not yet read is discarded when the timer is restarted
+    timer.Start(1.0);
+    clock.AdvanceToNextAlarm();
+    timer.Start(1.0);
+    if (Expirations(timer) != 0 ||
+        std::abs(timer.GetRemainingTimeSeconds() - 1.0) > 1e-6)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=RestartAndClearTest (VirtualClockUT) " <<
+                "message=Expected unread expiration to be discarded" << std::endl;
+        mainReturnValue = EXIT_FAILURE;
+        return;
+    }
+
+    // a destroyed timer leaves no alarm behind
+    {
+        Timer temporary(&clock);
+        temporary.Start(0.5);
+    }
+    clock.AdvanceToNextAlarm();
+    if (std::abs(clock.GetSeconds() - 5.0) > 1e-6)
+    {
+        std::cout << "%TEST_FAILED% time=0 testname=RestartAndClearTest (VirtualClockUT) " <<
+                "message=Expected time of 5 s, got " << clock.GetSeconds() <<
+                std::endl;
+        mainReturnValue = EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "%SUITE_STARTING% VirtualClockUT" << std::endl;
+    std::cout << "%SUITE_STARTED%" << std::endl;
+
+    std::cout << "%TEST_STARTED% AlarmOrderTest (VirtualClockUT)" << std::endl;
+    AlarmOrderTest();
+    std::cout << "%TEST_FINISHED% time=0 AlarmOrderTest (VirtualClockUT)" << std::endl;
+
+    std::cout << "%TEST_STARTED% RestartAndClearTest (VirtualClockUT)" << std::endl;
+    RestartAndClearTest();
+    std::cout << "%TEST_FINISHED% time=0 RestartAndClearTest (VirtualClockUT)" << std::endl;
+
+    std::cout << "%SUITE_FINISHED% time=0" << std::endl;
+
+    return (mainReturnValue);
+}
@@ -0,0 +1,71 @@
+//  File:   MemoryFrameBuffer.hpp
+//  Frame buffer held in memory, in a given scan-out format (for testing and
+//  benchmarking purposes)
+//
+//  This file is part of the Ember firmware.
+//
+//  Copyright 2015 Autodesk, Inc. <http://ember.autodesk.com/>
+//
+//  Authors:
+//  agent
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL,
+//  BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE IMPLIED WARRANTY OF
+//  MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.  SEE THE
+//  GNU GENERAL PUBLIC LICENSE FOR MORE DETAILS.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MEMORYFRAMEBUFFER_HPP
+#define	MEMORYFRAMEBUFFER_HPP
+
+#include <vector>
+
+#include "ScanoutBuffers.h"
+
+// Stages, swaps, and fills images just as FrameBuffer does (both being 
+// ScanoutBuffers), but in three in-memory buffers, just noting which is 
+// displayed rather than scanning any of them out.
+class MemoryFrameBuffer : public ScanoutBuffers
+{
+public:
+    MemoryFrameBuffer(int width, int height, const ScanoutFormat& format) :
+    ScanoutBuffers(width, height),
+    _pitch(width * format.bitsPerPixel / 8),
+    _displayCount(0)
+    {
+        uint8_t* pBuffers[NUM_SCANOUT_BUFFERS];
+        for (int i = 0; i < NUM_SCANOUT_BUFFERS; i++)
+        {
+            _buffers[i].resize(_pitch * height);
+            pBuffers[i] = _buffers[i].data();
+        }
+        SetBuffers(format, _pitch, pBuffers);
+    }
+    
+    ~MemoryFrameBuffer() {}
+    
+    // the pixels that would be scanned out now
+    const uint8_t* GetDisplayed() const 
+        { return _buffers[ScanoutBuffers::GetDisplayed()].data(); }
+    int GetPitch() const { return _pitch; }
+    int GetDisplayCount() const { return _displayCount; }
+    
+private:
+    MemoryFrameBuffer(const MemoryFrameBuffer&);
+    MemoryFrameBuffer& operator=(const MemoryFrameBuffer&);
+    
+    void Display(int /*buffer*/) { _displayCount++; }
+    
+    int _pitch;
+    std::vector<uint8_t> _buffers[NUM_SCANOUT_BUFFERS];
+    int _displayCount;
+};
+
+#endif	/* MEMORYFRAMEBUFFER_HPP */
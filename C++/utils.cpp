@@ -71,6 +71,14 @@ long GetMillis(){
     return now.tv_sec * 1000 + now.tv_nsec / 1000000;
 }
 
+// Get the current time in microseconds
+uint64_t GetMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 long startTime = 0;
 
 // Start the stopwatch timer
@@ -10,6 +10,9 @@ module Smith
   TEMP_SETTINGS_FILE = '/tmp/print_settings'
   PRIMARY_REGISTRATION_INFO_FILE = '/tmp/printer_registration'
   PRINTER_STATUS_FILE = '/run/printer_status'
+  PRINTER_STATUS_TEMP_FILE = '/run/printer_status.tmp'
+  PRINTER_STATUS_PAGE = '/printer_status'
+  EVENT_STATS_FILE = '/run/event_stats'
   SMITH_STATE_FILE = '/var/local/smith_state'
   INTERNET_CONNECTED_KEY = 'internet_connected'
   CMD_START_PRINT = 'START'
@@ -42,6 +45,7 @@ module Smith
   CMD_BTNS_1_AND_2_HOLD = 'BUTTONS1AND2HOLD'
   CMD_SHOW_WHITE = 'SHOWWHITE'
   CMD_SHOW_BLACK = 'SHOWBLACK'
+  CMD_EVENT_STATS = 'EVENTSTATS'
   STATE_PS_KEY = 'state'
   UISUBSTATE_PS_KEY = 'ui_sub_state'
   CHANGE_PS_KEY = 'change'
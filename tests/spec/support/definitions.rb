@@ -224,6 +224,10 @@ module Tests
   MC_Z_ACTION_REG = 0xA5
   MC_COMMAND_REG_HIGH_FENCEPOST = 0xA6
   MC_STATUS_REG = 0x30
+  MC_QUEUE_REG = 0x31
+  MC_BATCH_REG = 0xB0
+  MC_MAX_BATCH_COMMANDS = 16
+  MC_BATCH_CRC_POLYNOMIAL = 0x07
   MC_GENERAL_LOW_FENCEPOST = 0
   MC_INTERRUPT = 1
   MC_RESET = 2
@@ -238,7 +242,8 @@ module Tests
   MC_MICROSTEPPING = 3
   MC_JERK = 4
   MC_SPEED = 5
-  MC_SETTINGS_HIGH_FENCEPOST = 6
+  MC_LINKED_MOVE = 6
+  MC_SETTINGS_HIGH_FENCEPOST = 7
   MC_MOVE = 1
   MC_HOME = 2
   MC_ACTION_HIGH_FENCEPOST = 3
@@ -262,6 +267,7 @@ module Tests
   MC_STATUS_MOVE_TIME_TOO_SMALL = 17
   MC_STATUS_BLOCK_SKIPPED = 18
   MC_STATUS_INTERNAL_ERROR = 19
+  MC_STATUS_BATCH_INVALID = 20
   R_SCALE_FACTOR = 100
   UNITS_PER_REVOLUTION = 360 * 10
   R_SPEED_FACTOR = UNITS_PER_REVOLUTION
@@ -302,12 +308,14 @@ module Tests
   CMD_RING_SEQUENCE = 0x02
   CMD_RING_LED = 0x03
   CMD_RING_LEDS = 0x04
+  CMD_RING_LED_VALUES = 0x05
   CMD_OLED_SETTEXT = 0x01
   CMD_OLED_CENTERTEXT = 0x06
   CMD_OLED_RIGHTTEXT = 0x07
   CMD_OLED_CLEAR = 0x02
   CMD_OLED_ON = 0x03
   CMD_OLED_OFF = 0x04
+  CMD_OLED_LINE = 0x09
   CMD_SLEEP = 0x03
   MAX_OLED_STRING_LEN = 20
   NUM_LEDS_IN_RING = 21
@@ -78,6 +78,8 @@ module Tests
       @led_ring_brightnesses = Array.new(LED_COUNT, nil)
 
       @screen_lines = []
+      # lines updated in place, by line id
+      @identified_lines = {}
       @button_status = 0
       @button_read_requested = false
 
@@ -147,6 +149,11 @@ module Tests
         end
       elsif unpacked_data == FP_COMMAND
         @receiving_command = true
+      elsif unpacked_data == CMD_START
+        # the main firmware packs several command frames into one write, so a
+        # frame can also start right after the end of the previous one
+        @receiving_command = true
+        @command << data
       elsif unpacked_data == DISPLAY_STATUS
         # write status byte to pipe that main firmware reads I2C data from
         @i2c_read_pipe.write([0].pack('C'))
@@ -217,6 +224,7 @@ module Tests
         when CMD_OLED_CLEAR
           log "\tcleared oled"
           @screen_lines = []
+          @identified_lines = {}
         when CMD_OLED_SETTEXT, CMD_OLED_CENTERTEXT, CMD_OLED_RIGHTTEXT
           alignment = OLED_ALIGNMENT[command]
           log "\tdisplay #{alignment}-aligned text"
@@ -240,6 +248,32 @@ module Tests
           log "\t#{@screen_lines.last.inspect}"
           # keep the screen lines array sorted by text on each line to ease comparisons
           @screen_lines.sort! { |a, b| a.sort_key <=> b.sort_key }
+        when CMD_OLED_LINE
+          line_id = sequence.extract_uint8
+          alignment = OLED_ALIGNMENT[sequence.extract_uint8]
+          log "\tupdate #{alignment}-aligned text of line #{line_id}"
+          x_position = sequence.extract_uint8
+          y_position = sequence.extract_uint8
+          size = sequence.extract_uint8
+          color = sequence.extract_uint16
+          length = sequence.extract_uint8
+          text = sequence.remaining
+          if length != text.length
+            fail "command specified text length of #{length}, actual number of bytes: #{text.length}"
+          end
+          # the new text replaces any already shown for the line
+          @screen_lines.delete(@identified_lines[line_id])
+          @identified_lines[line_id] = TextLine.new(
+              text:       text.join,
+              x_position: x_position,
+              y_position: y_position,
+              alignment:  alignment,
+              color:      color,
+              size:       size
+          )
+          @screen_lines << @identified_lines[line_id]
+          log "\t#{@screen_lines.last.inspect}"
+          @screen_lines.sort! { |a, b| a.sort_key <=> b.sort_key }
         else
           fail "unknown type of OLED command: 0x#{command.to_s(16)}"
       end
@@ -252,6 +286,14 @@ module Tests
         when CMD_RING_LEDS
           @led_ring_brightnesses = Array.new(LED_COUNT, sequence.extract_uint16)
           log "\tsetting all leds to #{@led_ring_brightnesses[0]}"
+        when CMD_RING_LED_VALUES
+          count = sequence.extract_uint8
+          count.times do |led|
+            # scaled to the 12 bit range, as on the front panel
+            value = sequence.extract_uint8
+            @led_ring_brightnesses[led] = (value << 4) | (value >> 4)
+          end
+          log "\tsetting leds to #{@led_ring_brightnesses.inspect}"
         when CMD_RING_SEQUENCE
           @led_ring_animation_sequence = sequence.extract_uint8
           log "\tsetting leds to sequence: #{@led_ring_animation_sequence}"
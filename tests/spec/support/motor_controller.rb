@@ -5,7 +5,7 @@ module Tests
   class MotorController
 
     # Records movement requests from main firmware
-    Motion = Struct.new(:axis, :action, :parameter, :settings)
+    Motion = Struct.new(:axis, :action, :parameter, :settings, :linked_parameter)
 
     # Transforms individual bytes comprising a command into the command's register, action, and parameter values
     class Command
@@ -25,7 +25,7 @@ module Tests
     class CommandBuffer
 
       # Size of the buffer in bytes
-      BUFFER_SIZE = 128
+      BUFFER_SIZE = 256
 
       # Number of bytes per command message
       COMMAND_SIZE = 6
@@ -39,6 +39,7 @@ module Tests
         @bytes_remaining = COMMAND_SIZE
         @received_command_count = 0
         @buffer = []
+        @batch = nil
       end
 
       def has_command?
@@ -46,7 +47,12 @@ module Tests
       end
 
       def has_partial_command?
-        @bytes_remaining != COMMAND_SIZE
+        @bytes_remaining != COMMAND_SIZE || !@batch.nil?
+      end
+
+      # number of commands the buffer can currently accept
+      def free_capacity
+        COMMAND_CAPACITY - @received_command_count
       end
 
       # store the specified byte as a string in the buffer
@@ -54,7 +60,12 @@ module Tests
       def add(data)
         unpacked_data = data.unpack('C').first
 
-        if unpacked_data > MC_GENERAL_LOW_FENCEPOST && unpacked_data < MC_GENERAL_HIGH_FENCEPOST &&
+        if @batch
+          add_batch_byte(data)
+        elsif unpacked_data == MC_BATCH_REG && @bytes_remaining == COMMAND_SIZE
+          # data starts a batch of commands
+          @batch = []
+        elsif unpacked_data > MC_GENERAL_LOW_FENCEPOST && unpacked_data < MC_GENERAL_HIGH_FENCEPOST &&
             @bytes_remaining == COMMAND_SIZE
 
           # data represents a general command
@@ -78,6 +89,27 @@ module Tests
 
       private
 
+      # collect the bytes of a batch of commands and add its commands to the buffer once its checksum is verified
+      def add_batch_byte(data)
+        @batch << data
+        count = @batch.first.unpack('C').first
+        return if @batch.size < count * COMMAND_SIZE + 2
+
+        checksum = @batch[0..-2].inject(0) { |crc, byte| update_checksum(crc, byte.unpack('C').first) }
+        batch = @batch
+        @batch = nil
+        raise 'invalid batch checksum' if checksum != batch.last.unpack('C').first
+
+        batch[1..-2].each { |byte| add_byte(byte) }
+      end
+
+      # update the batch checksum (CRC-8) with the specified byte
+      def update_checksum(crc, byte)
+        crc ^= byte
+        8.times { crc = crc & 0x80 != 0 ? ((crc << 1) ^ MC_BATCH_CRC_POLYNOMIAL) & 0xFF : (crc << 1) & 0xFF }
+        crc
+      end
+
       def add_byte(data)
         # check if the buffer has room for an entire command
         # the buffer might have space for a single byte but the buffer can
@@ -105,7 +137,7 @@ module Tests
 
     # Holds current settings for a single axis
     class AxisSettings
-      attr_accessor :step_angle, :units_per_revolution, :microstepping_factor, :speed, :max_jerk
+      attr_accessor :step_angle, :units_per_revolution, :microstepping_factor, :speed, :max_jerk, :linked_distance
 
       def initialize
         reset
@@ -117,6 +149,7 @@ module Tests
         @microstepping_factor = 0
         @max_jerk = 0.0
         @speed = 0.0
+        @linked_distance = 0
       end
     end
 
@@ -217,9 +250,16 @@ module Tests
         return
       end
 
+      if unpacked_data == MC_QUEUE_REG && !@buffer.has_partial_command?
+        # write number of commands the buffer can accept to pipe that main firmware reads I2C data from
+        @i2c_read_pipe.write([@buffer.free_capacity].pack('C'))
+        @i2c_read_pipe.flush
+        return
+      end
+
       @buffer.add(data)
 
-      if @buffer.has_command?
+      while @buffer.has_command?
         command = @buffer.command
         #puts "got command, register: #{command.register.to_s(16)}, action: #{command.action.to_s(16)}, parameter: #{command.parameter}"
         case command.register
@@ -298,6 +338,8 @@ module Tests
           axis_settings.speed = parameter
         when MC_UNITS_PER_REV
           axis_settings.units_per_revolution = parameter
+        when MC_LINKED_MOVE
+          axis_settings.linked_distance = parameter
         else
           @status = MC_STATUS_COMMAND_UNKNOWN
       end
@@ -309,7 +351,11 @@ module Tests
         when MC_MOVE, MC_HOME
           # record the settings at the time of the action so the tests can make assertions regarding what settings the
           # motor controller carried out the action with
-          @movements << Motion.new(axis, action, parameter, axis_settings.clone)
+          # a move also carries out any linked move of the other axis, a homing move never does
+          other_axis_settings = axis == :z ? @r_axis_settings : @z_axis_settings
+          linked_parameter = action == MC_MOVE ? other_axis_settings.linked_distance : 0
+          other_axis_settings.linked_distance = 0 if action == MC_MOVE
+          @movements << Motion.new(axis, action, parameter, axis_settings.clone, linked_parameter)
         else
           @status = MC_STATUS_COMMAND_UNKNOWN
       end